@@ -0,0 +1,293 @@
+#! /usr/bin/env python
+#
+#  MPI-Datatybe - MPI Datatype Benchmark
+#
+#  Fits the linear cost model
+#
+#      time = latency + per_block * nblocks + per_byte * nbytes
+#
+#  to the run-times measured by the benchmark for each layout (nblocks and
+#  the number of bytes are taken from the nblocks and realsize fields of the
+#  output), and predicts the run-time of other sizes and layouts, also of
+#  datatypes that were only exported as typemap files (typemap_export) or
+#  are given by their number of blocks and bytes.
+#
+#  fit:     fit_cost_model.py fit [--model model.txt] <output files>
+#  predict: fit_cost_model.py predict --model model.txt [<output files>]
+#                  [--typemap <typemap files>] [--blocks <nblocks>:<nbytes> ...]
+#
+#  Each output file of the benchmark is assumed to contain the measurements
+#  of one layout, named after the layout parameter in the header of the
+#  file (or after the file name); use --layout to override the name.
+#
+
+from __future__ import print_function
+
+import os
+import sys
+import struct
+import argparse
+
+TIME_COLUMNS = ["runtime_sec", "median_sec", "mean_sec", "min_sec", "max_sec", "time"]
+POOLED_MODEL = "*"
+TYPEMAP_MAGIC = b"DTTMAP1\0"
+
+
+def is_number(s):
+    try:
+        float(s)
+        return True
+    except ValueError:
+        return False
+
+
+def median(values):
+    values = sorted(values)
+    n = len(values)
+    if n % 2 == 1:
+        return values[n // 2]
+    return 0.5 * (values[n // 2 - 1] + values[n // 2])
+
+
+def read_measurements(file_path, name, time_column, layout=None):
+    """returns the layout name and the list of (nblocks, nbytes, time) of the
+    file, one entry per message size (median of the repetitions)"""
+    header = None
+    samples = {}
+
+    with open(file_path, "r") as f:
+        for line in f:
+            line = line.strip()
+            if len(line) == 0:
+                continue
+            if line.startswith("#"):
+                # parameters are printed as "#@key=value" in the header
+                kv = line.lstrip("#@ ").split("=", 1)
+                if layout is None and len(kv) == 2 and kv[0].strip() == "layout":
+                    layout = kv[1].strip()
+                continue
+
+            tokens = line.split()
+            if "nbytes" in tokens and not all(is_number(t) for t in tokens):
+                header = tokens
+                continue
+            if header is None or len(tokens) != len(header):
+                continue
+
+            row = dict(zip(header, tokens))
+            if "nblocks" not in row or "realsize" not in row:
+                sys.exit("ERROR: %s does not contain the nblocks and realsize fields" % file_path)
+            if "name" in row and row["name"] != name:
+                continue
+            if "type_form" in row and row["type_form"] != "original":
+                continue
+
+            tcol = time_column
+            if tcol is None:
+                for c in TIME_COLUMNS:
+                    if c in row:
+                        tcol = c
+                        break
+            if tcol is None or tcol not in row:
+                sys.exit("ERROR: no run-time column found in %s (use --time-column)" % file_path)
+
+            key = (int(row["nblocks"]), int(row["realsize"]))
+            samples.setdefault(key, []).append(float(row[tcol]))
+
+    if layout is None:
+        layout = os.path.splitext(os.path.basename(file_path))[0]
+    points = [(k[0], k[1], median(v)) for k, v in sorted(samples.items())]
+    return layout, points
+
+
+def solve_least_squares(rows, values):
+    """least squares solution of rows * x = values via the normal equations;
+    columns that are (numerically) linearly dependent on the previous ones
+    get a zero coefficient"""
+    n = len(rows[0])
+    a = [[sum(r[i] * r[j] for r in rows) for j in range(n)] for i in range(n)]
+    b = [sum(r[i] * v for r, v in zip(rows, values)) for i in range(n)]
+
+    # scale the columns to make the pivoting threshold meaningful
+    scale = [(a[i][i] ** 0.5) if a[i][i] > 0 else 1.0 for i in range(n)]
+    a = [[a[i][j] / (scale[i] * scale[j]) for j in range(n)] for i in range(n)]
+    b = [b[i] / scale[i] for i in range(n)]
+
+    active = []
+    for k in range(n):
+        # keep column k only if it is not (nearly) a combination of the active ones
+        cols = active + [k]
+        m = [[a[i][j] for j in cols] for i in cols]
+        if determinant(m) > 1e-6:
+            active.append(k)
+
+    x = [0.0] * n
+    if active:
+        m = [[a[i][j] for j in active] for i in active]
+        y = gauss_solve(m, [b[i] for i in active])
+        for i, k in enumerate(active):
+            x[k] = y[i] / scale[k]
+    return x
+
+
+def determinant(m):
+    m = [list(r) for r in m]
+    n = len(m)
+    det = 1.0
+    for k in range(n):
+        p = max(range(k, n), key=lambda i: abs(m[i][k]))
+        if m[p][k] == 0:
+            return 0.0
+        if p != k:
+            m[k], m[p] = m[p], m[k]
+            det = -det
+        det *= m[k][k]
+        for i in range(k + 1, n):
+            f = m[i][k] / m[k][k]
+            for j in range(k, n):
+                m[i][j] -= f * m[k][j]
+    return abs(det)
+
+
+def gauss_solve(m, b):
+    m = [list(r) + [v] for r, v in zip(m, b)]
+    n = len(m)
+    for k in range(n):
+        p = max(range(k, n), key=lambda i: abs(m[i][k]))
+        m[k], m[p] = m[p], m[k]
+        for i in range(k + 1, n):
+            f = m[i][k] / m[k][k]
+            for j in range(k, n + 1):
+                m[i][j] -= f * m[k][j]
+    x = [0.0] * n
+    for k in range(n - 1, -1, -1):
+        x[k] = (m[k][n] - sum(m[k][j] * x[j] for j in range(k + 1, n))) / m[k][k]
+    return x
+
+
+def fit_model(points):
+    rows = [[1.0, float(nb), float(nbytes)] for nb, nbytes, _ in points]
+    return solve_least_squares(rows, [t for _, _, t in points])
+
+
+def predict(model, nblocks, nbytes):
+    return model[0] + model[1] * nblocks + model[2] * nbytes
+
+
+def print_residuals(layout, model, points, out=sys.stdout):
+    for nb, nbytes, t in points:
+        p = predict(model, nb, nbytes)
+        rel = (p - t) / t if t != 0 else float("nan")
+        print("%-32s %12d %14d %14.6e %14.6e %10.3f" % (layout, nb, nbytes, t, p, rel), file=out)
+
+
+def print_residual_header(out=sys.stdout):
+    print("%-32s %12s %14s %14s %14s %10s" % ("layout", "nblocks", "nbytes", "measured", "predicted", "rel_error"), file=out)
+
+
+def write_model(path, models):
+    with open(path, "w") as f:
+        f.write("# layout latency_sec per_block_sec per_byte_sec (layout %s: fit over all layouts)\n" % POOLED_MODEL)
+        for layout in sorted(models):
+            m = models[layout]
+            f.write("%s %.9e %.9e %.9e\n" % (layout, m[0], m[1], m[2]))
+
+
+def read_model(path):
+    models = {}
+    with open(path, "r") as f:
+        for line in f:
+            if line.startswith("#") or len(line.strip()) == 0:
+                continue
+            tokens = line.split()
+            models[tokens[0]] = [float(v) for v in tokens[1:4]]
+    if POOLED_MODEL not in models:
+        sys.exit("ERROR: model file %s has no pooled model" % path)
+    return models
+
+
+def read_typemap_file(path):
+    """returns (nblocks, nbytes) of a typemap file written by typemap_export"""
+    with open(path, "rb") as f:
+        header = f.read(40)
+        if len(header) != 40 or header[:8] != TYPEMAP_MAGIC:
+            sys.exit("ERROR: %s is not a typemap file" % path)
+        _, basesize, nblocks, _, _ = struct.unpack("=iiqqq", header[8:])
+        f.seek(40 + 8 * nblocks)
+        lengths = struct.unpack("=%di" % nblocks, f.read(4 * nblocks))
+    return nblocks, sum(lengths) * basesize
+
+
+def command_fit(args):
+    data = {}
+    for path in args.files:
+        layout, points = read_measurements(path, args.name, args.time_column, args.layout)
+        data.setdefault(layout, []).extend(points)
+
+    models = {}
+    for layout, points in data.items():
+        models[layout] = fit_model(points)
+    models[POOLED_MODEL] = fit_model([p for points in data.values() for p in points])
+
+    print("%-32s %14s %14s %14s" % ("layout", "latency_sec", "per_block_sec", "per_byte_sec"))
+    for layout in sorted(models):
+        m = models[layout]
+        print("%-32s %14.6e %14.6e %14.6e" % (layout, m[0], m[1], m[2]))
+    print("")
+
+    print_residual_header()
+    for layout in sorted(data):
+        print_residuals(layout, models[layout], data[layout])
+    for layout in sorted(data):
+        print_residuals(layout + " (" + POOLED_MODEL + ")", models[POOLED_MODEL], data[layout])
+
+    if args.model is not None:
+        write_model(args.model, models)
+
+
+def command_predict(args):
+    models = read_model(args.model)
+
+    print_residual_header()
+    for path in args.files:
+        layout, points = read_measurements(path, args.name, args.time_column, args.layout)
+        # layouts that were not part of the fit are predicted with the pooled model
+        name = layout if layout in models else POOLED_MODEL
+        print_residuals(layout + " (" + name + ")", models[name], points)
+
+    for path in args.typemap:
+        nblocks, nbytes = read_typemap_file(path)
+        print("%-32s %12d %14d %14s %14.6e" % (os.path.basename(path), nblocks, nbytes, "-",
+                                               predict(models[POOLED_MODEL], nblocks, nbytes)))
+
+    for spec in args.blocks:
+        nblocks, nbytes = [int(v) for v in spec.split(":")]
+        print("%-32s %12d %14d %14s %14.6e" % ("-", nblocks, nbytes, "-",
+                                               predict(models[POOLED_MODEL], nblocks, nbytes)))
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Fit and evaluate a latency + per-block + per-byte cost model")
+    parser.add_argument("--name", default="runtime", help="measurement to use (name field, default: runtime)")
+    parser.add_argument("--time-column", default=None, help="run-time column (default: %s)" % "/".join(TIME_COLUMNS))
+    parser.add_argument("--layout", default=None, help="layout name of all input files")
+    subparsers = parser.add_subparsers(dest="command")
+
+    fit_parser = subparsers.add_parser("fit", help="fit the model of each layout and over all layouts")
+    fit_parser.add_argument("--model", default=None, help="write the fitted models to this file")
+    fit_parser.add_argument("files", nargs="+", help="benchmark output files")
+
+    predict_parser = subparsers.add_parser("predict", help="predict run-times with fitted models")
+    predict_parser.add_argument("--model", required=True, help="model file written by fit")
+    predict_parser.add_argument("--typemap", nargs="*", default=[], help="typemap files (typemap_export)")
+    predict_parser.add_argument("--blocks", nargs="*", default=[], help="<nblocks>:<nbytes> pairs")
+    predict_parser.add_argument("files", nargs="*", help="benchmark output files")
+
+    args = parser.parse_args()
+    if args.command == "fit":
+        command_fit(args)
+    elif args.command == "predict":
+        command_predict(args)
+    else:
+        parser.print_help()
+        sys.exit(1)
@@ -238,6 +238,20 @@ def config_code(args, config):
 
 
 
+def compile_datatype_check(config, target_dir):
+    with open(os.path.join(base_path, config["path_to_list_of_check_source_files"]), 'r') as f:
+        sources = [ line.strip() for line in f if len(line.strip()) > 0 ]
+
+    bin_dir = os.path.join(target_dir, "bin")
+    if not os.path.exists(bin_dir):
+        os.makedirs(bin_dir)
+
+    command = [ config.get("datatype_check_compiler", "mpicc"), "-O2", "-std=gnu99", "-I", SOURCE_DIR ]
+    command = command + sources
+    command = command + [ "-o", os.path.join(bin_dir, "datatype_check"), "-lm", "-pthread" ]
+    run_command(command, SOURCE_DIR)
+
+
 def compile_code(args, config):
     reprompi_repo_path = os.path.join(config["build_dir"], os.path.basename(config["git_reprompi_bench"]).split(".")[0])    
     reprompi_repo_path = os.path.join(base_path, reprompi_repo_path)
@@ -259,6 +273,9 @@ def compile_code(args, config):
     print "%s\n## Compiling mpi-datatybe\n%s" % (COMMENT_STR, COMMENT_STR)
     compile_source_code(datatype_gen_code_path)
     print "Done.\n"
+    print "%s\n## Compiling datatype_check\n%s" % (COMMENT_STR, COMMENT_STR)
+    compile_datatype_check(config, datatype_gen_code_path)
+    print "Done.\n"
     
     print "\n\nThe compiled benchmarks can be found here:"
     print "  - ReproMPI: %s" % reprompi_repo_path
@@ -0,0 +1,350 @@
+/*  MPI-Datatybe - MPI Datatype Benchmark
+ *  
+ *  Copyright 2017 Alexandra Carpen-Amarie, Sascha Hunold, Jesper Larsson Träff
+ *      Research Group for Parallel Computing
+ *      Faculty of Informatics
+ *      Vienna University of Technology, Austria
+ *  
+ *  <license>
+ *      This program is free software: you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation, either version 2 of the License, or
+ *      (at your option) any later version.
+ *  
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *  
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *  </license>
+ */
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <assert.h>
+#include <mpi.h>
+
+#include "alltoallw_pattern.h"
+#include "perftypes.h"
+#include "util.h"
+#include "large_count.h"
+#include "datatype_cache.h"
+#include "typemap/typemap.h"
+//@ add_includes
+
+//@ declare_variables
+
+
+static const char* PATTERN_ALLTOALLW = "alltoallw";
+static const char* PEER_LAYOUTS_KEY = "peer_layouts";
+
+static const int CACHE_LINE_SIZE = 64;
+
+
+typedef struct peer_layout {
+    pattern_config_t conf;
+    MPI_Datatype type;      // of the current size
+    int flags;
+    int c;                  // number of instances for the current size
+} peer_layout_t;
+
+
+static void alltoallw_datatype(void* sendbuf, void* recvbuf, int c, const MPI_Count* counts,
+        const MPI_Aint* displs, const MPI_Datatype* types, MPI_Comm comm) {
+
+    //@ set test_type="datatype"
+
+    //@ initialize_timestamps t1
+    //@ initialize_timestamps t2
+
+    //@ start_measurement_loop
+
+    //@ start_sync
+    //@ measure_timestamp t1
+    large_alltoallw(sendbuf, counts, displs, types, recvbuf, counts, displs, types, comm);
+    //@ measure_timestamp t2
+    //@ stop_sync
+    //@stop_measurement_loop
+
+    //@ print_runtime_array name=runtime end_time=t2 start_time=t1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+
+    //@cleanup_variables
+}
+
+
+// the block of each peer is packed into its own part of the packed buffer, exchanged with MPI_Alltoallv
+static void alltoallw_pack(void* sendbuf, void* recvbuf, int c, const MPI_Count* counts,
+        const MPI_Aint* displs, const MPI_Datatype* types, MPI_Comm comm) {
+    int j, size;
+    MPI_Count position;
+    MPI_Count *packcounts;
+    MPI_Aint *packdispls;
+    void *sendpack, *recvpack;
+    size_t packtotal;
+
+    // not to measure
+    MPI_Comm_size(comm, &size);
+    packcounts = (MPI_Count*)malloc(size * sizeof(MPI_Count));
+    packdispls = (MPI_Aint*)malloc(size * sizeof(MPI_Aint));
+    assert(packcounts!=NULL && packdispls!=NULL);
+    packtotal = 0;
+    for (j=0; j<size; j++) {
+        packcounts[j] = get_pack_size(counts[j], types[j], comm);
+        packdispls[j] = packtotal;
+        packtotal += packcounts[j];
+    }
+    posix_memalign(&sendpack, CACHE_LINE_SIZE, packtotal);
+    assert(sendpack!=NULL);
+    posix_memalign(&recvpack, CACHE_LINE_SIZE, packtotal);
+    assert(recvpack!=NULL);
+
+    //@ set test_type="pack"
+
+    //@ initialize_timestamps t1
+    //@ initialize_timestamps t2
+    //@ initialize_timestamps tp1
+    //@ initialize_timestamps tp2
+    //@ initialize_timestamps tc1
+    //@ initialize_timestamps tc2
+    //@ initialize_timestamps tu1
+    //@ initialize_timestamps tu2
+
+    //@ start_measurement_loop
+
+    //@ start_sync
+    //@ measure_timestamp t1
+    //@ measure_timestamp tp1
+    for (j=0; j<size; j++) {
+        position = 0;
+        large_pack((char*)sendbuf + displs[j], counts[j], types[j], (char*)sendpack + packdispls[j],
+                packcounts[j], &position, comm);
+    }
+    //@ measure_timestamp tp2
+    //@ measure_timestamp tc1
+    large_alltoallv(sendpack, packcounts, packdispls, recvpack, packcounts, packdispls, MPI_PACKED, comm);
+    //@ measure_timestamp tc2
+    //@ measure_timestamp tu1
+    for (j=0; j<size; j++) {
+        position = 0;
+        large_unpack((char*)recvpack + packdispls[j], packcounts[j], &position,
+                (char*)recvbuf + displs[j], counts[j], types[j], comm);
+    }
+    //@ measure_timestamp tu2
+    //@ measure_timestamp t2
+    //@ stop_sync
+    //@stop_measurement_loop
+
+    //@ print_runtime_array name=runtime end_time=t2 start_time=t1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+    //@ print_runtime_array name=pack_time end_time=tp2 start_time=tp1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+    //@ print_runtime_array name=comm_time end_time=tc2 start_time=tc1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+    //@ print_runtime_array name=unpack_time end_time=tu2 start_time=tu1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+
+    //@cleanup_variables
+    free(sendpack);
+    free(recvpack);
+    free(packcounts);
+    free(packdispls);
+}
+
+
+// the layout of the pattern followed by the peer layouts
+static peer_layout_t* get_peer_layouts(const pattern_config_t conf, dictionary_t *dict, int *nlayouts) {
+    string_array_t* names = NULL;
+    peer_layout_t* layouts;
+    char* value;
+    int k, ret;
+
+    *nlayouts = 1;
+    ret = get_value_from_dict(dict, PEER_LAYOUTS_KEY, &value);
+    if (ret == 0 && value != NULL) {
+        names = get_string_array_from_dict(PEER_LAYOUTS_KEY, dict);
+        *nlayouts += names->n_elems;
+        free(value);
+    }
+    layouts = (peer_layout_t*)malloc(*nlayouts * sizeof(peer_layout_t));
+    assert(layouts!=NULL);
+
+    layouts[0].conf = conf;
+    for (k = 1; k < *nlayouts; k++) {
+        layouts[k].conf = conf;
+        get_create_function(names->elements[k-1], &layouts[k].conf.create_datatype, &layouts[k].conf.dt_parameters,
+                &layouts[k].conf.nb_params, &layouts[k].conf.type_info);
+        free(names->elements[k-1]);
+    }
+    if (names != NULL) {
+        free(names->elements);
+        free(names);
+    }
+
+    // basic layouts do not depend on the size
+    for (k = 0; k < *nlayouts; k++) {
+        if (layouts[k].conf.type_info == basic) {
+            layouts[k].conf.create_datatype(dict, &layouts[k].type, &layouts[k].flags);
+            if ((layouts[k].flags & PREDEFINED_DT) == 0) {
+                MPI_Type_commit(&layouts[k].type);
+            }
+        }
+    }
+    return layouts;
+}
+
+
+// instances of each layout for nbytes bytes; returns 0 if a layout has no instance
+static int instantiate_peer_layouts(peer_layout_t* layouts, int nlayouts, const dictionary_t *dict, size_t nbytes) {
+    MPI_Count typesize;
+    int k, valid = 1;
+
+    for (k = 0; k < nlayouts; k++) {
+        if (layouts[k].conf.type_info == dynamic) {
+            get_dynamic_datatype(layouts[k].conf, dict, nbytes, &layouts[k].type, &layouts[k].c, &layouts[k].flags);
+        } else {
+            typesize = get_type_size(layouts[k].type);
+            if (typesize <= 0 || nbytes/typesize > INT_MAX) {
+                layouts[k].c = 0;
+            } else {
+                layouts[k].c = nbytes/typesize;
+            }
+        }
+        if (layouts[k].c <= 0) {
+            valid = 0;
+        }
+    }
+    return valid;
+}
+
+
+static void release_peer_layouts(peer_layout_t* layouts, int nlayouts) {
+    int k;
+
+    for (k = 0; k < nlayouts; k++) {
+        if (layouts[k].conf.type_info == dynamic) {
+            release_dynamic_datatype(layouts[k].conf, &layouts[k].type, layouts[k].flags);
+        }
+    }
+}
+
+
+static void measure_alltoallw(pattern_config_t conf, peer_layout_t* layouts, int nlayouts, char* nbytes_str) {
+    int rank, size, j, k;
+    MPI_Count *counts;
+    MPI_Aint *displs;
+    MPI_Datatype *types;
+    MPI_Aint lb, extent;
+    MPI_Count typesize, realsize, nblocks;
+    size_t buffer_size;
+    void *sendbuf, *recvbuf;
+    char *typesize_str, *real_size_str, *extent_str, *nblocks_str, *mean_block_str;
+    int c;
+
+    MPI_Comm_rank(conf.comm, &rank);
+    MPI_Comm_size(conf.comm, &size);
+    counts = (MPI_Count*)malloc(size * sizeof(MPI_Count));
+    displs = (MPI_Aint*)malloc(size * sizeof(MPI_Aint));
+    types = (MPI_Datatype*)malloc(size * sizeof(MPI_Datatype));
+    assert(counts!=NULL && displs!=NULL && types!=NULL);
+
+    // the block exchanged with process j has the same layout on both sides
+    buffer_size = 0;
+    realsize = 0;
+    nblocks = 0;
+    for (j=0; j<size; j++) {
+        k = (rank + j) % nlayouts;
+        MPI_Type_get_extent(layouts[k].type, &lb, &extent);
+        counts[j] = layouts[k].c;
+        types[j] = layouts[k].type;
+        displs[j] = buffer_size;
+        buffer_size += (size_t)layouts[k].c * extent;
+        realsize += layouts[k].c * get_type_size(layouts[k].type);
+        nblocks += get_typemap_nblocks(layouts[k].type, layouts[k].c);
+    }
+    posix_memalign(&sendbuf, CACHE_LINE_SIZE, buffer_size);
+    assert(sendbuf!=NULL);
+    posix_memalign(&recvbuf, CACHE_LINE_SIZE, buffer_size);
+    assert(recvbuf!=NULL);
+
+    // size and extent of the layout of the pattern, real size and blocks of all peers
+    c = layouts[0].c;
+    MPI_Type_get_extent(layouts[0].type, &lb, &extent);
+    typesize = get_type_size(layouts[0].type);
+    typesize_str  = my_count_to_string(typesize);
+    extent_str  = my_count_to_string(extent);
+    real_size_str = my_count_to_string(realsize);
+    nblocks_str = my_count_to_string(nblocks);
+    mean_block_str = my_count_to_string((nblocks > 0) ? realsize/nblocks : 0);
+
+    //@ set nbytes_str=nbytes_str
+    //@ set derivedtype_size=typesize_str
+    //@ set real_size=real_size_str
+    //@ set derivedtype_extent=extent_str
+    //@ set nblocks=nblocks_str
+    //@ set mean_block=mean_block_str
+
+    switch (conf.test_type) {
+    case test_datatype:
+        alltoallw_datatype(sendbuf, recvbuf, c, counts, displs, types, conf.comm);
+        break;
+    case test_pack:
+        alltoallw_pack(sendbuf, recvbuf, c, counts, displs, types, conf.comm);
+        break;
+    default:
+        printf("Error: the alltoallw pattern only supports the test types datatype and pack\n");
+        exit(1);
+    }
+
+    free(typesize_str);
+    free(extent_str);
+    free(real_size_str);
+    free(nblocks_str);
+    free(mean_block_str);
+    free(sendbuf);
+    free(recvbuf);
+    free(counts);
+    free(displs);
+    free(types);
+}
+
+
+int alltoallwpattern(pattern_config_t conf, dictionary_t *dict)
+{
+    int i, k;
+    string_array_t* nbytes_list = NULL;
+    peer_layout_t* layouts;
+    int nlayouts;
+    size_t nbytes;
+
+    //@ global pattern_type=PATTERN_ALLTOALLW
+
+    nbytes_list = get_string_array_from_dict("nbytes_list", dict);
+    layouts = get_peer_layouts(conf, dict, &nlayouts);
+
+    for (i=0; i<nbytes_list->n_elems; i++) {
+        nbytes = atol(nbytes_list->elements[i]);
+
+        if (instantiate_peer_layouts(layouts, nlayouts, dict, nbytes)) {
+            measure_alltoallw(conf, layouts, nlayouts, nbytes_list->elements[i]);
+        } else {
+            fprintf(stderr, "WARNING: nbytes=%ld is not a valid size for all peer layouts...skipping case\n", nbytes);
+        }
+        release_peer_layouts(layouts, nlayouts);
+    }
+
+    for (k = 0; k < nlayouts; k++) {
+        if (layouts[k].conf.type_info == basic && (layouts[k].flags & PREDEFINED_DT) == 0) {
+            MPI_Type_free(&layouts[k].type);
+        }
+    }
+    free(layouts);
+
+    for (i=0; i<nbytes_list->n_elems; i++) {
+        free(nbytes_list->elements[i]);
+    }
+    free(nbytes_list->elements);
+    free(nbytes_list);
+
+    return MPI_SUCCESS;
+}
@@ -0,0 +1,37 @@
+/*  MPI-Datatybe - MPI Datatype Benchmark
+ *  
+ *  Copyright 2017 Alexandra Carpen-Amarie, Sascha Hunold, Jesper Larsson Träff
+ *      Research Group for Parallel Computing
+ *      Faculty of Informatics
+ *      Vienna University of Technology, Austria
+ *  
+ *  <license>
+ *      This program is free software: you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation, either version 2 of the License, or
+ *      (at your option) any later version.
+ *  
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *  
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *  </license>
+ */
+
+
+#ifndef ALLTOALLW_PATTERN_H_
+#define ALLTOALLW_PATTERN_H_
+
+#include "datatypes_bench.h"
+#include "dictionary/keyvalue_store.h"
+
+/* MPI_Alltoallw with a layout per pair of processes: the blocks exchanged between
+ * processes i and j consist of the instances of layout (i+j) mod n of the list formed by the
+ * layout and the optional peer_layouts; for each size of nbytes_list, each block holds as many
+ * instances of its layout as needed for nbytes bytes (test types datatype and pack) */
+int alltoallwpattern(pattern_config_t conf, dictionary_t *dict);
+
+#endif /* ALLTOALLW_PATTERN_H_ */
@@ -25,12 +25,18 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <limits.h>
 #include <assert.h>
 #include <mpi.h>
 
 #include "comm_patterns.h"
 #include "perftypes.h"
 #include "util.h"
+#include "typemap/typemap.h"
+#include "pack_engines/pack_engine.h"
+#include "datatype_cache.h"
+#include "measured_types.h"
+#include "large_count.h"
 //@ add_includes
 
 //@ declare_variables
@@ -48,6 +54,8 @@ static const int CACHE_LINE_SIZE = 64;
 static const char* PATTERN_DYNAMIC = "dynamic";
 static const char* PATTERN_BASIC = "basic";
 
+static const char* TYPE_FORM_ORIGINAL = "original";
+
 
 void send_receive_datatype(int rank, void* sendbuf, void* recvbuf, int c,
         int process1, int process2, MPI_Datatype type, MPI_Comm comm) {
@@ -85,11 +93,11 @@ void send_receive_datatype(int rank, void* sendbuf, void* recvbuf, int c,
 void send_receive_pack(int rank, void* sendbuf, void* recvbuf, int c,
         int process1, int process2, MPI_Datatype type, MPI_Comm comm) {
 
-    int position = 0;
-    int packsize; // int: mistake in standard?
+    MPI_Count position = 0;
+    MPI_Count packsize;
     void *packbuf;
 
-    MPI_Pack_size(c,type, comm, &packsize); // not to measure
+    packsize = get_pack_size(c, type, comm); // not to measure
 
     //packbuf = malloc(packsize);
     posix_memalign(&packbuf, CACHE_LINE_SIZE, packsize);
@@ -99,6 +107,14 @@ void send_receive_pack(int rank, void* sendbuf, void* recvbuf, int c,
 
     //@ initialize_timestamps t1
     //@ initialize_timestamps t2
+    //@ initialize_timestamps tp1
+    //@ initialize_timestamps tp2
+    //@ initialize_timestamps tc1
+    //@ initialize_timestamps tc2
+    //@ initialize_timestamps tu1
+    //@ initialize_timestamps tu2
+    //@ initialize_timestamps tr1
+    //@ initialize_timestamps tr2
 
     //@ start_measurement_loop
 
@@ -106,30 +122,52 @@ void send_receive_pack(int rank, void* sendbuf, void* recvbuf, int c,
     if (rank == process1) {
         position = 0;
 
+        // the phases are timed on process1, such that they add up to its round trip;
+        // comm_time also contains the unpack and pack of process2, which is reported as peer_time
         //@ measure_timestamp t1
-        MPI_Pack(sendbuf, c, type, packbuf, packsize, &position, comm);
-
-        MPI_Send(packbuf, packsize, MPI_PACKED, process2,TYPETAG, comm);
-        MPI_Recv(packbuf, packsize, MPI_PACKED, process2, TYPETAG,comm, MPI_STATUS_IGNORE);
+        //@ measure_timestamp tp1
+        large_pack(sendbuf, c, type, packbuf, packsize, &position, comm);
+        //@ measure_timestamp tp2
+
+        //@ measure_timestamp tc1
+        large_send(packbuf, packsize, MPI_PACKED, process2, TYPETAG, comm);
+        large_recv(packbuf, packsize, MPI_PACKED, process2, TYPETAG, comm);
+        //@ measure_timestamp tc2
         position = 0;
-        MPI_Unpack(packbuf, packsize, &position, recvbuf, c, type, comm);
+        //@ measure_timestamp tu1
+        large_unpack(packbuf, packsize, &position, recvbuf, c, type, comm);
+        //@ measure_timestamp tu2
         //@ measure_timestamp t2
+        //@ measure_timestamp tr1
+        //@ measure_timestamp tr2
 
     } else if (rank == process2) {
         position = 0;
 
         //@ measure_timestamp t1
-        MPI_Recv(packbuf, packsize, MPI_PACKED, process1, TYPETAG, comm, MPI_STATUS_IGNORE);
-        MPI_Unpack(packbuf, packsize, &position, recvbuf, c, type, comm);
+        //@ measure_timestamp tp1
+        //@ measure_timestamp tp2
+        //@ measure_timestamp tc1
+        //@ measure_timestamp tc2
+        //@ measure_timestamp tu1
+        //@ measure_timestamp tu2
+        large_recv(packbuf, packsize, MPI_PACKED, process1, TYPETAG, comm);
+        //@ measure_timestamp tr1
+        large_unpack(packbuf, packsize, &position, recvbuf, c, type, comm);
         position = 0;
-        MPI_Pack(recvbuf, c, type, packbuf, packsize, &position, comm);
-        MPI_Send(packbuf, packsize, MPI_PACKED, process1, TYPETAG, comm);
+        large_pack(recvbuf, c, type, packbuf, packsize, &position, comm);
+        //@ measure_timestamp tr2
+        large_send(packbuf, packsize, MPI_PACKED, process1, TYPETAG, comm);
         //@ measure_timestamp t2
     }
     //@ stop_sync
     //@stop_measurement_loop
 
     //@ print_runtime_array name=runtime end_time=t2 start_time=t1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+    //@ print_runtime_array name=pack_time end_time=tp2 start_time=tp1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+    //@ print_runtime_array name=comm_time end_time=tc2 start_time=tc1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+    //@ print_runtime_array name=unpack_time end_time=tu2 start_time=tu1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+    //@ print_runtime_array name=peer_time end_time=tr2 start_time=tr1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
 
     //@cleanup_variables
     free(packbuf);
@@ -139,16 +177,22 @@ void send_receive_pack(int rank, void* sendbuf, void* recvbuf, int c,
 
 void bcast_pack(int rank, void* bcastbuf, int c,
         MPI_Datatype type, int root_proc, MPI_Comm comm) {
-    int position = 0;
+    MPI_Count position = 0;
     void *packbuf;
-    int packsize; // int: mistake in standard?
+    MPI_Count packsize;
 
     //@ set test_type="pack"
 
     //@ initialize_timestamps t1
     //@ initialize_timestamps t2
-
-    MPI_Pack_size(c, type, comm, &packsize); // not to measure
+    //@ initialize_timestamps tp1
+    //@ initialize_timestamps tp2
+    //@ initialize_timestamps tc1
+    //@ initialize_timestamps tc2
+    //@ initialize_timestamps tu1
+    //@ initialize_timestamps tu2
+
+    packsize = get_pack_size(c, type, comm); // not to measure
     //packbuf = malloc(packsize);
     posix_memalign(&packbuf, CACHE_LINE_SIZE, packsize);
     assert(packbuf!=NULL);
@@ -159,15 +203,27 @@ void bcast_pack(int rank, void* bcastbuf, int c,
     if (rank == root_proc) {
         position = 0;
         //@ measure_timestamp t1
-        MPI_Pack(bcastbuf, c, type, packbuf, packsize, &position, comm);
-        MPI_Bcast(packbuf, packsize, MPI_PACKED, root_proc, comm);
+        //@ measure_timestamp tp1
+        large_pack(bcastbuf, c, type, packbuf, packsize, &position, comm);
+        //@ measure_timestamp tp2
+        //@ measure_timestamp tc1
+        large_bcast(packbuf, packsize, MPI_PACKED, root_proc, comm);
+        //@ measure_timestamp tc2
+        //@ measure_timestamp tu1
+        //@ measure_timestamp tu2
         //@ measure_timestamp t2
 
     } else {
         //@ measure_timestamp t1
-        MPI_Bcast(packbuf, packsize, MPI_PACKED, root_proc, comm);
+        //@ measure_timestamp tp1
+        //@ measure_timestamp tp2
+        //@ measure_timestamp tc1
+        large_bcast(packbuf, packsize, MPI_PACKED, root_proc, comm);
+        //@ measure_timestamp tc2
         position = 0;
-        MPI_Unpack((char*)packbuf, packsize, &position, bcastbuf, c, type, comm);
+        //@ measure_timestamp tu1
+        large_unpack((char*)packbuf, packsize, &position, bcastbuf, c, type, comm);
+        //@ measure_timestamp tu2
         //@ measure_timestamp t2
     }
 
@@ -175,6 +231,9 @@ void bcast_pack(int rank, void* bcastbuf, int c,
     //@stop_measurement_loop
 
     //@ print_runtime_array name=runtime end_time=t2 start_time=t1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+    //@ print_runtime_array name=pack_time end_time=tp2 start_time=tp1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+    //@ print_runtime_array name=comm_time end_time=tc2 start_time=tc1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+    //@ print_runtime_array name=unpack_time end_time=tu2 start_time=tu1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
 
     //@cleanup_variables
     free(packbuf);
@@ -207,15 +266,15 @@ void bcast_datatype(int rank, void* bcastbuf, int c,
 void allgather_pack(int rank, void* sendbuf, void* recvbuf, int c,
         MPI_Datatype type, int root_proc, MPI_Comm comm) {
 
-    int position = 0;
+    MPI_Count position = 0;
     int j, size;
-    int packsize; // int: mistake in standard?
+    MPI_Count packsize;
     void *sendpack, *recvpack;
     MPI_Aint lb, extent;
 
     MPI_Comm_size(comm, &size);
 
-    MPI_Pack_size(c, type, comm, &packsize); // not to measure
+    packsize = get_pack_size(c, type, comm); // not to measure
     //sendpack = malloc(packsize);
     posix_memalign(&sendpack, CACHE_LINE_SIZE, packsize);
     assert(sendpack!=NULL);
@@ -227,29 +286,43 @@ void allgather_pack(int rank, void* sendbuf, void* recvbuf, int c,
 
     //@ initialize_timestamps t1
     //@ initialize_timestamps t2
+    //@ initialize_timestamps tp1
+    //@ initialize_timestamps tp2
+    //@ initialize_timestamps tc1
+    //@ initialize_timestamps tc2
+    //@ initialize_timestamps tu1
+    //@ initialize_timestamps tu2
 
     //@ start_measurement_loop
 
     //@ start_sync
     //@ measure_timestamp t1
+    //@ measure_timestamp tp1
     position = 0;
-    MPI_Pack(sendbuf, c, type, sendpack, packsize, &position, comm);
-    MPI_Allgather(sendpack, packsize, MPI_PACKED,
-            recvpack, packsize, MPI_PACKED, comm);
+    large_pack(sendbuf, c, type, sendpack, packsize, &position, comm);
+    //@ measure_timestamp tp2
+    //@ measure_timestamp tc1
+    large_allgather(sendpack, packsize, MPI_PACKED, recvpack, comm);
+    //@ measure_timestamp tc2
+    //@ measure_timestamp tu1
     // MPI standard: well defined how packunits are concatenated?
     size_t offset = 0;
     for (j=0; j<size; j++) {
       position = 0;
-      MPI_Unpack((char*)recvpack + offset, packsize, &position,
-		 (char*)recvbuf + j*c*extent, c, type, comm);
+      large_unpack((char*)recvpack + offset, packsize, &position,
+		 (char*)recvbuf + (size_t)j*c*extent, c, type, comm);
       offset += packsize;
 
     }
+    //@ measure_timestamp tu2
     //@ measure_timestamp t2
     //@ stop_sync
     //@stop_measurement_loop
 
     //@ print_runtime_array name=runtime end_time=t2 start_time=t1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+    //@ print_runtime_array name=pack_time end_time=tp2 start_time=tp1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+    //@ print_runtime_array name=comm_time end_time=tc2 start_time=tc1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+    //@ print_runtime_array name=unpack_time end_time=tu2 start_time=tu1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
 
     //@cleanup_variables
     free(sendpack);
@@ -281,444 +354,737 @@ void allgather_datatype(int rank, void* sendbuf, void* recvbuf, int c,
 }
 
 
-// between rank 0 and 1 (try even-odd?)
-int pingpongpattern(pattern_config_t conf, dictionary_t *dict)
-{
-    int size, rank;
-    int i;
-    size_t nn;
-    string_array_t* nbytes_list = NULL;
-    void *sendbuf, *recvbuf;
-    MPI_Datatype type;
-    int c, c0;
-    size_t count;
+void gather_pack(int rank, void* sendbuf, void* recvbuf, int c,
+        MPI_Datatype type, int root_proc, MPI_Comm comm) {
 
+    MPI_Count position = 0;
+    int j, size;
+    MPI_Count packsize;
+    void *sendpack, *recvpack;
     MPI_Aint lb, extent;
-    int typesize;
-    char *typesize_str, *real_size_str, *extent_str;
-    int flags;
 
-    MPI_Comm_size(conf.comm,&size);
-    MPI_Comm_rank(conf.comm,&rank);
+    MPI_Comm_size(comm, &size);
 
-    //@ global pattern_type=PATTERN_BASIC
+    packsize = get_pack_size(c, type, comm); // not to measure
+    posix_memalign(&sendpack, CACHE_LINE_SIZE, (size_t)packsize * 1);
+    assert(sendpack!=NULL);
+    posix_memalign(&recvpack, CACHE_LINE_SIZE, (size_t)packsize * size);
+    assert(recvpack!=NULL);
 
-    nbytes_list = get_string_array_from_dict("nbytes_list", dict);
+    MPI_Type_get_extent(type, &lb, &extent);
 
-    // create the datatype:
-    conf.create_datatype(dict, &type, &flags);
+    //@ set test_type="pack"
 
-    if ((flags & PREDEFINED_DT) == 0) { // commit derived datatypes
-        MPI_Type_commit(&type);
-    }
+    //@ initialize_timestamps t1
+    //@ initialize_timestamps t2
+    //@ initialize_timestamps tp1
+    //@ initialize_timestamps tp2
+    //@ initialize_timestamps tc1
+    //@ initialize_timestamps tc2
+    //@ initialize_timestamps tu1
+    //@ initialize_timestamps tu2
 
-    MPI_Type_get_extent(type,&lb,&extent);
-    //MPI_Type_get_true_extent(type,&lb,&extent); // very careful here!
-    MPI_Type_size(type,&typesize);
+    //@ start_measurement_loop
 
-    // time this (but not with simple INC)
-    c0 = -1;
-    for (i=0; i<nbytes_list->n_elems; i++) {
-        count = atol(nbytes_list->elements[i]);
-        c = (count/typesize);
-        if (c==c0) {
-            continue;
+    //@ start_sync
+    //@ measure_timestamp t1
+    //@ measure_timestamp tp1
+    position = 0;
+    large_pack(sendbuf, c, type, sendpack, packsize, &position, comm);
+    //@ measure_timestamp tp2
+    //@ measure_timestamp tc1
+    large_gather(sendpack, packsize, MPI_PACKED, recvpack, root_proc, comm);
+    //@ measure_timestamp tc2
+    //@ measure_timestamp tu1
+    if (rank == root_proc) {
+        for (j=0; j<size; j++) {
+            position = 0;
+            large_unpack((char*)recvpack + (size_t)j*packsize, packsize, &position,
+                    (char*)recvbuf + (size_t)j*c*extent, c, type, comm);
         }
-        c0 = c;
-
-        nn = (count/typesize)*extent; // effective buffer size
+    }
+    //@ measure_timestamp tu2
+    //@ measure_timestamp t2
+    //@ stop_sync
+    //@stop_measurement_loop
 
-        //sendbuf = malloc(nn);
-        posix_memalign(&sendbuf, CACHE_LINE_SIZE, nn);
-        assert(sendbuf!=NULL);
-        //recvbuf = malloc(nn);
-        posix_memalign(&recvbuf, CACHE_LINE_SIZE, nn);
-        assert(recvbuf!=NULL);
+    //@ print_runtime_array name=runtime end_time=t2 start_time=t1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+    //@ print_runtime_array name=pack_time end_time=tp2 start_time=tp1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+    //@ print_runtime_array name=comm_time end_time=tc2 start_time=tc1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+    //@ print_runtime_array name=unpack_time end_time=tu2 start_time=tu1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
 
+    //@cleanup_variables
+    free(sendpack);
+    free(recvpack);
+}
 
-        /* this is needed to avoid mem leaks */
-        typesize_str  = my_int_to_string(typesize);
-        extent_str  = my_int_to_string(extent);
-        real_size_str = my_int_to_string(c*typesize);
 
-        //@ set nbytes_str=nbytes_list->elements[i]
-        //@ set derivedtype_size=typesize_str
-        //@ set real_size=real_size_str
-        //@ set derivedtype_extent=extent_str
+void gather_datatype(int rank, void* sendbuf, void* recvbuf, int c,
+        MPI_Datatype type, int root_proc, MPI_Comm comm) {
 
-        if (conf.use_datatype) {
-            send_receive_datatype(rank, sendbuf, recvbuf, c, PROC1, PROC2, type, conf.comm);
-        }
-        else {
-            send_receive_pack(rank, sendbuf, recvbuf, c, PROC1, PROC2, type, conf.comm);
-        }
+    //@ set test_type="datatype"
 
-        free(typesize_str);
-        free(extent_str);
-        free(real_size_str);
+    //@ initialize_timestamps t1
+    //@ initialize_timestamps t2
 
-        free(sendbuf);
-        free(recvbuf);
-    }
+    //@ start_measurement_loop
 
-    if ((flags & PREDEFINED_DT) == 0) { // free derived datatypes
-        MPI_Type_free(&type);
-    }
+    //@ start_sync
+    //@ measure_timestamp t1
+    MPI_Gather(sendbuf, c, type, recvbuf, c, type, root_proc, comm);
+    //@ measure_timestamp t2
+    //@ stop_sync
+    //@stop_measurement_loop
 
-    for (i=0; i<nbytes_list->n_elems; i++) {
-        free(nbytes_list->elements[i]);
-    }
-    free(nbytes_list->elements);
-    free(nbytes_list);
+    //@ print_runtime_array name=runtime end_time=t2 start_time=t1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
 
-    return MPI_SUCCESS; // no...
+    //@cleanup_variables
 }
 
-int bcastpattern(pattern_config_t conf, dictionary_t *dict)
-{
-    int size, rank;
-    int i;
-    size_t nn;
-    void *bcastbuf;
-    MPI_Datatype type;
-    int c, c0;
-    size_t  count;
+
+void scatter_pack(int rank, void* sendbuf, void* recvbuf, int c,
+        MPI_Datatype type, int root_proc, MPI_Comm comm) {
+
+    MPI_Count position = 0;
+    int j, size;
+    MPI_Count packsize;
+    void *sendpack, *recvpack;
     MPI_Aint lb, extent;
-    int typesize;
-    string_array_t* nbytes_list = NULL;
-    char *typesize_str, *real_size_str, *extent_str;
-    int flags;
 
-    MPI_Comm_size(conf.comm,&size);
-    MPI_Comm_rank(conf.comm,&rank);
+    MPI_Comm_size(comm, &size);
 
-    //@ global pattern_type=PATTERN_BASIC
+    packsize = get_pack_size(c, type, comm); // not to measure
+    posix_memalign(&sendpack, CACHE_LINE_SIZE, (size_t)packsize * size);
+    assert(sendpack!=NULL);
+    posix_memalign(&recvpack, CACHE_LINE_SIZE, (size_t)packsize * 1);
+    assert(recvpack!=NULL);
 
-    nbytes_list = get_string_array_from_dict("nbytes_list", dict);
+    MPI_Type_get_extent(type, &lb, &extent);
 
-    // create datatype
-    conf.create_datatype(dict, &type, &flags);
+    //@ set test_type="pack"
 
-    if ((flags & PREDEFINED_DT) == 0) { // commit derived datatypes
-        MPI_Type_commit(&type);
-    }
+    //@ initialize_timestamps t1
+    //@ initialize_timestamps t2
+    //@ initialize_timestamps tp1
+    //@ initialize_timestamps tp2
+    //@ initialize_timestamps tc1
+    //@ initialize_timestamps tc2
+    //@ initialize_timestamps tu1
+    //@ initialize_timestamps tu2
 
-    MPI_Type_get_extent(type,&lb,&extent);
-    //MPI_Type_get_true_extent(type,&lb,&extent); // very careful here!
-    MPI_Type_size(type,&typesize);
+    //@ start_measurement_loop
 
-    // time this (but not with simple INC)
-    c0 = -1;
-    for (i=0; i<nbytes_list->n_elems; i++) {
-        count = atol(nbytes_list->elements[i]);
-        c = (count/typesize);
-        if (c==c0) {
-            continue;
-        }
-        c0 = c;
-        if( c <= 0 ) {
-          fprintf(stderr, "count=%ld typesize=%d invalid...skipping case\n", count, typesize);
-          continue;
+    //@ start_sync
+    //@ measure_timestamp t1
+    //@ measure_timestamp tp1
+    if (rank == root_proc) {
+        for (j=0; j<size; j++) {
+            position = 0;
+            large_pack((char*)sendbuf + (size_t)j*c*extent, c, type, (char*)sendpack + (size_t)j*packsize,
+                    packsize, &position, comm);
         }
+    }
+    //@ measure_timestamp tp2
+    //@ measure_timestamp tc1
+    large_scatter(sendpack, packsize, MPI_PACKED, recvpack, root_proc, comm);
+    //@ measure_timestamp tc2
+    //@ measure_timestamp tu1
+    position = 0;
+    large_unpack(recvpack, packsize, &position, recvbuf, c, type, comm);
+    //@ measure_timestamp tu2
+    //@ measure_timestamp t2
+    //@ stop_sync
+    //@stop_measurement_loop
 
-        nn = (count/typesize)*extent; // effective buffer size
-        // bcastbuf = malloc(nn);
-        posix_memalign(&bcastbuf, CACHE_LINE_SIZE, nn);
-        assert(bcastbuf!=NULL);
-
-        /* this is needed to avoid mem leaks */
-        typesize_str  = my_int_to_string(typesize);
-        extent_str  = my_int_to_string(extent);
-        real_size_str = my_int_to_string(c*typesize);
+    //@ print_runtime_array name=runtime end_time=t2 start_time=t1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+    //@ print_runtime_array name=pack_time end_time=tp2 start_time=tp1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+    //@ print_runtime_array name=comm_time end_time=tc2 start_time=tc1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+    //@ print_runtime_array name=unpack_time end_time=tu2 start_time=tu1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
 
-        //@ set nbytes_str=nbytes_list->elements[i]
-        //@ set derivedtype_size=typesize_str
-        //@ set real_size=real_size_str
-        //@ set derivedtype_extent=extent_str
+    //@cleanup_variables
+    free(sendpack);
+    free(recvpack);
+}
 
-        if (conf.use_datatype) {
-            bcast_datatype(rank, bcastbuf, c, type, conf.root_proc, conf.comm);
-        }
-        else {
-            bcast_pack(rank, bcastbuf, c, type, conf.root_proc, conf.comm);
-        }
 
-        free(typesize_str);
-        free(extent_str);
-        free(real_size_str);
+void scatter_datatype(int rank, void* sendbuf, void* recvbuf, int c,
+        MPI_Datatype type, int root_proc, MPI_Comm comm) {
 
-        free(bcastbuf);
-    }
+    //@ set test_type="datatype"
 
-    if ((flags & PREDEFINED_DT) == 0) { // free derived datatypes
-        MPI_Type_free(&type);
-    }
+    //@ initialize_timestamps t1
+    //@ initialize_timestamps t2
 
-    for (i=0; i<nbytes_list->n_elems; i++) {
-        free(nbytes_list->elements[i]);
-    }
-    free(nbytes_list->elements);
-    free(nbytes_list);
+    //@ start_measurement_loop
 
-    return MPI_SUCCESS; // no...
-}
+    //@ start_sync
+    //@ measure_timestamp t1
+    MPI_Scatter(sendbuf, c, type, recvbuf, c, type, root_proc, comm);
+    //@ measure_timestamp t2
+    //@ stop_sync
+    //@stop_measurement_loop
 
-// n: max block size in bytes
-int allgatherpattern(pattern_config_t conf, dictionary_t *dict)
-{
-    int size, rank;
-    int i;
-    size_t nn;
-    //int n;
-    void *sendbuf, *recvbuf;
-    MPI_Datatype type;
-    int c, c0;
-    size_t count;
-    string_array_t* nbytes_list = NULL;
+    //@ print_runtime_array name=runtime end_time=t2 start_time=t1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
 
-    MPI_Aint lb, extent;
-    int typesize;
-    char *typesize_str, *real_size_str, *extent_str;
-    int flags;
+    //@cleanup_variables
+}
 
-    MPI_Comm_size(conf.comm,&size);
-    MPI_Comm_rank(conf.comm,&rank);
 
-    //@ global pattern_type=PATTERN_BASIC
+void alltoall_pack(int rank, void* sendbuf, void* recvbuf, int c,
+        MPI_Datatype type, int root_proc, MPI_Comm comm) {
 
-    nbytes_list = get_string_array_from_dict("nbytes_list", dict);
+    MPI_Count position = 0;
+    int j, size;
+    MPI_Count packsize;
+    void *sendpack, *recvpack;
+    MPI_Aint lb, extent;
 
-    // create datatype
-    conf.create_datatype(dict, &type, &flags);
+    MPI_Comm_size(comm, &size);
 
-    if ((flags & PREDEFINED_DT) == 0) { // commit derived datatypes
-        MPI_Type_commit(&type);
-    }
+    packsize = get_pack_size(c, type, comm); // not to measure
+    posix_memalign(&sendpack, CACHE_LINE_SIZE, (size_t)packsize * size);
+    assert(sendpack!=NULL);
+    posix_memalign(&recvpack, CACHE_LINE_SIZE, (size_t)packsize * size);
+    assert(recvpack!=NULL);
 
-    MPI_Type_get_extent(type,&lb,&extent);
-    //MPI_Type_get_true_extent(type,&lb,&extent); // very careful here!
-    MPI_Type_size(type,&typesize);
+    MPI_Type_get_extent(type, &lb, &extent);
 
-    // time this (but not with simple INC)
-    c0 = -1;
-    for (i=0; i<nbytes_list->n_elems; i++) {
-        count = atol(nbytes_list->elements[i]);
-        c = (count/typesize);
-        if (c==c0) {
-            continue;
-        }
-        c0 = c;
-        if( c <= 0 ) {
-          fprintf(stderr, "count=%ld typesize=%d invalid...skipping case\n", count, typesize);
-          continue;
-        }
+    //@ set test_type="pack"
 
-        nn = c*extent; // effective buffer size
-        //sendbuf = malloc(nn);
-        posix_memalign(&sendbuf, CACHE_LINE_SIZE, nn);
-        assert(sendbuf!=NULL);
-        //recvbuf = malloc(nn * size);
-        posix_memalign(&recvbuf, CACHE_LINE_SIZE, nn * size);
-        assert(recvbuf!=NULL);
-
-        /* this is needed to avoid mem leaks */
-        typesize_str  = my_int_to_string(typesize);
-        extent_str  = my_int_to_string(extent);
-        real_size_str = my_int_to_string(c*typesize);
-
-        //@ set nbytes_str=nbytes_list->elements[i]
-        //@ set derivedtype_size=typesize_str
-        //@ set real_size=real_size_str
-        //@ set derivedtype_extent=extent_str
-
-        if (conf.use_datatype) {
-            allgather_datatype(rank, sendbuf, recvbuf, c, type, conf.root_proc, conf.comm);
-        }
-        else {
-            allgather_pack(rank, sendbuf, recvbuf, c, type, conf.root_proc, conf.comm);
-        }
+    //@ initialize_timestamps t1
+    //@ initialize_timestamps t2
+    //@ initialize_timestamps tp1
+    //@ initialize_timestamps tp2
+    //@ initialize_timestamps tc1
+    //@ initialize_timestamps tc2
+    //@ initialize_timestamps tu1
+    //@ initialize_timestamps tu2
 
-        free(typesize_str);
-        free(extent_str);
-        free(real_size_str);
+    //@ start_measurement_loop
 
-        free(sendbuf);
-        free(recvbuf);
+    //@ start_sync
+    //@ measure_timestamp t1
+    //@ measure_timestamp tp1
+    for (j=0; j<size; j++) {
+        position = 0;
+        large_pack((char*)sendbuf + (size_t)j*c*extent, c, type, (char*)sendpack + (size_t)j*packsize,
+                packsize, &position, comm);
     }
-
-    if ((flags & PREDEFINED_DT) == 0) { // free derived datatypes
-        MPI_Type_free(&type);
+    //@ measure_timestamp tp2
+    //@ measure_timestamp tc1
+    large_alltoall(sendpack, packsize, MPI_PACKED, recvpack, comm);
+    //@ measure_timestamp tc2
+    //@ measure_timestamp tu1
+    for (j=0; j<size; j++) {
+        position = 0;
+        large_unpack((char*)recvpack + (size_t)j*packsize, packsize, &position,
+                (char*)recvbuf + (size_t)j*c*extent, c, type, comm);
     }
+    //@ measure_timestamp tu2
+    //@ measure_timestamp t2
+    //@ stop_sync
+    //@stop_measurement_loop
 
-    for (i=0; i<nbytes_list->n_elems; i++) {
-        free(nbytes_list->elements[i]);
-    }
-    free(nbytes_list->elements);
-    free(nbytes_list);
+    //@ print_runtime_array name=runtime end_time=t2 start_time=t1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+    //@ print_runtime_array name=pack_time end_time=tp2 start_time=tp1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+    //@ print_runtime_array name=comm_time end_time=tc2 start_time=tc1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+    //@ print_runtime_array name=unpack_time end_time=tu2 start_time=tu1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
 
-    return MPI_SUCCESS; // no...
+    //@cleanup_variables
+    free(sendpack);
+    free(recvpack);
 }
 
 
-/* Dynamic patterns: all data are represented by the datatype, counts are 1 */
+void alltoall_datatype(int rank, void* sendbuf, void* recvbuf, int c,
+        MPI_Datatype type, int root_proc, MPI_Comm comm) {
 
-int pingpongpattern_dynamictype(pattern_config_t conf, dictionary_t *dict)
-{
-    int size, rank;
-    int i;
-    size_t nn;
-    void *sendbuf, *recvbuf;
-    MPI_Datatype type;
-    int c;
-    size_t c0;
-    MPI_Aint lb, extent;
-    int typesize;
-    string_array_t* nbytes_list = NULL;
-    size_t nbytes;
-    char *typesize_str, *real_size_str, *extent_str;
-    int flags;
+    //@ set test_type="datatype"
 
-    MPI_Comm_size(conf.comm,&size);
-    MPI_Comm_rank(conf.comm,&rank);
+    //@ initialize_timestamps t1
+    //@ initialize_timestamps t2
 
-    //@ global pattern_type=PATTERN_DYNAMIC
+    //@ start_measurement_loop
 
-    nbytes_list = get_string_array_from_dict("nbytes_list", dict);
+    //@ start_sync
+    //@ measure_timestamp t1
+    MPI_Alltoall(sendbuf, c, type, recvbuf, c, type, comm);
+    //@ measure_timestamp t2
+    //@ stop_sync
+    //@stop_measurement_loop
 
-    // time this (but not with simple INC)
-    c0 = -1;
-    for (i=0; i<nbytes_list->n_elems; i++) {
-        nbytes = atol(nbytes_list->elements[i]);
+    //@ print_runtime_array name=runtime end_time=t2 start_time=t1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
 
-        // create datatype
-        instantiate_dynamic_datatype(conf, dict, nbytes, &type, &c, &flags);
-        if (nbytes==c0) {
-            continue;
-        }
-        c0 = nbytes;
+    //@cleanup_variables
+}
 
 
-        MPI_Type_get_extent(type,&lb,&extent);
-        MPI_Type_size(type,&typesize);
+void send_receive_manual(int rank, void* sendbuf, void* recvbuf, int c,
+        int process1, int process2, MPI_Datatype type, const char* engine, MPI_Comm comm) {
 
-        nn = c * extent; // effective buffer size
-        //sendbuf = malloc(nn);
-        posix_memalign(&sendbuf, CACHE_LINE_SIZE, nn);
-        assert(sendbuf!=NULL);
-        //recvbuf = malloc(nn);
-        posix_memalign(&recvbuf, CACHE_LINE_SIZE, nn);
-        assert(recvbuf!=NULL);
+    pack_handle_t handle;
+    MPI_Count packsize;
+    void *packbuf;
 
-        /* this is needed to avoid mem leaks */
-        typesize_str  = my_int_to_string(typesize);
-        extent_str  = my_int_to_string(extent);
-        real_size_str = my_int_to_string(c*typesize);
+    init_pack_handle(engine, type, c, &handle); // not to measure
+    packsize = handle.packsize;
 
-        //@ set nbytes_str=nbytes_list->elements[i]
-        //@ set derivedtype_size=typesize_str
-        //@ set real_size=real_size_str
-        //@ set derivedtype_extent=extent_str
+    posix_memalign(&packbuf, CACHE_LINE_SIZE, packsize);
+    assert(packbuf!=NULL);
 
-        if (conf.use_datatype) {
-            send_receive_datatype(rank, sendbuf, recvbuf, c, PROC1, PROC2, type, conf.comm);
-        }
-        else {
-            send_receive_pack(rank, sendbuf, recvbuf, c, PROC1, PROC2, type, conf.comm);
-        }
+    //@ set test_type="manual"
+    //@ set pack_engine=engine
 
-        free(typesize_str);
-        free(extent_str);
-        free(real_size_str);
+    //@ initialize_timestamps t1
+    //@ initialize_timestamps t2
 
-        free(sendbuf);
-        free(recvbuf);
-        if ((flags & PREDEFINED_DT) == 0) { // free derived datatypes
-            MPI_Type_free(&type);
-        }
+    //@ start_measurement_loop
+
+    //@ start_sync
+    if (rank == process1) {
+        //@ measure_timestamp t1
+        pack_with_engine(&handle, sendbuf, packbuf);
+
+        large_send(packbuf, packsize, MPI_BYTE, process2, TYPETAG, comm);
+        large_recv(packbuf, packsize, MPI_BYTE, process2, TYPETAG, comm);
+        unpack_with_engine(&handle, packbuf, recvbuf);
+        //@ measure_timestamp t2
+
+    } else if (rank == process2) {
+        //@ measure_timestamp t1
+        large_recv(packbuf, packsize, MPI_BYTE, process1, TYPETAG, comm);
+        unpack_with_engine(&handle, packbuf, recvbuf);
+        pack_with_engine(&handle, recvbuf, packbuf);
+        large_send(packbuf, packsize, MPI_BYTE, process1, TYPETAG, comm);
+        //@ measure_timestamp t2
     }
+    //@ stop_sync
+    //@stop_measurement_loop
 
+    //@ print_runtime_array name=runtime end_time=t2 start_time=t1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
 
-    for (i=0; i<nbytes_list->n_elems; i++) {
-        free(nbytes_list->elements[i]);
+    //@cleanup_variables
+    free(packbuf);
+    cleanup_pack_handle(&handle);
+}
+
+
+void bcast_manual(int rank, void* bcastbuf, int c,
+        MPI_Datatype type, int root_proc, const char* engine, MPI_Comm comm) {
+    pack_handle_t handle;
+    MPI_Count packsize;
+    void *packbuf;
+
+    //@ set test_type="manual"
+    //@ set pack_engine=engine
+
+    //@ initialize_timestamps t1
+    //@ initialize_timestamps t2
+
+    init_pack_handle(engine, type, c, &handle); // not to measure
+    packsize = handle.packsize;
+    posix_memalign(&packbuf, CACHE_LINE_SIZE, packsize);
+    assert(packbuf!=NULL);
+
+    //@ start_measurement_loop
+
+    //@ start_sync
+    if (rank == root_proc) {
+        //@ measure_timestamp t1
+        pack_with_engine(&handle, bcastbuf, packbuf);
+        large_bcast(packbuf, packsize, MPI_BYTE, root_proc, comm);
+        //@ measure_timestamp t2
+
+    } else {
+        //@ measure_timestamp t1
+        large_bcast(packbuf, packsize, MPI_BYTE, root_proc, comm);
+        unpack_with_engine(&handle, packbuf, bcastbuf);
+        //@ measure_timestamp t2
     }
-    free(nbytes_list->elements);
-    free(nbytes_list);
 
-    return MPI_SUCCESS; // no...
+    //@ stop_sync
+    //@stop_measurement_loop
+
+    //@ print_runtime_array name=runtime end_time=t2 start_time=t1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+
+    //@cleanup_variables
+    free(packbuf);
+    cleanup_pack_handle(&handle);
 }
 
 
+void allgather_manual(int rank, void* sendbuf, void* recvbuf, int c,
+        MPI_Datatype type, int root_proc, const char* engine, MPI_Comm comm) {
 
-int bcastpattern_dynamictype(pattern_config_t conf, dictionary_t *dict)
-{
-    int size, rank;
-    int i;
+    int j, size;
+    MPI_Count packsize;
+    void *sendpack, *recvpack;
+    pack_handle_t handle;
+    MPI_Aint lb, extent;
+
+    MPI_Comm_size(comm, &size);
+
+    init_pack_handle(engine, type, c, &handle); // not to measure
+    packsize = handle.packsize;
+    posix_memalign(&sendpack, CACHE_LINE_SIZE, packsize);
+    assert(sendpack!=NULL);
+    posix_memalign(&recvpack, CACHE_LINE_SIZE, (size_t)packsize * size);
+    assert(recvpack!=NULL);
+
+    MPI_Type_get_extent(type, &lb, &extent);
+
+    //@ set test_type="manual"
+    //@ set pack_engine=engine
+
+    //@ initialize_timestamps t1
+    //@ initialize_timestamps t2
+
+    //@ start_measurement_loop
+
+    //@ start_sync
+    //@ measure_timestamp t1
+    pack_with_engine(&handle, sendbuf, sendpack);
+    large_allgather(sendpack, packsize, MPI_BYTE, recvpack, comm);
+    for (j=0; j<size; j++) {
+      unpack_with_engine(&handle, (char*)recvpack + (size_t)j*packsize,
+          (char*)recvbuf + (size_t)j*c*extent);
+    }
+    //@ measure_timestamp t2
+    //@ stop_sync
+    //@stop_measurement_loop
+
+    //@ print_runtime_array name=runtime end_time=t2 start_time=t1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+
+    //@cleanup_variables
+    free(sendpack);
+    free(recvpack);
+    cleanup_pack_handle(&handle);
+}
+
+/* the packed buffer is divided into segments of segment_size bytes (the last one may be shorter),
+ * independent of the instances of the layout, such that also a single large instance is pipelined;
+ * each segment is packed (memcpy on the flattened layout) and sent with MPI_Isend while the next one
+ * is packed; the receiver posts all receives upfront and unpacks the segments in arrival order */
+static void pack_and_isend_segments(void* buf, const pack_handle_t *handle, const pack_range_t *segs, int nsegs,
+        void* packbuf, int dest, MPI_Request* reqs, MPI_Comm comm) {
+    int s;
+
+    for (s = 0; s < nsegs; s++) {
+        pack_range(handle, &segs[s], buf, (char*)packbuf + segs[s].pack_offset);
+        MPI_Isend((char*)packbuf + segs[s].pack_offset, (int)segs[s].nbytes, MPI_BYTE, dest, TYPETAG, comm, &reqs[s]);
+    }
+    MPI_Waitall(nsegs, reqs, MPI_STATUSES_IGNORE);
+}
+
+static void irecv_segments(const pack_range_t *segs, int nsegs, void* packbuf, int source,
+        MPI_Request* reqs, MPI_Comm comm) {
+    int s;
+
+    for (s = 0; s < nsegs; s++) {
+        MPI_Irecv((char*)packbuf + segs[s].pack_offset, (int)segs[s].nbytes, MPI_BYTE, source, TYPETAG, comm, &reqs[s]);
+    }
+}
+
+static void wait_and_unpack_segments(void* buf, const pack_handle_t *handle, const pack_range_t *segs, int nsegs,
+        void* packbuf, MPI_Request* reqs) {
+    int i, s;
+
+    for (i = 0; i < nsegs; i++) {
+        MPI_Waitany(nsegs, reqs, &s, MPI_STATUS_IGNORE);
+        unpack_range(handle, &segs[s], (char*)packbuf + segs[s].pack_offset, buf);
+    }
+}
+
+
+void send_receive_pipelined(int rank, void* sendbuf, void* recvbuf, int c,
+        int process1, int process2, MPI_Datatype type, int segment_size, MPI_Comm comm) {
+
+    pack_handle_t handle;
+    pack_range_t *segs;
+    int nsegs;
+    void *packbuf;
+    MPI_Request *reqs;
+    char *segment_str;
+
+    // not to measure
+    init_pack_handle("memcpy", type, c, &handle);
+    nsegs = split_pack_handle(&handle, segment_size, &segs);
+
+    posix_memalign(&packbuf, CACHE_LINE_SIZE, handle.packsize + 1);
+    assert(packbuf!=NULL);
+    reqs = (MPI_Request*)malloc((nsegs + 1) * sizeof(MPI_Request));
+    assert(reqs!=NULL);
+    segment_str = my_count_to_string(((size_t)segment_size < handle.packsize) ? (size_t)segment_size : handle.packsize);
+
+    //@ set test_type="pipelined"
+    //@ set segment_bytes=segment_str
+
+    //@ initialize_timestamps t1
+    //@ initialize_timestamps t2
+
+    //@ start_measurement_loop
+
+    //@ start_sync
+    if (rank == process1) {
+        //@ measure_timestamp t1
+        pack_and_isend_segments(sendbuf, &handle, segs, nsegs, packbuf, process2, reqs, comm);
+        irecv_segments(segs, nsegs, packbuf, process2, reqs, comm);
+        wait_and_unpack_segments(recvbuf, &handle, segs, nsegs, packbuf, reqs);
+        //@ measure_timestamp t2
+
+    } else if (rank == process2) {
+        //@ measure_timestamp t1
+        irecv_segments(segs, nsegs, packbuf, process1, reqs, comm);
+        wait_and_unpack_segments(recvbuf, &handle, segs, nsegs, packbuf, reqs);
+        pack_and_isend_segments(recvbuf, &handle, segs, nsegs, packbuf, process1, reqs, comm);
+        //@ measure_timestamp t2
+    }
+    //@ stop_sync
+    //@stop_measurement_loop
+
+    //@ print_runtime_array name=runtime end_time=t2 start_time=t1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+
+    //@cleanup_variables
+    free(segment_str);
+    free(reqs);
+    free(segs);
+    free(packbuf);
+    cleanup_pack_handle(&handle);
+}
+
+
+static void pipelined_not_supported(const char* pattern) {
+    printf("Error: test_type pipelined is only supported by the pingpong patterns (not %s)\n", pattern);
+    exit(1);
+}
+
+static void only_datatype_and_pack(const char* pattern) {
+    printf("Error: the %s pattern only supports the test types datatype and pack\n", pattern);
+    exit(1);
+}
+
+static void run_pingpong(pattern_config_t conf, int rank, void* sendbuf, void* recvbuf, int c,
+        MPI_Datatype type) {
+    switch (conf.test_type) {
+    case test_datatype:
+        send_receive_datatype(rank, sendbuf, recvbuf, c, PROC1, PROC2, type, conf.comm);
+        break;
+    case test_pack:
+        send_receive_pack(rank, sendbuf, recvbuf, c, PROC1, PROC2, type, conf.comm);
+        break;
+    case test_manual:
+        send_receive_manual(rank, sendbuf, recvbuf, c, PROC1, PROC2, type, conf.pack_engine, conf.comm);
+        break;
+    case test_pipelined:
+        send_receive_pipelined(rank, sendbuf, recvbuf, c, PROC1, PROC2, type, conf.segment_size, conf.comm);
+        break;
+    }
+}
+
+static void run_bcast(pattern_config_t conf, int rank, void* bcastbuf, void* recvbuf, int c, MPI_Datatype type) {
+    switch (conf.test_type) {
+    case test_datatype:
+        bcast_datatype(rank, bcastbuf, c, type, conf.root_proc, conf.comm);
+        break;
+    case test_pack:
+        bcast_pack(rank, bcastbuf, c, type, conf.root_proc, conf.comm);
+        break;
+    case test_manual:
+        bcast_manual(rank, bcastbuf, c, type, conf.root_proc, conf.pack_engine, conf.comm);
+        break;
+    case test_pipelined:
+        pipelined_not_supported("bcast");
+        break;
+    }
+}
+
+static void run_allgather(pattern_config_t conf, int rank, void* sendbuf, void* recvbuf, int c,
+        MPI_Datatype type) {
+    switch (conf.test_type) {
+    case test_datatype:
+        allgather_datatype(rank, sendbuf, recvbuf, c, type, conf.root_proc, conf.comm);
+        break;
+    case test_pack:
+        allgather_pack(rank, sendbuf, recvbuf, c, type, conf.root_proc, conf.comm);
+        break;
+    case test_manual:
+        allgather_manual(rank, sendbuf, recvbuf, c, type, conf.root_proc, conf.pack_engine, conf.comm);
+        break;
+    case test_pipelined:
+        pipelined_not_supported("allgather");
+        break;
+    }
+}
+
+static void run_gather(pattern_config_t conf, int rank, void* sendbuf, void* recvbuf, int c,
+        MPI_Datatype type) {
+    switch (conf.test_type) {
+    case test_datatype:
+        gather_datatype(rank, sendbuf, recvbuf, c, type, conf.root_proc, conf.comm);
+        break;
+    case test_pack:
+        gather_pack(rank, sendbuf, recvbuf, c, type, conf.root_proc, conf.comm);
+        break;
+    default:
+        only_datatype_and_pack("gather");
+        break;
+    }
+}
+
+static void run_scatter(pattern_config_t conf, int rank, void* sendbuf, void* recvbuf, int c,
+        MPI_Datatype type) {
+    switch (conf.test_type) {
+    case test_datatype:
+        scatter_datatype(rank, sendbuf, recvbuf, c, type, conf.root_proc, conf.comm);
+        break;
+    case test_pack:
+        scatter_pack(rank, sendbuf, recvbuf, c, type, conf.root_proc, conf.comm);
+        break;
+    default:
+        only_datatype_and_pack("scatter");
+        break;
+    }
+}
+
+static void run_alltoall(pattern_config_t conf, int rank, void* sendbuf, void* recvbuf, int c,
+        MPI_Datatype type) {
+    switch (conf.test_type) {
+    case test_datatype:
+        alltoall_datatype(rank, sendbuf, recvbuf, c, type, conf.root_proc, conf.comm);
+        break;
+    case test_pack:
+        alltoall_pack(rank, sendbuf, recvbuf, c, type, conf.root_proc, conf.comm);
+        break;
+    default:
+        only_datatype_and_pack("alltoall");
+        break;
+    }
+}
+
+
+// buffers for count instances of the layout (send_blocks and recv_blocks times; no receive buffer if recv_blocks is 0)
+static void alloc_pattern_buffers(int c, MPI_Aint extent, int send_blocks, int recv_blocks,
+        void** sendbuf, void** recvbuf) {
     size_t nn;
-    void *bcastbuf;
-    MPI_Datatype type;
-    int c;
-    size_t c0;
+
+    nn = (size_t)c*extent; // effective buffer size
+    posix_memalign(sendbuf, CACHE_LINE_SIZE, nn * send_blocks);
+    assert(*sendbuf!=NULL);
+    *recvbuf = NULL;
+    if (recv_blocks > 0) {
+        posix_memalign(recvbuf, CACHE_LINE_SIZE, nn * recv_blocks);
+        assert(*recvbuf!=NULL);
+    }
+}
+
+
+static void measure_pattern_size(pattern_config_t conf, int rank, pattern_run_t run, int send_blocks, int recv_blocks,
+        char* nbytes_str, int c, MPI_Datatype type) {
+    void *sendbuf, *recvbuf;
     MPI_Aint lb, extent;
-    int typesize;
+    MPI_Count typesize;
+    char *typesize_str, *real_size_str, *extent_str, *nblocks_str, *mean_block_str;
+    MPI_Count nblocks;
+    MPI_Datatype normtype;
+    normal_form_t form;
+
+    if (conf.normalize) {
+        create_normalized_datatype(type, &normtype, &form);
+    }
+
+    MPI_Type_get_extent(type,&lb,&extent);
+    //MPI_Type_get_true_extent(type,&lb,&extent); // very careful here!
+    typesize = get_type_size(type);
+
+    alloc_pattern_buffers(c, extent, send_blocks, recv_blocks, &sendbuf, &recvbuf);
+
+    /* this is needed to avoid mem leaks */
+    typesize_str  = my_count_to_string(typesize);
+    extent_str  = my_count_to_string(extent);
+    real_size_str = my_count_to_string(c*typesize);
+    nblocks = get_typemap_nblocks(type, c);
+    nblocks_str = my_count_to_string(nblocks);
+    mean_block_str = my_count_to_string((nblocks > 0) ? c*typesize/nblocks : 0);
+
+    //@ set nbytes_str=nbytes_str
+    //@ set derivedtype_size=typesize_str
+    //@ set real_size=real_size_str
+    //@ set derivedtype_extent=extent_str
+    //@ set nblocks=nblocks_str
+    //@ set mean_block=mean_block_str
+
+    //@ set type_form=TYPE_FORM_ORIGINAL
+    run(conf, rank, sendbuf, recvbuf, c, type);
+    if (conf.normalize) {
+        //@ set type_form=normal_form_names[form]
+        run(conf, rank, sendbuf, recvbuf, c, normtype);
+        MPI_Type_free(&normtype);
+    }
+
+    free(typesize_str);
+    free(extent_str);
+    free(real_size_str);
+    free(nblocks_str);
+    free(mean_block_str);
+
+    free(sendbuf);
+    free(recvbuf);
+}
+
+
+// skip_empty: skip sizes with less than one instance of the datatype (the basic pingpong measures them)
+static int measure_basic_pattern_sizes(pattern_config_t conf, dictionary_t *dict, pattern_run_t run,
+        int send_blocks, int recv_blocks, int skip_empty)
+{
+    int rank;
+    int i;
     string_array_t* nbytes_list = NULL;
-    size_t nbytes;
-    char *typesize_str, *real_size_str, *extent_str;
+    MPI_Datatype type;
+    int c, c0;
+    size_t count;
+    MPI_Count typesize;
     int flags;
 
-    MPI_Comm_size(conf.comm,&size);
     MPI_Comm_rank(conf.comm,&rank);
 
-    //@ global pattern_type=PATTERN_DYNAMIC
+    //@ global pattern_type=PATTERN_BASIC
 
     nbytes_list = get_string_array_from_dict("nbytes_list", dict);
 
+    // create the datatype:
+    conf.create_datatype(dict, &type, &flags);
+
+    if ((flags & PREDEFINED_DT) == 0) { // commit derived datatypes
+        MPI_Type_commit(&type);
+    }
+    typesize = get_type_size(type);
+
     // time this (but not with simple INC)
     c0 = -1;
     for (i=0; i<nbytes_list->n_elems; i++) {
-        nbytes = atol(nbytes_list->elements[i]);
-
-        // create datatype
-        instantiate_dynamic_datatype(conf, dict, nbytes, &type, &c, &flags);
-        if (nbytes==c0) {
+        count = atol(nbytes_list->elements[i]);
+        if (count/typesize > INT_MAX) {
+            fprintf(stderr, "WARNING: count=%ld exceeds %d instances of the datatype...skipping case\n", count, INT_MAX);
             continue;
         }
-        c0 = nbytes;
-
-
-        MPI_Type_get_extent(type,&lb,&extent);
-        MPI_Type_size(type,&typesize);
-
-        nn = c * extent;
-        //bcastbuf = malloc(nn);
-        posix_memalign(&bcastbuf, CACHE_LINE_SIZE, nn);
-        assert(bcastbuf!=NULL);
-
-        /* this is needed to avoid mem leaks */
-        typesize_str  = my_int_to_string(typesize);
-        extent_str  = my_int_to_string(extent);
-        real_size_str = my_int_to_string(c*typesize);
-
-        //@ set nbytes_str=nbytes_list->elements[i]
-        //@ set derivedtype_size=typesize_str
-        //@ set real_size=real_size_str
-        //@ set derivedtype_extent=extent_str
-
-        if (conf.use_datatype) {
-            bcast_datatype(rank, bcastbuf, c, type, conf.root_proc, conf.comm);
+        c = (count/typesize);
+        if (c==c0) {
+            continue;
         }
-        else {
-            bcast_pack(rank, bcastbuf, c, type, conf.root_proc, conf.comm);
+        c0 = c;
+        if (skip_measured_type(conf, type, c)) {
+            continue;
+        }
+        if( c <= 0 && skip_empty ) {
+          fprintf(stderr, "count=%ld typesize=%lld invalid...skipping case\n", count, typesize);
+          continue;
         }
 
-        free(typesize_str);
-        free(extent_str);
-        free(real_size_str);
-
-        free(bcastbuf);
+        measure_pattern_size(conf, rank, run, send_blocks, recv_blocks, nbytes_list->elements[i], c, type);
+    }
 
-        if ((flags & PREDEFINED_DT) == 0) { // free derived datatypes
-            MPI_Type_free(&type);
-        }
+    if ((flags & PREDEFINED_DT) == 0) { // free derived datatypes
+        MPI_Type_free(&type);
     }
 
     for (i=0; i<nbytes_list->n_elems; i++) {
@@ -731,79 +1097,51 @@ int bcastpattern_dynamictype(pattern_config_t conf, dictionary_t *dict)
 }
 
 
+int measure_basic_pattern(pattern_config_t conf, dictionary_t *dict, pattern_run_t run,
+        int send_blocks, int recv_blocks)
+{
+    return measure_basic_pattern_sizes(conf, dict, run, send_blocks, recv_blocks, 1);
+}
+
 
-int allgatherpattern_dynamictype(pattern_config_t conf, dictionary_t *dict)
+int measure_dynamic_pattern(pattern_config_t conf, dictionary_t *dict, pattern_run_t run,
+        int send_blocks, int recv_blocks)
 {
-    int size, rank;
+    int rank;
     int i;
-    size_t nn;
-    void *sendbuf, *recvbuf;
     MPI_Datatype type;
     int c;
     size_t c0;
-    MPI_Aint lb, extent;
     string_array_t* nbytes_list = NULL;
-    int typesize;
     size_t nbytes;
-    char *typesize_str, *real_size_str, *extent_str;
     int flags;
 
-    MPI_Comm_size(conf.comm,&size);
     MPI_Comm_rank(conf.comm,&rank);
 
     //@ global pattern_type=PATTERN_DYNAMIC
 
     nbytes_list = get_string_array_from_dict("nbytes_list", dict);
 
-    // time this
+    // time this (but not with simple INC)
     c0 = -1;
     for (i=0; i<nbytes_list->n_elems; i++) {
         nbytes = atol(nbytes_list->elements[i]);
 
-        // create datatype
-        instantiate_dynamic_datatype(conf, dict, nbytes, &type, &c, &flags);
         if (nbytes==c0) {
             continue;
         }
         c0 = nbytes;
 
-        MPI_Type_get_extent(type,&lb,&extent);
-        MPI_Type_size(type,&typesize);
-
-        nn = c * extent;
-        posix_memalign(&sendbuf, CACHE_LINE_SIZE, nn);
-        assert(sendbuf!=NULL);
-        //recvbuf = malloc(nn * size);
-        posix_memalign(&recvbuf, CACHE_LINE_SIZE, nn * size);
-        assert(recvbuf!=NULL);
-
-        /* this is needed to avoid mem leaks */
-        typesize_str  = my_int_to_string(typesize);
-        extent_str  = my_int_to_string(extent);
-        real_size_str = my_int_to_string(c*typesize);
-
-        //@ set nbytes_str=nbytes_list->elements[i]
-        //@ set derivedtype_size=typesize_str
-        //@ set real_size=real_size_str
-        //@ set derivedtype_extent=extent_str
-
-        if (conf.use_datatype) {
-            allgather_datatype(rank, sendbuf, recvbuf, c, type, conf.root_proc, conf.comm);
-        }
-        else {
-            allgather_pack(rank, sendbuf, recvbuf, c, type, conf.root_proc, conf.comm);
-        }
-
-        if ((flags & PREDEFINED_DT) == 0) { // free derived datatypes
-            MPI_Type_free(&type);
+        // create datatype (or take it from the cache)
+        get_dynamic_datatype(conf, dict, nbytes, &type, &c, &flags);
+        if (skip_measured_type(conf, type, c)) {
+            release_dynamic_datatype(conf, &type, flags);
+            continue;
         }
 
-        free(typesize_str);
-        free(extent_str);
-        free(real_size_str);
+        measure_pattern_size(conf, rank, run, send_blocks, recv_blocks, nbytes_list->elements[i], c, type);
 
-        free(sendbuf);
-        free(recvbuf);
+        release_dynamic_datatype(conf, &type, flags);
     }
 
     for (i=0; i<nbytes_list->n_elems; i++) {
@@ -815,3 +1153,93 @@ int allgatherpattern_dynamictype(pattern_config_t conf, dictionary_t *dict)
     return MPI_SUCCESS; // no...
 }
 
+
+// between rank 0 and 1 (try even-odd?)
+int pingpongpattern(pattern_config_t conf, dictionary_t *dict)
+{
+    return measure_basic_pattern_sizes(conf, dict, run_pingpong, 1, 1, 0);
+}
+
+int bcastpattern(pattern_config_t conf, dictionary_t *dict)
+{
+    return measure_basic_pattern(conf, dict, run_bcast, 1, 0);
+}
+
+// n: max block size in bytes
+int allgatherpattern(pattern_config_t conf, dictionary_t *dict)
+{
+    int size;
+
+    MPI_Comm_size(conf.comm,&size);
+    return measure_basic_pattern(conf, dict, run_allgather, 1, size);
+}
+
+
+/* Dynamic patterns: all data are represented by the datatype, counts are 1 */
+
+int pingpongpattern_dynamictype(pattern_config_t conf, dictionary_t *dict)
+{
+    return measure_dynamic_pattern(conf, dict, run_pingpong, 1, 1);
+}
+
+int bcastpattern_dynamictype(pattern_config_t conf, dictionary_t *dict)
+{
+    return measure_dynamic_pattern(conf, dict, run_bcast, 1, 0);
+}
+
+int allgatherpattern_dynamictype(pattern_config_t conf, dictionary_t *dict)
+{
+    int size;
+
+    MPI_Comm_size(conf.comm,&size);
+    return measure_dynamic_pattern(conf, dict, run_allgather, 1, size);
+}
+
+
+int gatherpattern(pattern_config_t conf, dictionary_t *dict)
+{
+    int size;
+
+    MPI_Comm_size(conf.comm,&size);
+    return measure_basic_pattern(conf, dict, run_gather, 1, size);
+}
+
+int scatterpattern(pattern_config_t conf, dictionary_t *dict)
+{
+    int size;
+
+    MPI_Comm_size(conf.comm,&size);
+    return measure_basic_pattern(conf, dict, run_scatter, size, 1);
+}
+
+int alltoallpattern(pattern_config_t conf, dictionary_t *dict)
+{
+    int size;
+
+    MPI_Comm_size(conf.comm,&size);
+    return measure_basic_pattern(conf, dict, run_alltoall, size, size);
+}
+
+int gatherpattern_dynamictype(pattern_config_t conf, dictionary_t *dict)
+{
+    int size;
+
+    MPI_Comm_size(conf.comm,&size);
+    return measure_dynamic_pattern(conf, dict, run_gather, 1, size);
+}
+
+int scatterpattern_dynamictype(pattern_config_t conf, dictionary_t *dict)
+{
+    int size;
+
+    MPI_Comm_size(conf.comm,&size);
+    return measure_dynamic_pattern(conf, dict, run_scatter, size, 1);
+}
+
+int alltoallpattern_dynamictype(pattern_config_t conf, dictionary_t *dict)
+{
+    int size;
+
+    MPI_Comm_size(conf.comm,&size);
+    return measure_dynamic_pattern(conf, dict, run_alltoall, size, size);
+}
@@ -28,6 +28,25 @@
 #include "datatypes_bench.h"
 #include "dictionary/keyvalue_store.h"
 
+/* measurement of one size: the pattern with c instances of type (buffers allocated by the drivers) */
+typedef void (*pattern_run_t)(pattern_config_t conf, int rank, void* sendbuf, void* recvbuf, int c,
+        MPI_Datatype type);
+
+/* drivers of the patterns: run is measured for each size of nbytes_list (skipping sizes as the
+ * basic and dynamic patterns below); the send and receive buffers hold send_blocks and recv_blocks
+ * times the c instances of the datatype (no receive buffer if recv_blocks is 0) */
+int measure_basic_pattern(pattern_config_t conf, dictionary_t *dict, pattern_run_t run,
+        int send_blocks, int recv_blocks);
+int measure_dynamic_pattern(pattern_config_t conf, dictionary_t *dict, pattern_run_t run,
+        int send_blocks, int recv_blocks);
+
+/* ping-pong of c instances between process1 and process2 (other processes are idle), measured
+ * with the datatype and with MPI_Pack/MPI_Unpack */
+void send_receive_datatype(int rank, void* sendbuf, void* recvbuf, int c,
+        int process1, int process2, MPI_Datatype type, MPI_Comm comm);
+void send_receive_pack(int rank, void* sendbuf, void* recvbuf, int c,
+        int process1, int process2, MPI_Datatype type, MPI_Comm comm);
+
 // between rank 0 and 1 (try even-odd?)
 int pingpongpattern(pattern_config_t conf, dictionary_t *dict);
 
@@ -36,10 +55,18 @@ int bcastpattern(pattern_config_t conf, dictionary_t *dict);
 // n: max block size in bytes
 int allgatherpattern(pattern_config_t conf, dictionary_t *dict);
 
+// c instances of the layout per process (test types datatype and pack)
+int gatherpattern(pattern_config_t conf, dictionary_t *dict);
+int scatterpattern(pattern_config_t conf, dictionary_t *dict);
+int alltoallpattern(pattern_config_t conf, dictionary_t *dict);
+
 /* Dynamic patterns: all data are represented by the datatype, counts are 1 */
 int pingpongpattern_dynamictype(pattern_config_t conf, dictionary_t *dict);
 int bcastpattern_dynamictype(pattern_config_t conf, dictionary_t *dict);
 int allgatherpattern_dynamictype(pattern_config_t conf, dictionary_t *dict);
+int gatherpattern_dynamictype(pattern_config_t conf, dictionary_t *dict);
+int scatterpattern_dynamictype(pattern_config_t conf, dictionary_t *dict);
+int alltoallpattern_dynamictype(pattern_config_t conf, dictionary_t *dict);
 
 #endif /* COMM_PATTERNS_H_ */
 
@@ -0,0 +1,231 @@
+/*  MPI-Datatybe - MPI Datatype Benchmark
+ *  
+ *  Copyright 2017 Alexandra Carpen-Amarie, Sascha Hunold, Jesper Larsson Träff
+ *      Research Group for Parallel Computing
+ *      Faculty of Informatics
+ *      Vienna University of Technology, Austria
+ *  
+ *  <license>
+ *      This program is free software: you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation, either version 2 of the License, or
+ *      (at your option) any later version.
+ *  
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *  
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *  </license>
+ */
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <mpi.h>
+
+#include "construct_pattern.h"
+#include "perftypes.h"
+#include "util.h"
+#include "large_count.h"
+#include "typemap/typemap.h"
+//@ add_includes
+
+//@ declare_variables
+
+
+static const char* PATTERN_CONSTRUCT = "construct";
+
+
+// the layout parameters (or the subtype and its parameters for contig_type) have to be specified
+static int layout_params_available(const layout_functions_t *layout, const dictionary_t *dict) {
+    int i, j, ret;
+    char *value;
+
+    if (layout->dt_params == NULL) {
+        if (layout->function == bl_basetype) {
+            return 1;
+        }
+        ret = get_value_from_dict(dict, "subtype", &value);
+        if (ret != 0 || value == NULL) {
+            return 0;
+        }
+        for (i = 0; i < N_LAYOUTS; i++) {
+            if (strcmp(layout_list[i].name, value) == 0) {
+                break;
+            }
+        }
+        free(value);
+        return (i < N_LAYOUTS) ? layout_params_available(&layout_list[i], dict) : 0;
+    }
+
+    for (j = 0; j < layout->nb_params; j++) {
+        ret = get_value_from_dict(dict, layout->dt_params[j], &value);
+        if (ret != 0 || value == NULL) {
+            return 0;
+        }
+        free(value);
+    }
+    return 1;
+}
+
+
+// resident memory growth caused by one commit of the type (not measured)
+static long measure_commit_rss(pattern_config_t conf, dictionary_t *typedict) {
+    MPI_Datatype type;
+    int flags;
+    long rss_before, rss_after;
+
+    conf.create_datatype(typedict, &type, &flags);
+    if (flags & PREDEFINED_DT) {
+        return 0;
+    }
+    rss_before = get_resident_set_size();
+    MPI_Type_commit(&type);
+    rss_after = get_resident_set_size();
+    MPI_Type_free(&type);
+
+    return rss_after - rss_before;
+}
+
+
+static void construct_datatype(pattern_config_t conf, dictionary_t *typedict, const char* layout_name) {
+    MPI_Datatype type;
+    int flags;
+    int c = 1;
+
+    //@ set test_type="construct"
+    //@ set layout_name=layout_name
+
+    //@ initialize_timestamps t1
+    //@ initialize_timestamps t2
+    //@ initialize_timestamps t3
+    //@ initialize_timestamps t4
+
+    //@ start_measurement_loop
+
+    //@ start_sync
+    //@ measure_timestamp t1
+    conf.create_datatype(typedict, &type, &flags);
+    //@ measure_timestamp t2
+    if ((flags & PREDEFINED_DT) == 0) {
+        MPI_Type_commit(&type);
+    }
+    //@ measure_timestamp t3
+    if ((flags & PREDEFINED_DT) == 0) {
+        MPI_Type_free(&type);
+    }
+    //@ measure_timestamp t4
+    //@ stop_sync
+    //@stop_measurement_loop
+
+    //@ print_runtime_array name=runtime end_time=t4 start_time=t1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+    //@ print_runtime_array name=create_time end_time=t2 start_time=t1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+    //@ print_runtime_array name=commit_time end_time=t3 start_time=t2 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+    //@ print_runtime_array name=free_time end_time=t4 start_time=t3 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+
+    //@cleanup_variables
+}
+
+
+static void construct_layout(pattern_config_t conf, dictionary_t *dict, const layout_functions_t *layout,
+        string_array_t* nbytes_list) {
+    int i;
+    size_t nbytes;
+    dictionary_t typedict;
+    MPI_Datatype type;
+    MPI_Aint lb, extent;
+    MPI_Count typesize;
+    int flags;
+    char *typesize_str, *real_size_str, *extent_str, *rss_str, *nblocks_str, *mean_block_str;
+    MPI_Count nblocks;
+
+    conf.create_datatype = layout->function;
+    conf.dt_parameters = layout->dt_params;
+    conf.nb_params = layout->nb_params;
+    conf.type_info = layout->type_info;
+
+    for (i=0; i<nbytes_list->n_elems; i++) {
+        nbytes = atol(nbytes_list->elements[i]);
+
+        // basic layouts do not depend on nbytes
+        if (layout->type_info == basic && i > 0) {
+            break;
+        }
+
+        // not to measure
+        if (layout->type_info == dynamic) {
+            init_dynamic_type_dict(conf, dict, nbytes, &typedict);
+        } else {
+            typedict = *dict;
+        }
+
+        conf.create_datatype(&typedict, &type, &flags);
+        MPI_Type_get_extent(type, &lb, &extent);
+        typesize = get_type_size(type);
+        nblocks = get_typemap_nblocks(type, 1);
+        if ((flags & PREDEFINED_DT) == 0) {
+            MPI_Type_free(&type);
+        }
+
+        typesize_str  = my_count_to_string(typesize);
+        extent_str  = my_count_to_string(extent);
+        real_size_str = my_count_to_string(typesize);
+        rss_str = my_int_to_string(measure_commit_rss(conf, &typedict) / 1024);
+        nblocks_str = my_count_to_string(nblocks);
+        mean_block_str = my_count_to_string((nblocks > 0) ? typesize/nblocks : 0);
+
+        //@ set nbytes_str=nbytes_list->elements[i]
+        //@ set derivedtype_size=typesize_str
+        //@ set real_size=real_size_str
+        //@ set derivedtype_extent=extent_str
+        //@ set commit_rss_kb=rss_str
+        //@ set nblocks=nblocks_str
+        //@ set mean_block=mean_block_str
+
+        construct_datatype(conf, &typedict, layout->name);
+
+        free(typesize_str);
+        free(extent_str);
+        free(real_size_str);
+        free(rss_str);
+        free(nblocks_str);
+        free(mean_block_str);
+        if (layout->type_info == dynamic) {
+            cleanup_dictionary(&typedict);
+        }
+    }
+}
+
+
+int constructpattern(pattern_config_t conf, dictionary_t *dict)
+{
+    int i;
+    string_array_t* nbytes_list = NULL;
+
+    //@ global pattern_type=PATTERN_CONSTRUCT
+
+    nbytes_list = get_string_array_from_dict("nbytes_list", dict);
+
+    for (i = 0; i < N_LAYOUTS; i++) {
+        if (conf.create_datatype != NULL) {
+            if (conf.create_datatype == layout_list[i].function) {
+                construct_layout(conf, dict, &layout_list[i], nbytes_list);
+                break;
+            }
+        } else if (layout_params_available(&layout_list[i], dict)) {
+            construct_layout(conf, dict, &layout_list[i], nbytes_list);
+        }
+    }
+
+    for (i=0; i<nbytes_list->n_elems; i++) {
+        free(nbytes_list->elements[i]);
+    }
+    free(nbytes_list->elements);
+    free(nbytes_list);
+
+    return MPI_SUCCESS;
+}
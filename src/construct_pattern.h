@@ -0,0 +1,35 @@
+/*  MPI-Datatybe - MPI Datatype Benchmark
+ *  
+ *  Copyright 2017 Alexandra Carpen-Amarie, Sascha Hunold, Jesper Larsson Träff
+ *      Research Group for Parallel Computing
+ *      Faculty of Informatics
+ *      Vienna University of Technology, Austria
+ *  
+ *  <license>
+ *      This program is free software: you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation, either version 2 of the License, or
+ *      (at your option) any later version.
+ *  
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *  
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *  </license>
+ */
+
+
+#ifndef CONSTRUCT_PATTERN_H_
+#define CONSTRUCT_PATTERN_H_
+
+#include "datatypes_bench.h"
+#include "dictionary/keyvalue_store.h"
+
+/* measures the construction (create_datatype), MPI_Type_commit and MPI_Type_free
+ * of the selected layout, or of all layouts whose parameters are given if no layout is selected */
+int constructpattern(pattern_config_t conf, dictionary_t *dict);
+
+#endif /* CONSTRUCT_PATTERN_H_ */
@@ -0,0 +1,175 @@
+/*  MPI-Datatybe - MPI Datatype Benchmark
+ *  
+ *  Copyright 2017 Alexandra Carpen-Amarie, Sascha Hunold, Jesper Larsson Träff
+ *      Research Group for Parallel Computing
+ *      Faculty of Informatics
+ *      Vienna University of Technology, Austria
+ *  
+ *  <license>
+ *      This program is free software: you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation, either version 2 of the License, or
+ *      (at your option) any later version.
+ *  
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *  
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *  </license>
+ */
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <mpi.h>
+
+#include "datatype_cache.h"
+#include "perftypes.h"
+
+typedef struct cache_entry {
+    char* key;
+    MPI_Datatype type;
+    int needed_count;
+    int flags;
+} cache_entry_t;
+
+typedef struct datatype_cache {
+    cache_entry_t* entries;
+    int n_entries;
+    int max_entries;
+} datatype_cache_t;
+
+static datatype_cache_t cache = { NULL, 0, 0 };
+
+
+static const char* get_layout_name(type_generator_t create_datatype) {
+    int i;
+
+    for (i = 0; i < N_LAYOUTS; i++) {
+        if (layout_list[i].function == create_datatype) {
+            return layout_list[i].name;
+        }
+    }
+    return "unknown";
+}
+
+
+// "layout;key=value;..." in the (deterministic) order of the dictionary
+static char* build_cache_key(const pattern_config_t conf, const dictionary_t *typedict) {
+    const char* layout = get_layout_name(conf.create_datatype);
+    size_t len, pos;
+    entry_t *pair;
+    char *key;
+    int i;
+
+    len = strlen(layout) + 1;
+    for (i = 0; i < typedict->size; i++) {
+        for (pair = typedict->table[i]; pair != NULL; pair = pair->next) {
+            len += strlen(pair->key) + strlen(pair->value) + 2;
+        }
+    }
+
+    key = (char*)malloc(len);
+    assert(key != NULL);
+    pos = sprintf(key, "%s", layout);
+    for (i = 0; i < typedict->size; i++) {
+        for (pair = typedict->table[i]; pair != NULL; pair = pair->next) {
+            pos += sprintf(key + pos, ";%s=%s", pair->key, pair->value);
+        }
+    }
+    return key;
+}
+
+
+static cache_entry_t* lookup_or_create(const pattern_config_t conf, const dictionary_t *dict,
+        const size_t nbytes) {
+    dictionary_t typedict;
+    cache_entry_t *entry;
+    char *key;
+    int i;
+
+    init_dynamic_type_dict(conf, dict, nbytes, &typedict);
+    key = build_cache_key(conf, &typedict);
+    cleanup_dictionary(&typedict);
+
+    for (i = 0; i < cache.n_entries; i++) {
+        if (strcmp(cache.entries[i].key, key) == 0) {
+            free(key);
+            return &cache.entries[i];
+        }
+    }
+
+    if (cache.n_entries == cache.max_entries) {
+        cache.max_entries = (cache.max_entries > 0) ? 2 * cache.max_entries : 16;
+        cache.entries = (cache_entry_t*)realloc(cache.entries, cache.max_entries * sizeof(cache_entry_t));
+        assert(cache.entries != NULL);
+    }
+    entry = &cache.entries[cache.n_entries++];
+    entry->key = key;
+    instantiate_dynamic_datatype(conf, dict, nbytes, &entry->type, &entry->needed_count, &entry->flags);
+
+    return entry;
+}
+
+
+void get_dynamic_datatype(const pattern_config_t conf,
+    const dictionary_t *dict, const size_t nbytes, MPI_Datatype* t,
+    int* needed_count, int* flags) {
+    cache_entry_t *entry;
+
+    if (!conf.type_cache) {
+        instantiate_dynamic_datatype(conf, dict, nbytes, t, needed_count, flags);
+        return;
+    }
+
+    entry = lookup_or_create(conf, dict, nbytes);
+    *t = entry->type;
+    *needed_count = entry->needed_count;
+    *flags = entry->flags;
+}
+
+
+void release_dynamic_datatype(const pattern_config_t conf, MPI_Datatype* t, int flags) {
+    if (!conf.type_cache && (flags & PREDEFINED_DT) == 0) {
+        MPI_Type_free(t);
+    }
+}
+
+
+void prebuild_datatype_cache(const pattern_config_t conf, const dictionary_t *dict) {
+    string_array_t* nbytes_list;
+    int i;
+
+    if (!conf.type_cache || conf.type_info != dynamic) {
+        return;
+    }
+
+    nbytes_list = get_string_array_from_dict("nbytes_list", dict);
+    for (i = 0; i < nbytes_list->n_elems; i++) {
+        lookup_or_create(conf, dict, atol(nbytes_list->elements[i]));
+        free(nbytes_list->elements[i]);
+    }
+    free(nbytes_list->elements);
+    free(nbytes_list);
+}
+
+
+void free_datatype_cache(void) {
+    int i;
+
+    for (i = 0; i < cache.n_entries; i++) {
+        if ((cache.entries[i].flags & PREDEFINED_DT) == 0) {
+            MPI_Type_free(&cache.entries[i].type);
+        }
+        free(cache.entries[i].key);
+    }
+    free(cache.entries);
+    cache.entries = NULL;
+    cache.n_entries = 0;
+    cache.max_entries = 0;
+}
@@ -0,0 +1,49 @@
+/*  MPI-Datatybe - MPI Datatype Benchmark
+ *  
+ *  Copyright 2017 Alexandra Carpen-Amarie, Sascha Hunold, Jesper Larsson Träff
+ *      Research Group for Parallel Computing
+ *      Faculty of Informatics
+ *      Vienna University of Technology, Austria
+ *  
+ *  <license>
+ *      This program is free software: you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation, either version 2 of the License, or
+ *      (at your option) any later version.
+ *  
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *  
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *  </license>
+ */
+
+
+#ifndef DATATYPE_CACHE_H_
+#define DATATYPE_CACHE_H_
+
+#include <mpi.h>
+#include "datatypes_bench.h"
+#include "dictionary/keyvalue_store.h"
+
+/* cache of committed dl_* datatypes, keyed by the layout, its parameters,
+ * the basetype and the number of elements n (i.e., by the parameter dictionary of the type);
+ * cached types stay committed until free_datatype_cache is called */
+
+// like instantiate_dynamic_datatype, but returns the cached type if conf.type_cache is set
+void get_dynamic_datatype(const pattern_config_t conf,
+    const dictionary_t *dict, const size_t nbytes, MPI_Datatype* t,
+    int* needed_count, int* flags);
+
+// frees the datatype unless it is predefined or owned by the cache
+void release_dynamic_datatype(const pattern_config_t conf, MPI_Datatype* t, int flags);
+
+// creates the types for all sizes of nbytes_list in advance (not measured)
+void prebuild_datatype_cache(const pattern_config_t conf, const dictionary_t *dict);
+
+void free_datatype_cache(void);
+
+#endif /* DATATYPE_CACHE_H_ */
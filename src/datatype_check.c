@@ -0,0 +1,160 @@
+/*  MPI-Datatybe - MPI Datatype Benchmark
+ *
+ *  Copyright 2017 Alexandra Carpen-Amarie, Sascha Hunold, Jesper Larsson Träff
+ *      Research Group for Parallel Computing
+ *      Faculty of Informatics
+ *      Vienna University of Technology, Austria
+ *
+ *  <license>
+ *      This program is free software: you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation, either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *  </license>
+ */
+
+/* datatype_check: compares the flattened typemaps of two layouts for each size
+ * of nbytes_list and prints their fingerprints (not instrumented by ReproMPI) */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <mpi.h>
+
+#include "datatypes_bench.h"
+#include "perftypes.h"
+#include "option_parser/parse_perftypes_options.h"
+#include "dictionary/keyvalue_store.h"
+#include "typemap/typemap.h"
+
+static char* layout1_key = "layout1";
+static char* layout2_key = "layout2";
+
+
+static void get_layout_config(const dictionary_t *dict, const char* key, pattern_config_t *conf, char** name) {
+  int ret;
+
+  ret = get_value_from_dict(dict, key, name);
+  if (ret != 0 || *name == NULL) {
+    printf("\nError: required parameter \"%s\" is not specified. \n", key);
+    exit(1);
+  }
+  get_create_function(*name, &conf->create_datatype, &conf->dt_parameters, &conf->nb_params, &conf->type_info);
+  conf->comm = MPI_COMM_WORLD;
+  conf->root_proc = 0;
+}
+
+
+// datatype of the layout and number of instances used for a message of nbytes bytes (as in the benchmark)
+static void create_layout_type(const pattern_config_t conf, dictionary_t *dict, const size_t nbytes,
+    MPI_Datatype *type, int *count, int *flags) {
+  MPI_Count typesize;
+
+  if (conf.type_info == dynamic) {
+    instantiate_dynamic_datatype(conf, dict, nbytes, type, count, flags);
+  } else {
+    conf.create_datatype(dict, type, flags);
+    if ((*flags & PREDEFINED_DT) == 0) {
+      MPI_Type_commit(type);
+    }
+    MPI_Type_size_x(*type, &typesize);
+    *count = (typesize > 0) ? nbytes / typesize : 0;
+  }
+}
+
+
+// index of the first differing block, -1 if the typemaps are identical
+static long long compare_typemaps(const typemap_t *map1, const typemap_t *map2) {
+  size_t i, n;
+
+  n = (map1->nblocks < map2->nblocks) ? map1->nblocks : map2->nblocks;
+  for (i = 0; i < n; i++) {
+    if (map1->offsets[i] != map2->offsets[i] || map1->lengths[i] != map2->lengths[i]) {
+      return i;
+    }
+  }
+  return (map1->nblocks == map2->nblocks) ? -1 : (long long)n;
+}
+
+
+int main(int argc, char *argv[]) {
+  pattern_config_t conf1, conf2;
+  dictionary_t dict;
+  string_array_t* nbytes_list;
+  char *name1, *name2;
+  MPI_Datatype type1, type2;
+  int count1, count2, flags1, flags2;
+  typemap_t map1, map2;
+  long long diff;
+  int rank, ndiffs, i;
+
+  MPI_Init(&argc, &argv);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+  init_dictionary(&dict);
+  parse_perftypes_options(&dict, argc, argv);
+
+  get_layout_config(&dict, layout1_key, &conf1, &name1);
+  get_layout_config(&dict, layout2_key, &conf2, &name2);
+  nbytes_list = get_string_array_from_dict("nbytes_list", &dict);
+
+  if (rank == 0) {
+    printf("%30s %30s %12s %8s %8s %12s %12s %16s %16s %s\n", "layout1", "layout2", "nbytes",
+        "count1", "count2", "nblocks1", "nblocks2", "fingerprint1", "fingerprint2", "typemaps");
+  }
+
+  ndiffs = 0;
+  for (i = 0; i < nbytes_list->n_elems; i++) {
+    size_t nbytes = atol(nbytes_list->elements[i]);
+
+    create_layout_type(conf1, &dict, nbytes, &type1, &count1, &flags1);
+    create_layout_type(conf2, &dict, nbytes, &type2, &count2, &flags2);
+
+    flatten_datatype(type1, count1, &map1);
+    flatten_datatype(type2, count2, &map2);
+    diff = compare_typemaps(&map1, &map2);
+    if (diff >= 0) {
+      ndiffs++;
+    }
+
+    if (rank == 0) {
+      printf("%30s %30s %12zu %8d %8d %12zu %12zu %016" PRIx64 " %016" PRIx64 " ", name1, name2, nbytes,
+          count1, count2, map1.nblocks, map2.nblocks,
+          get_typemap_fingerprint(type1, count1), get_typemap_fingerprint(type2, count2));
+      if (diff < 0) {
+        printf("identical\n");
+      } else {
+        printf("different(block %lld)\n", diff);
+      }
+    }
+
+    cleanup_typemap(&map1);
+    cleanup_typemap(&map2);
+    if ((flags1 & PREDEFINED_DT) == 0) {
+      MPI_Type_free(&type1);
+    }
+    if ((flags2 & PREDEFINED_DT) == 0) {
+      MPI_Type_free(&type2);
+    }
+    free(nbytes_list->elements[i]);
+  }
+
+  free(nbytes_list->elements);
+  free(nbytes_list);
+  free(name1);
+  free(name2);
+  cleanup_dictionary(&dict);
+  MPI_Finalize();
+
+  // like cmp/diff: 1 if any of the typemaps differ
+  return (ndiffs > 0) ? 1 : 0;
+}
@@ -29,8 +29,18 @@
 #include "datatypes_bench.h"
 #include "perftypes.h"
 #include "comm_patterns.h"
+#include "nonblocking_patterns.h"
+#include "construct_pattern.h"
+#include "alltoallw_pattern.h"
+#include "halo_pattern.h"
+#include "rma_patterns.h"
+#include "multi_pair_patterns.h"
+#include "datatype_cache.h"
+#include "measured_types.h"
 #include "option_parser/parse_perftypes_options.h"
 #include "dictionary/keyvalue_store.h"
+#include "pack_engines/threaded_pack.h"
+#include "typemap/typemap.h"
 
 //@ add_includes
 //@ declare_variables
@@ -39,6 +49,20 @@ static char* pattern_key = "pattern";
 static char* datatype_create_key = "layout";
 static char* root_key = "root";
 static char* test_type_key = "test_type";
+static char* normalize_key = "normalize";
+static char* simd_isa_key = "simd_isa";
+static char* pack_threads_key = "pack_threads";
+static char* segment_size_key = "segment_size";
+static char* construct_pattern_name = "construct";
+static char* halo_pattern_name = "halo";
+static char* type_cache_key = "type_cache";
+static char* typemap_export_key = "typemap_export";
+static char* skip_measured_key = "skip_measured";
+static char* overlap_key = "overlap";
+static char* compute_factor_key = "compute_factor";
+static char* rma_sync_key = "rma_sync";
+
+static const int DEFAULT_SEGMENT_SIZE = 65536;
 
 static pattern_functions_t pattern_list[] = {
     { "pingpong",
@@ -52,49 +76,83 @@ static pattern_functions_t pattern_list[] = {
     { "allgather",
         {   [basic] = allgatherpattern,
             [dynamic] = allgatherpattern_dynamictype}
+    },
+    { "gather",
+        {   [basic] = gatherpattern,
+            [dynamic] = gatherpattern_dynamictype}
+    },
+    { "scatter",
+        {   [basic] = scatterpattern,
+            [dynamic] = scatterpattern_dynamictype}
+    },
+    { "alltoall",
+        {   [basic] = alltoallpattern,
+            [dynamic] = alltoallpattern_dynamictype}
+    },
+    { "alltoallw",
+        {   [basic] = alltoallwpattern,
+            [dynamic] = alltoallwpattern}
+    },
+    { "halo",
+        {   [basic] = halopattern,
+            [dynamic] = halopattern}
+    },
+    { "stream",
+        {   [basic] = streampattern,
+            [dynamic] = streampattern_dynamictype}
+    },
+    { "multi_pingpong",
+        {   [basic] = multi_pingpongpattern,
+            [dynamic] = multi_pingpongpattern_dynamictype}
+    },
+    { "ring",
+        {   [basic] = ringpattern,
+            [dynamic] = ringpattern_dynamictype}
+    },
+    { "put",
+        {   [basic] = putpattern,
+            [dynamic] = putpattern_dynamictype}
+    },
+    { "get",
+        {   [basic] = getpattern,
+            [dynamic] = getpattern_dynamictype}
+    },
+    { "accumulate",
+        {   [basic] = accumulatepattern,
+            [dynamic] = accumulatepattern_dynamictype}
+    },
+    { "ipingpong",
+        {   [basic] = ipingpongpattern,
+            [dynamic] = ipingpongpattern_dynamictype}
+    },
+    { "ibcast",
+        {   [basic] = ibcastpattern,
+            [dynamic] = ibcastpattern_dynamictype}
+    },
+    { "iallgather",
+        {   [basic] = iallgatherpattern,
+            [dynamic] = iallgatherpattern_dynamictype}
+    },
+    { "pingpong_init",
+        {   [basic] = pingpong_initpattern,
+            [dynamic] = pingpong_initpattern_dynamictype}
+    },
+    { "bcast_init",
+        {   [basic] = bcast_initpattern,
+            [dynamic] = bcast_initpattern_dynamictype}
+    },
+    { "allgather_init",
+        {   [basic] = allgather_initpattern,
+            [dynamic] = allgather_initpattern_dynamictype}
+    },
+    { "construct",
+        {   [basic] = constructpattern,
+            [dynamic] = constructpattern}
     }
 };
 
 static const int N_PATTERNS = sizeof(pattern_list) / sizeof(pattern_list[0]);
 
-char *params1[] = { "A", "B" };
-char *params2[] = { "A1", "A2", "B" };
-char *params3[] = { "A", "B1", "B2" };
-char *params4[] = { "A1", "A2", "B1", "B2" };
-char *params5[] = { "A", "B", "c", "blist" };
-char *params6[] = { "A", "B", "S1", "S2" };
-char *params7[] = { "A", "B", "S" };
-char *params8[] = { "A" };
-char *params9[] = { "A", "B", "l" };
-char *params10[] = { "A1", "A2", "B", "S" };
-
-layout_functions_t layout_list[] = {
-    { "tiled", bl_tiled, basic, params1, sizeof(params1) / sizeof(params1[0]) },
-    { "bucket", bl_bucket, basic, params2, sizeof(params2) / sizeof(params2[0]) },
-    { "block", bl_block, basic, params3, sizeof(params3) / sizeof(params3[0]) },
-    { "alternating", bl_alternating, basic, params4, sizeof(params4) / sizeof(params4[0]) },
-    { "tiled_heterogeneous", bl_tiled_heterogeneous, basic, params5, sizeof(params5) / sizeof(params5[0]) },
-    { "tiled_struct", bl_tiled_struct, basic, params6, sizeof(params6) / sizeof(params6[0]) },
-    { "contig_type", dl_contig_type, dynamic, NULL, -1 }, // here we need to be careful, give some "useful" defaults
-    { "alternating_repeated", dl_alternating_repeated, dynamic, params2, sizeof(params2) / sizeof(params2[0]) },
-    { "alternating_struct", dl_alternating_struct, dynamic, params2, sizeof(params2) / sizeof(params2[0]) },
-    { "tiled_vector", dl_tiled_vector, dynamic, params1, sizeof(params1) / sizeof(params1[0]) },
-    { "vector_tiled", dl_vector_tiled, dynamic, params7, sizeof(params7) / sizeof(params7[0]) },
-    { "block_indexed", dl_block_indexed, dynamic, params3, sizeof(params3) / sizeof(params3[0]) },
-    { "alternating_indexed", dl_alternating_indexed, dynamic, params4, sizeof(params4) / sizeof(params4[0]) },
-    { "rowcol_full_indexed", dl_rowcol_full_indexed, dynamic, params8, sizeof(params8) / sizeof(params8[0]) },
-    { "rowcol_contiguous_and_indexed", dl_rowcol_contiguous_and_indexed, dynamic, params8, sizeof(params8) / sizeof(params8[0]) },
-    { "rowcol_struct", dl_rowcol_struct, dynamic, params8, sizeof(params8) / sizeof(params8[0]) },
-    { "blocks", dl_blocks, dynamic, params9, sizeof(params9) / sizeof(params9[0]) },
-    { "tiled_struct_indexed_all", dl_tiled_struct_indexed_all, dynamic, params1, sizeof(params1) / sizeof(params1[0]) },
-    { "alternating_indexed_fixed", bl_alternating_indexed_fixed, basic, params10, sizeof(params10) / sizeof(params10[0]) },
-    { "contig_alternating_indexed_fixed", dl_contig_alternating_indexed_fixed, dynamic, params10, sizeof(params10) / sizeof(params10[0]) },
-    { "alternating_aligned", bl_alternating_aligned, basic, params4, sizeof(params4) / sizeof(params4[0]) },
-    { "tiled_struct_indexed_Sblocks", dl_tiled_struct_indexed_Sblocks, dynamic, params7, sizeof(params7) / sizeof(params7[0]) },
-    { "basetype", bl_basetype, basic, NULL, -1 }
-};
-
-const int N_LAYOUTS = sizeof(layout_list) / sizeof(layout_list[0]);
 
 void execute_pattern(char* pattern, pattern_config_t config, dictionary_t *dict) {
   int i;
@@ -120,31 +178,37 @@ void execute_pattern(char* pattern, pattern_config_t config, dictionary_t *dict)
 
 }
 
-void get_create_function(const char* name, type_generator_t *out_generator, char ***out_dt_params, int *nb_params,
-    dt_type_t *type_info) {
+// writes the flattened datatype for each size of nbytes_list to <prefix>.<nbytes>
+// (basic layouts do not depend on the size and are written once to <prefix>)
+static void export_typemap_files(const pattern_config_t conf, dictionary_t *dict, const char *prefix) {
+  string_array_t* nbytes_list;
+  MPI_Datatype type;
+  char *path;
+  int needed_count;
+  int flags;
   int i;
-  int found = 0;
 
-  if (name == NULL) {
-    printf("Error: unknown datatype creation function: %s\n", name);
-    exit(1);
-  }
-
-  for (i = 0; i < N_LAYOUTS; i++) {
-    if (strcmp(name, layout_list[i].name) == 0) {
-      *out_generator = layout_list[i].function;
-      *out_dt_params = layout_list[i].dt_params;
-      *nb_params = layout_list[i].nb_params;
-      *type_info = layout_list[i].type_info;
-      found = 1;
-      break;
+  if (conf.type_info == basic) {
+    conf.create_datatype(dict, &type, &flags);
+    write_typemap_file(type, prefix);
+    if ((flags & PREDEFINED_DT) == 0) {
+      MPI_Type_free(&type);
     }
+    return;
   }
 
-  if (0 == found) {
-    printf("Error: unknown datatype creation function: %s\n", name);
-    exit(1);
+  nbytes_list = get_string_array_from_dict("nbytes_list", dict);
+  path = (char*)malloc(strlen(prefix) + 32);
+  for (i = 0; i < nbytes_list->n_elems; i++) {
+    instantiate_dynamic_datatype(conf, dict, atol(nbytes_list->elements[i]), &type, &needed_count, &flags);
+    sprintf(path, "%s.%ld", prefix, atol(nbytes_list->elements[i]));
+    write_typemap_file(type, path);
+    MPI_Type_free(&type);
+    free(nbytes_list->elements[i]);
   }
+  free(path);
+  free(nbytes_list->elements);
+  free(nbytes_list);
 }
 
 int main(int argc, char *argv[]) {
@@ -154,6 +218,17 @@ int main(int argc, char *argv[]) {
   char* selected_pattern;
   char* test_type;
   char* selected_layout;
+  char* normalize;
+  char* simd_isa;
+  char* pack_threads;
+  char* segment_size;
+  char* type_cache;
+  char* typemap_export;
+  char* skip_measured;
+  char* overlap;
+  char* compute_factor;
+  char* rma_sync;
+  int prebuild;
   int ret;
 
   MPI_Init(&argc, &argv);
@@ -166,37 +241,188 @@ int main(int argc, char *argv[]) {
   //@ initialize_bench
   root_proc = get_int_value_from_dict(root_key, &dict);
 
-  ret = get_value_from_dict(&dict, test_type_key, &test_type);
-  if (ret != 0 || test_type == NULL) {
-    printf("\nError: required parameter \"%s\" is not specified. \n", test_type_key);
-    exit(1);
-  }
   ret = get_value_from_dict(&dict, pattern_key, &selected_pattern);
   if (ret != 0 || selected_pattern == NULL) {
     printf("\nError: required parameter \"%s\" is not specified. \n", pattern_key);
     exit(1);
   }
+  // the construct pattern does not communicate
+  ret = get_value_from_dict(&dict, test_type_key, &test_type);
+  if ((ret != 0 || test_type == NULL) && strcmp(selected_pattern, construct_pattern_name) != 0) {
+    printf("\nError: required parameter \"%s\" is not specified. \n", test_type_key);
+    exit(1);
+  }
   ret = get_value_from_dict(&dict, datatype_create_key, &selected_layout);
-  if (ret != 0 || selected_layout == NULL) {
+  if (ret == 0 && selected_layout != NULL) {
+    get_create_function(selected_layout, &config.create_datatype, &config.dt_parameters, &config.nb_params,
+        &config.type_info);
+  } else if (strcmp(selected_pattern, construct_pattern_name) == 0 || strcmp(selected_pattern, halo_pattern_name) == 0) {
+    // without a layout, the construct pattern measures all layouts; the halo pattern builds its own face datatypes
+    config.create_datatype = NULL;
+    config.dt_parameters = NULL;
+    config.nb_params = 0;
+    config.type_info = basic;
+  } else {
     printf("\nError: required parameter \"%s\" is not specified. \n", datatype_create_key);
     exit(1);
   }
-
-  get_create_function(selected_layout, &config.create_datatype, &config.dt_parameters, &config.nb_params,
-      &config.type_info);
   config.comm = MPI_COMM_WORLD;
   config.root_proc = root_proc;
 
-  config.use_datatype = 0;
+  config.test_type = test_pack;
+  config.pack_engine = NULL;
   if (test_type != NULL) {
     if (strcmp(test_type, "datatype") == 0) {
-      config.use_datatype = 1;
+      config.test_type = test_datatype;
     } else if (strcmp(test_type, "pack") == 0) {
-      config.use_datatype = 0;
+      config.test_type = test_pack;
+    } else if (strcmp(test_type, "manual") == 0) {
+      config.test_type = test_manual;
+      config.pack_engine = "memcpy";
+    } else if (strcmp(test_type, "specialized") == 0) {
+      config.test_type = test_manual;
+      config.pack_engine = "specialized";
+    } else if (strcmp(test_type, "simd") == 0) {
+      config.test_type = test_manual;
+      config.pack_engine = "simd";
+    } else if (strcmp(test_type, "threaded") == 0) {
+      config.test_type = test_manual;
+      config.pack_engine = "threaded";
+    } else if (strcmp(test_type, "pipelined") == 0) {
+      config.test_type = test_pipelined;
+    }
+  }
+
+  // segment size of the pipelined test type in bytes
+  config.segment_size = DEFAULT_SEGMENT_SIZE;
+  ret = get_value_from_dict(&dict, segment_size_key, &segment_size);
+  if (ret == 0 && segment_size != NULL) {
+    config.segment_size = atoi(segment_size);
+    if (config.segment_size <= 0) {
+      printf("\nError: \"%s\" has to be a positive integer\n", segment_size_key);
+      exit(1);
+    }
+    free(segment_size);
+  }
+
+  // optionally restrict the instruction set of the simd engine (default: best supported by the CPU)
+  ret = get_value_from_dict(&dict, simd_isa_key, &simd_isa);
+  if (ret == 0 && simd_isa != NULL) {
+    if (config.pack_engine != NULL && strcmp(config.pack_engine, "simd") == 0) {
+      if (strcmp(simd_isa, "avx2") == 0) {
+        config.pack_engine = "simd_avx2";
+      } else if (strcmp(simd_isa, "scalar") == 0) {
+        config.pack_engine = "simd_scalar";
+      } else if (strcmp(simd_isa, "avx512") != 0) {
+        printf("\nError: unknown value for \"%s\": %s\n", simd_isa_key, simd_isa);
+        exit(1);
+      }
+    }
+    free(simd_isa);
+  }
+
+  // number of threads of the threaded pack engine (default: online cores shared by the processes of the node)
+  init_default_pack_threads(MPI_COMM_WORLD);
+  ret = get_value_from_dict(&dict, pack_threads_key, &pack_threads);
+  if (ret == 0 && pack_threads != NULL) {
+    if (atoi(pack_threads) <= 0) {
+      printf("\nError: \"%s\" has to be a positive integer\n", pack_threads_key);
+      exit(1);
+    }
+    set_pack_threads(atoi(pack_threads));
+    free(pack_threads);
+  }
+
+  // optionally measure the normalized form of each type right after the original one
+  config.normalize = 0;
+  ret = get_value_from_dict(&dict, normalize_key, &normalize);
+  if (ret == 0 && normalize != NULL) {
+    if (strcmp(normalize, "on") == 0) {
+      config.normalize = 1;
+    }
+    free(normalize);
+  }
+
+  // overlap mode of the nonblocking patterns: compute for compute_factor (default 1) times the communication time
+  config.compute_factor = 0;
+  ret = get_value_from_dict(&dict, overlap_key, &overlap);
+  if (ret == 0 && overlap != NULL) {
+    if (strcmp(overlap, "on") == 0) {
+      config.compute_factor = 1;
+    } else if (strcmp(overlap, "off") != 0) {
+      printf("\nError: unknown value for \"%s\": %s\n", overlap_key, overlap);
+      exit(1);
+    }
+    free(overlap);
+  }
+  ret = get_value_from_dict(&dict, compute_factor_key, &compute_factor);
+  if (ret == 0 && compute_factor != NULL) {
+    if (config.compute_factor > 0) {
+      config.compute_factor = atof(compute_factor);
+      if (config.compute_factor <= 0) {
+        printf("\nError: \"%s\" has to be positive\n", compute_factor_key);
+        exit(1);
+      }
+    }
+    free(compute_factor);
+  }
+
+  // synchronization of the one-sided patterns (default: fence)
+  config.rma_sync = rma_sync_fence;
+  ret = get_value_from_dict(&dict, rma_sync_key, &rma_sync);
+  if (ret == 0 && rma_sync != NULL) {
+    if (strcmp(rma_sync, "pscw") == 0) {
+      config.rma_sync = rma_sync_pscw;
+    } else if (strcmp(rma_sync, "lock") == 0) {
+      config.rma_sync = rma_sync_lock;
+    } else if (strcmp(rma_sync, "fence") != 0) {
+      printf("\nError: unknown value for \"%s\": %s\n", rma_sync_key, rma_sync);
+      exit(1);
+    }
+    free(rma_sync);
+  }
+
+  // optionally keep the dynamic datatypes committed (on) and create them before any measurement (prebuild)
+  config.type_cache = 0;
+  prebuild = 0;
+  ret = get_value_from_dict(&dict, type_cache_key, &type_cache);
+  if (ret == 0 && type_cache != NULL) {
+    if (strcmp(type_cache, "on") == 0) {
+      config.type_cache = 1;
+    } else if (strcmp(type_cache, "prebuild") == 0) {
+      config.type_cache = 1;
+      prebuild = 1;
+    } else if (strcmp(type_cache, "off") != 0) {
+      printf("\nError: unknown value for \"%s\": %s\n", type_cache_key, type_cache);
+      exit(1);
+    }
+    free(type_cache);
+  }
+  if (prebuild && config.create_datatype != NULL) {
+    prebuild_datatype_cache(config, &dict);
+  }
+
+  // optionally write the flattened datatypes to typemap files (to be replayed with layout from_file)
+  ret = get_value_from_dict(&dict, typemap_export_key, &typemap_export);
+  if (ret == 0 && typemap_export != NULL) {
+    if (rank == root_proc && config.create_datatype != NULL) {
+      export_typemap_files(config, &dict, typemap_export);
+    }
+    free(typemap_export);
+  }
+
+  // optionally skip the sizes whose typemap was already measured with the same parameters (in this or an earlier run)
+  ret = get_value_from_dict(&dict, skip_measured_key, &skip_measured);
+  if (ret == 0 && skip_measured != NULL) {
+    if (config.create_datatype != NULL) {
+      init_measured_types(config, &dict, skip_measured);
     }
+    free(skip_measured);
   }
 
   execute_pattern(selected_pattern, config, &dict);
+  free_datatype_cache();
+  cleanup_measured_types();
 
   //@cleanup_bench
   free(test_type);
@@ -34,10 +34,29 @@ typedef enum DatatypeTypes  {
     dynamic
 } dt_type_t;
 
+typedef enum TestTypes {
+    test_datatype,
+    test_pack,
+    test_manual,
+    test_pipelined
+} test_type_t;
+
+typedef enum RmaSync {
+    rma_sync_fence,
+    rma_sync_pscw,
+    rma_sync_lock
+} rma_sync_t;
+
 typedef struct patterncf {
     int root_proc;
     MPI_Comm comm;
-    int use_datatype;
+    test_type_t test_type;
+    char* pack_engine;
+    int normalize;
+    int segment_size;       // bytes per segment of the pipelined test type
+    int type_cache;         // keep the committed dynamic datatypes in a cache
+    double compute_factor;  // nonblocking patterns: compute time between start and wait relative to the communication time (0: no overlap mode)
+    rma_sync_t rma_sync;    // synchronization of the one-sided patterns
     type_generator_t create_datatype;
     char **dt_parameters;
     int nb_params;
@@ -64,4 +83,8 @@ typedef struct layout_struct {
 extern layout_functions_t layout_list[];
 extern const int N_LAYOUTS;
 
+// looks up the layout with the given name in layout_list (exits if there is none)
+void get_create_function(const char* name, type_generator_t *out_generator, char ***out_dt_params, int *nb_params,
+    dt_type_t *type_info);
+
 #endif /* DATATYPES_BENCH_H_ */
@@ -47,6 +47,44 @@ int to_int(char* string) {
 
 }
 
+long long to_long(char* string) {
+    char* end = NULL;
+    long long result;
+    errno = 0;
+
+    if (string != NULL) {
+        result = strtoll(string, &end, 10);
+    }
+
+    if((string == NULL) || (errno != 0))
+    {
+        printf("\nError: unable to convert %s to long\n", string);
+        exit(1);
+    }
+
+    return result;
+
+}
+
+double to_double(char* string) {
+    char* end = NULL;
+    double result;
+    errno = 0;
+
+    if (string != NULL) {
+        result = strtod(string, &end);
+    }
+
+    if((string == NULL) || (errno != 0) || (end == string))
+    {
+        printf("\nError: unable to convert %s to double\n", string);
+        exit(1);
+    }
+
+    return result;
+
+}
+
 MPI_Datatype to_basetype(char* string) {
     MPI_Datatype d = MPI_CHAR;
     int ok = 0;
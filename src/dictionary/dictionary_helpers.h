@@ -26,6 +26,8 @@
 
 
 int to_int(char* string);
+long long to_long(char* string);
+double to_double(char* string);
 
 MPI_Datatype to_basetype(char* string);
 MPI_Datatype* to_basetype_list(char* string, int n_types);
@@ -203,6 +203,24 @@ int get_int_value_from_dict(const char* key, const dictionary_t *hashtable) {
     return result;
 }
 
+long long get_long_value_from_dict(const char* key, const dictionary_t *hashtable) {
+    char* val = NULL;
+    long long result = 0;
+    int ret;
+
+    ret = get_value_from_dict(hashtable, key, &val);
+    if (ret == 0 && val != NULL) {
+        result = to_long(val);
+    }
+    else {
+        printf("\nError: required parameter \"%s\" is not specified. \n", key);
+        exit(1);
+    }
+
+    free(val);
+    return result;
+}
+
 
 MPI_Datatype get_basetype_value_from_dict(const char* key, const dictionary_t *hashtable) {
     char* val = NULL;
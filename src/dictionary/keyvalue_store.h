@@ -60,6 +60,7 @@ int remove_element_from_dict(const char* key, dictionary_t *hashtable);
 
 int get_value_from_dict(const dictionary_t *hashtable, const char* key, char** value);
 int get_int_value_from_dict(const char* key, const dictionary_t *hashtable);
+long long get_long_value_from_dict(const char* key, const dictionary_t *hashtable);
 MPI_Datatype get_basetype_value_from_dict(const char* key, const dictionary_t *hashtable);
 MPI_Datatype* get_basetype_list_from_dict(const char* key, const int n, const dictionary_t *hashtable);
 int_array_t* get_int_array_from_dict(const char* key, const dictionary_t *hashtable);
@@ -0,0 +1,399 @@
+/*  MPI-Datatybe - MPI Datatype Benchmark
+ *  
+ *  Copyright 2017 Alexandra Carpen-Amarie, Sascha Hunold, Jesper Larsson Träff
+ *      Research Group for Parallel Computing
+ *      Faculty of Informatics
+ *      Vienna University of Technology, Austria
+ *  
+ *  <license>
+ *      This program is free software: you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation, either version 2 of the License, or
+ *      (at your option) any later version.
+ *  
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *  
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *  </license>
+ */
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <limits.h>
+#include <assert.h>
+#include <mpi.h>
+
+#include "halo_pattern.h"
+#include "util.h"
+#include "large_count.h"
+#include "typemap/typemap.h"
+//@ add_includes
+
+//@ declare_variables
+
+
+static const char* PATTERN_HALO = "halo";
+static const char* EXCHANGE_NEIGHBOR = "neighbor_alltoallw";
+static const char* EXCHANGE_P2P = "isend_irecv";
+
+static const int CACHE_LINE_SIZE = 64;
+
+#define MAX_DIMS 3
+#define MAX_NEIGHBORS (2 * MAX_DIMS)
+
+
+/* neighbor k = 2*i (lower) and 2*i+1 (upper) along dimension i, the order of the Cartesian
+ * neighborhood collectives; the message sent to the lower neighbor is tagged 2*i, the one sent
+ * to the upper neighbor 2*i+1 (processes may be their own or both neighbors) */
+typedef struct halo {
+    MPI_Comm cart;
+    int ndims;
+    int nneighbors;
+    int neighbors[MAX_NEIGHBORS];
+    MPI_Datatype sendtypes[MAX_NEIGHBORS];  // faces of the interior
+    MPI_Datatype recvtypes[MAX_NEIGHBORS];  // halo faces
+    void *grid;
+} halo_t;
+
+
+// largest L with L^d <= n
+static long long int_root(long long n, int d) {
+    long long r, p;
+    int i;
+
+    r = (long long)pow((double)n, 1.0 / d);
+    while (1) {           // correct rounding errors of pow
+        for (i=0, p=1; i<d; i++) p *= r + 1;
+        if (p > n) break;
+        r++;
+    }
+    while (r > 0) {
+        for (i=0, p=1; i<d; i++) p *= r;
+        if (p <= n) break;
+        r--;
+    }
+    return r;
+}
+
+
+static void create_cart_comm(MPI_Comm comm, int ndims, MPI_Comm *cart, int *dims) {
+    int periods[MAX_DIMS];
+    int size, i;
+
+    MPI_Comm_size(comm, &size);
+    for (i = 0; i < ndims; i++) {
+        dims[i] = 0;
+        periods[i] = 1;
+    }
+    MPI_Dims_create(size, ndims, dims);
+    MPI_Cart_create(comm, ndims, dims, periods, 0, cart);
+}
+
+
+// grid of (L+2W)^dims elements in C order, face types of width W (no corners)
+static void create_halo_types(halo_t *halo, long long L, int W, MPI_Datatype b) {
+    int sizes[MAX_DIMS], subsizes[MAX_DIMS], starts[MAX_DIMS];
+    int i, j, k, dir;
+
+    for (i = 0; i < halo->ndims; i++) {
+        MPI_Cart_shift(halo->cart, i, 1, &halo->neighbors[2*i], &halo->neighbors[2*i+1]);
+    }
+
+    for (k = 0; k < halo->nneighbors; k++) {
+        i = k / 2;
+        dir = k % 2;
+        for (j = 0; j < halo->ndims; j++) {
+            sizes[j] = (int)L + 2*W;
+            subsizes[j] = (j == i) ? W : (int)L;
+            starts[j] = W;
+        }
+        starts[i] = (dir == 0) ? W : (int)L;
+        MPI_Type_create_subarray(halo->ndims, sizes, subsizes, starts, MPI_ORDER_C, b, &halo->sendtypes[k]);
+        MPI_Type_commit(&halo->sendtypes[k]);
+        starts[i] = (dir == 0) ? 0 : (int)L + W;
+        MPI_Type_create_subarray(halo->ndims, sizes, subsizes, starts, MPI_ORDER_C, b, &halo->recvtypes[k]);
+        MPI_Type_commit(&halo->recvtypes[k]);
+    }
+}
+
+
+static void free_halo_types(halo_t *halo) {
+    int k;
+
+    for (k = 0; k < halo->nneighbors; k++) {
+        MPI_Type_free(&halo->sendtypes[k]);
+        MPI_Type_free(&halo->recvtypes[k]);
+    }
+}
+
+
+static void halo_neighbor_alltoallw(const halo_t *halo) {
+    int counts[MAX_NEIGHBORS];
+    MPI_Aint displs[MAX_NEIGHBORS];
+    int k, c = 1;
+
+    // not to measure
+    for (k = 0; k < halo->nneighbors; k++) {
+        counts[k] = 1;
+        displs[k] = 0;
+    }
+
+    //@ set test_type="datatype"
+    //@ set exchange=EXCHANGE_NEIGHBOR
+
+    //@ initialize_timestamps t1
+    //@ initialize_timestamps t2
+
+    //@ start_measurement_loop
+
+    //@ start_sync
+    //@ measure_timestamp t1
+    MPI_Neighbor_alltoallw(halo->grid, counts, displs, halo->sendtypes,
+            halo->grid, counts, displs, halo->recvtypes, halo->cart);
+    //@ measure_timestamp t2
+    //@ stop_sync
+    //@stop_measurement_loop
+
+    //@ print_runtime_array name=runtime end_time=t2 start_time=t1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+
+    //@cleanup_variables
+}
+
+
+static void halo_isend_irecv(const halo_t *halo) {
+    MPI_Request reqs[2 * MAX_NEIGHBORS];
+    int k, n, c = 1;
+
+    n = halo->nneighbors;
+
+    //@ set test_type="datatype"
+    //@ set exchange=EXCHANGE_P2P
+
+    //@ initialize_timestamps t1
+    //@ initialize_timestamps t2
+
+    //@ start_measurement_loop
+
+    //@ start_sync
+    //@ measure_timestamp t1
+    for (k = 0; k < n; k++) {
+        // the lower neighbor sends with tag 2*i+1, the upper neighbor with tag 2*i
+        MPI_Irecv(halo->grid, 1, halo->recvtypes[k], halo->neighbors[k], k ^ 1, halo->cart, &reqs[k]);
+    }
+    for (k = 0; k < n; k++) {
+        MPI_Isend(halo->grid, 1, halo->sendtypes[k], halo->neighbors[k], k, halo->cart, &reqs[n + k]);
+    }
+    MPI_Waitall(2 * n, reqs, MPI_STATUSES_IGNORE);
+    //@ measure_timestamp t2
+    //@ stop_sync
+    //@stop_measurement_loop
+
+    //@ print_runtime_array name=runtime end_time=t2 start_time=t1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+
+    //@cleanup_variables
+}
+
+
+static void halo_pack(const halo_t *halo) {
+    MPI_Request reqs[2 * MAX_NEIGHBORS];
+    MPI_Count packsize[MAX_NEIGHBORS];
+    size_t offsets[MAX_NEIGHBORS + 1];
+    MPI_Count position;
+    void *sendpack, *recvpack;
+    int k, n, c = 1;
+
+    // not to measure
+    n = halo->nneighbors;
+    offsets[0] = 0;
+    for (k = 0; k < n; k++) {
+        packsize[k] = get_pack_size(1, halo->sendtypes[k], halo->cart);
+        offsets[k+1] = offsets[k] + packsize[k];
+    }
+    posix_memalign(&sendpack, CACHE_LINE_SIZE, offsets[n]);
+    assert(sendpack!=NULL);
+    posix_memalign(&recvpack, CACHE_LINE_SIZE, offsets[n]);
+    assert(recvpack!=NULL);
+
+    //@ set test_type="pack"
+    //@ set exchange=EXCHANGE_P2P
+
+    //@ initialize_timestamps t1
+    //@ initialize_timestamps t2
+    //@ initialize_timestamps tp1
+    //@ initialize_timestamps tp2
+    //@ initialize_timestamps tc1
+    //@ initialize_timestamps tc2
+    //@ initialize_timestamps tu1
+    //@ initialize_timestamps tu2
+
+    //@ start_measurement_loop
+
+    //@ start_sync
+    //@ measure_timestamp t1
+    //@ measure_timestamp tp1
+    for (k = 0; k < n; k++) {
+        position = 0;
+        large_pack(halo->grid, 1, halo->sendtypes[k], (char*)sendpack + offsets[k], packsize[k], &position, halo->cart);
+    }
+    //@ measure_timestamp tp2
+    //@ measure_timestamp tc1
+    for (k = 0; k < n; k++) {
+        // opposite faces have the same size
+        large_irecv((char*)recvpack + offsets[k], packsize[k], MPI_PACKED, halo->neighbors[k], k ^ 1, halo->cart, &reqs[k]);
+    }
+    for (k = 0; k < n; k++) {
+        large_isend((char*)sendpack + offsets[k], packsize[k], MPI_PACKED, halo->neighbors[k], k, halo->cart, &reqs[n + k]);
+    }
+    MPI_Waitall(2 * n, reqs, MPI_STATUSES_IGNORE);
+    //@ measure_timestamp tc2
+    //@ measure_timestamp tu1
+    for (k = 0; k < n; k++) {
+        position = 0;
+        large_unpack((char*)recvpack + offsets[k], packsize[k], &position, halo->grid, 1, halo->recvtypes[k], halo->cart);
+    }
+    //@ measure_timestamp tu2
+    //@ measure_timestamp t2
+    //@ stop_sync
+    //@stop_measurement_loop
+
+    //@ print_runtime_array name=runtime end_time=t2 start_time=t1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+    //@ print_runtime_array name=pack_time end_time=tp2 start_time=tp1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+    //@ print_runtime_array name=comm_time end_time=tc2 start_time=tc1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+    //@ print_runtime_array name=unpack_time end_time=tu2 start_time=tu1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+
+    //@cleanup_variables
+    free(sendpack);
+    free(recvpack);
+}
+
+
+static void measure_halo(pattern_config_t conf, halo_t *halo, long long L, int W, MPI_Datatype b, char* nbytes_str) {
+    MPI_Aint lb, extent;
+    MPI_Count typesize, realsize, nblocks;
+    char *typesize_str, *real_size_str, *extent_str, *nblocks_str, *mean_block_str, *local_size_str;
+    int k;
+
+    create_halo_types(halo, L, W, b);
+    MPI_Type_get_extent(halo->sendtypes[0], &lb, &extent);
+    posix_memalign(&halo->grid, CACHE_LINE_SIZE, extent);
+    assert(halo->grid!=NULL);
+    memset(halo->grid, 0, extent);
+
+    // size of the first face (normal to the slowest dimension), data and blocks of all faces
+    typesize = get_type_size(halo->sendtypes[0]);
+    realsize = 0;
+    nblocks = 0;
+    for (k = 0; k < halo->nneighbors; k++) {
+        realsize += get_type_size(halo->sendtypes[k]);
+        nblocks += get_typemap_nblocks(halo->sendtypes[k], 1);
+    }
+
+    typesize_str  = my_count_to_string(typesize);
+    extent_str  = my_count_to_string(extent);
+    real_size_str = my_count_to_string(realsize);
+    nblocks_str = my_count_to_string(nblocks);
+    mean_block_str = my_count_to_string((nblocks > 0) ? realsize/nblocks : 0);
+    local_size_str = my_count_to_string(L);
+
+    //@ set nbytes_str=nbytes_str
+    //@ set derivedtype_size=typesize_str
+    //@ set real_size=real_size_str
+    //@ set derivedtype_extent=extent_str
+    //@ set nblocks=nblocks_str
+    //@ set mean_block=mean_block_str
+    //@ set local_grid_size=local_size_str
+
+    switch (conf.test_type) {
+    case test_datatype:
+        halo_neighbor_alltoallw(halo);
+        halo_isend_irecv(halo);
+        break;
+    case test_pack:
+        halo_pack(halo);
+        break;
+    default:
+        printf("Error: the halo pattern only supports the test types datatype and pack\n");
+        exit(1);
+    }
+
+    free(typesize_str);
+    free(extent_str);
+    free(real_size_str);
+    free(nblocks_str);
+    free(mean_block_str);
+    free(local_size_str);
+    free(halo->grid);
+    free_halo_types(halo);
+}
+
+
+int halopattern(pattern_config_t conf, dictionary_t *dict)
+{
+    int i;
+    string_array_t* nbytes_list = NULL;
+    halo_t halo;
+    int dims[MAX_DIMS];
+    char *proc_grid_str;
+    long long L, L0;
+    int W, basesize;
+    MPI_Datatype b;
+
+    //@ global pattern_type=PATTERN_HALO
+
+    nbytes_list = get_string_array_from_dict("nbytes_list", dict);
+    halo.ndims = get_int_value_from_dict("dims", dict);
+    if (halo.ndims != 2 && halo.ndims != 3) {
+        printf("Error: dims has to be 2 or 3\n");
+        exit(1);
+    }
+    W = get_int_value_from_dict("W", dict);
+    if (W <= 0) {
+        printf("Error: W has to be a positive integer\n");
+        exit(1);
+    }
+    b = get_basetype_value_from_dict("b", dict);
+    MPI_Type_size(b, &basesize);
+    halo.nneighbors = 2 * halo.ndims;
+
+    create_cart_comm(conf.comm, halo.ndims, &halo.cart, dims);
+    proc_grid_str = (char*)malloc(64);
+    if (halo.ndims == 2) {
+        sprintf(proc_grid_str, "%dx%d", dims[0], dims[1]);
+    } else {
+        sprintf(proc_grid_str, "%dx%dx%d", dims[0], dims[1], dims[2]);
+    }
+    //@ set proc_grid=proc_grid_str
+
+    L0 = -1;
+    for (i=0; i<nbytes_list->n_elems; i++) {
+        // the local interior grid has at most nbytes bytes
+        L = int_root(atol(nbytes_list->elements[i]) / basesize, halo.ndims);
+        if (L == L0) {
+            continue;
+        }
+        L0 = L;
+        if (L < W || L + 2*W > INT_MAX) {
+            fprintf(stderr, "WARNING: local grid size %lld invalid for halo width %d...skipping case\n", L, W);
+            continue;
+        }
+
+        measure_halo(conf, &halo, L, W, b, nbytes_list->elements[i]);
+    }
+
+    free(proc_grid_str);
+    MPI_Comm_free(&halo.cart);
+    for (i=0; i<nbytes_list->n_elems; i++) {
+        free(nbytes_list->elements[i]);
+    }
+    free(nbytes_list->elements);
+    free(nbytes_list);
+
+    return MPI_SUCCESS;
+}
@@ -0,0 +1,38 @@
+/*  MPI-Datatybe - MPI Datatype Benchmark
+ *  
+ *  Copyright 2017 Alexandra Carpen-Amarie, Sascha Hunold, Jesper Larsson Träff
+ *      Research Group for Parallel Computing
+ *      Faculty of Informatics
+ *      Vienna University of Technology, Austria
+ *  
+ *  <license>
+ *      This program is free software: you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation, either version 2 of the License, or
+ *      (at your option) any later version.
+ *  
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *  
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *  </license>
+ */
+
+
+#ifndef HALO_PATTERN_H_
+#define HALO_PATTERN_H_
+
+#include "datatypes_bench.h"
+#include "dictionary/keyvalue_store.h"
+
+/* halo exchange of a 2D/3D grid on a periodic Cartesian communicator (MPI_Dims_create over
+ * conf.comm): each process holds L^dims interior elements of the basetype (L^dims <= nbytes/size(b))
+ * surrounded by a halo of width W and exchanges its faces with its 2*dims neighbors; the faces are
+ * subarray datatypes; test type datatype measures MPI_Neighbor_alltoallw and an MPI_Isend/MPI_Irecv
+ * exchange with the face datatypes, test type pack an MPI_Isend/MPI_Irecv exchange of the packed faces */
+int halopattern(pattern_config_t conf, dictionary_t *dict);
+
+#endif /* HALO_PATTERN_H_ */
@@ -0,0 +1,575 @@
+/*  MPI-Datatybe - MPI Datatype Benchmark
+ *  
+ *  Copyright 2017 Alexandra Carpen-Amarie, Sascha Hunold, Jesper Larsson Träff
+ *      Research Group for Parallel Computing
+ *      Faculty of Informatics
+ *      Vienna University of Technology, Austria
+ *  
+ *  <license>
+ *      This program is free software: you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation, either version 2 of the License, or
+ *      (at your option) any later version.
+ *  
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *  
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *  </license>
+ */
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <limits.h>
+#include <mpi.h>
+
+#include "large_count.h"
+
+#if MPI_VERSION < 4 && defined(OPEN_MPI)
+#include <mpi-ext.h>
+#endif
+
+#if MPI_VERSION < 4
+// elements per chunk of the types used for counts beyond INT_MAX
+static const MPI_Count CHUNK_COUNT = 1 << 30;
+
+
+static void check_int_count(MPI_Count count, const char* function) {
+    if (count > INT_MAX || count < INT_MIN) {
+        printf("Error: %s with counts or sizes beyond %d requires an MPI-4 library\n", function, INT_MAX);
+        exit(1);
+    }
+}
+
+
+// one instance of the returned type covers count elements of type (extent count*extent(type))
+static void create_large_contiguous(MPI_Count count, MPI_Datatype type, MPI_Datatype *newtype) {
+    MPI_Datatype chunk, chunks, rest, tmp;
+    MPI_Aint lb, extent;
+    MPI_Count nchunks = count / CHUNK_COUNT;
+    MPI_Count remainder = count % CHUNK_COUNT;
+    int blocklens[2] = { 1, 1 };
+    MPI_Aint displs[2];
+    MPI_Datatype types[2];
+
+    MPI_Type_get_extent(type, &lb, &extent);
+    MPI_Type_contiguous((int)CHUNK_COUNT, type, &chunk);
+    MPI_Type_contiguous((int)nchunks, chunk, &chunks);
+    MPI_Type_contiguous((int)remainder, type, &rest);
+
+    displs[0] = 0;
+    displs[1] = (MPI_Aint)(nchunks * CHUNK_COUNT) * extent;
+    types[0] = chunks;
+    types[1] = rest;
+    MPI_Type_create_struct(2, blocklens, displs, types, &tmp);
+    MPI_Type_create_resized(tmp, 0, (MPI_Aint)count * extent, newtype);
+    MPI_Type_commit(newtype);
+
+    MPI_Type_free(&chunk);
+    MPI_Type_free(&chunks);
+    MPI_Type_free(&rest);
+    MPI_Type_free(&tmp);
+}
+#else
+static int fits_int(MPI_Count value) {
+    return value <= INT_MAX && value >= INT_MIN;
+}
+#endif
+
+
+MPI_Count get_type_size(MPI_Datatype type) {
+    MPI_Count size;
+
+#if MPI_VERSION >= 4
+    MPI_Type_size_c(type, &size);
+#else
+    MPI_Type_size_x(type, &size);
+#endif
+    return size;
+}
+
+
+MPI_Count get_pack_size(MPI_Count incount, MPI_Datatype type, MPI_Comm comm) {
+#if MPI_VERSION >= 4
+    MPI_Count size;
+
+    MPI_Pack_size_c(incount, type, comm, &size);
+    return size;
+#else
+    int size;
+
+    check_int_count(incount, "MPI_Pack_size");
+    check_int_count(incount * get_type_size(type), "MPI_Pack_size");
+    MPI_Pack_size((int)incount, type, comm, &size);
+    return size;
+#endif
+}
+
+
+int large_pack(const void *inbuf, MPI_Count incount, MPI_Datatype type,
+        void *outbuf, MPI_Count outsize, MPI_Count *position, MPI_Comm comm) {
+#if MPI_VERSION >= 4
+    return MPI_Pack_c(inbuf, incount, type, outbuf, outsize, position, comm);
+#else
+    int pos = (int)*position;
+    int ret;
+
+    check_int_count(incount, "MPI_Pack");
+    check_int_count(outsize, "MPI_Pack");
+    ret = MPI_Pack(inbuf, (int)incount, type, outbuf, (int)outsize, &pos, comm);
+    *position = pos;
+    return ret;
+#endif
+}
+
+
+int large_unpack(const void *inbuf, MPI_Count insize, MPI_Count *position,
+        void *outbuf, MPI_Count outcount, MPI_Datatype type, MPI_Comm comm) {
+#if MPI_VERSION >= 4
+    return MPI_Unpack_c(inbuf, insize, position, outbuf, outcount, type, comm);
+#else
+    int pos = (int)*position;
+    int ret;
+
+    check_int_count(insize, "MPI_Unpack");
+    check_int_count(outcount, "MPI_Unpack");
+    ret = MPI_Unpack(inbuf, (int)insize, &pos, outbuf, (int)outcount, type, comm);
+    *position = pos;
+    return ret;
+#endif
+}
+
+
+int large_send(const void *buf, MPI_Count count, MPI_Datatype type, int dest, int tag, MPI_Comm comm) {
+#if MPI_VERSION >= 4
+    return MPI_Send_c(buf, count, type, dest, tag, comm);
+#else
+    MPI_Datatype large;
+    int ret;
+
+    if (count <= INT_MAX) {
+        return MPI_Send(buf, (int)count, type, dest, tag, comm);
+    }
+    create_large_contiguous(count, type, &large);
+    ret = MPI_Send(buf, 1, large, dest, tag, comm);
+    MPI_Type_free(&large);
+    return ret;
+#endif
+}
+
+
+int large_recv(void *buf, MPI_Count count, MPI_Datatype type, int source, int tag, MPI_Comm comm) {
+#if MPI_VERSION >= 4
+    return MPI_Recv_c(buf, count, type, source, tag, comm, MPI_STATUS_IGNORE);
+#else
+    MPI_Datatype large;
+    int ret;
+
+    if (count <= INT_MAX) {
+        return MPI_Recv(buf, (int)count, type, source, tag, comm, MPI_STATUS_IGNORE);
+    }
+    create_large_contiguous(count, type, &large);
+    ret = MPI_Recv(buf, 1, large, source, tag, comm, MPI_STATUS_IGNORE);
+    MPI_Type_free(&large);
+    return ret;
+#endif
+}
+
+
+int large_sendrecv(const void *sendbuf, MPI_Count sendcount, MPI_Datatype sendtype, int dest, int sendtag,
+        void *recvbuf, MPI_Count recvcount, MPI_Datatype recvtype, int source, int recvtag, MPI_Comm comm) {
+#if MPI_VERSION >= 4
+    return MPI_Sendrecv_c(sendbuf, sendcount, sendtype, dest, sendtag, recvbuf, recvcount, recvtype, source, recvtag,
+            comm, MPI_STATUS_IGNORE);
+#else
+    MPI_Datatype large_send_type, large_recv_type;
+    int ret;
+
+    if (sendcount <= INT_MAX && recvcount <= INT_MAX) {
+        return MPI_Sendrecv(sendbuf, (int)sendcount, sendtype, dest, sendtag, recvbuf, (int)recvcount, recvtype,
+                source, recvtag, comm, MPI_STATUS_IGNORE);
+    }
+    create_large_contiguous(sendcount, sendtype, &large_send_type);
+    create_large_contiguous(recvcount, recvtype, &large_recv_type);
+    ret = MPI_Sendrecv(sendbuf, 1, large_send_type, dest, sendtag, recvbuf, 1, large_recv_type,
+            source, recvtag, comm, MPI_STATUS_IGNORE);
+    MPI_Type_free(&large_send_type);
+    MPI_Type_free(&large_recv_type);
+    return ret;
+#endif
+}
+
+
+int large_bcast(void *buf, MPI_Count count, MPI_Datatype type, int root, MPI_Comm comm) {
+#if MPI_VERSION >= 4
+    return MPI_Bcast_c(buf, count, type, root, comm);
+#else
+    MPI_Datatype large;
+    int ret;
+
+    if (count <= INT_MAX) {
+        return MPI_Bcast(buf, (int)count, type, root, comm);
+    }
+    create_large_contiguous(count, type, &large);
+    ret = MPI_Bcast(buf, 1, large, root, comm);
+    MPI_Type_free(&large);
+    return ret;
+#endif
+}
+
+
+int large_allgather(const void *sendbuf, MPI_Count count, MPI_Datatype type, void *recvbuf, MPI_Comm comm) {
+#if MPI_VERSION >= 4
+    return MPI_Allgather_c(sendbuf, count, type, recvbuf, count, type, comm);
+#else
+    MPI_Datatype large;
+    int ret;
+
+    if (count <= INT_MAX) {
+        return MPI_Allgather(sendbuf, (int)count, type, recvbuf, (int)count, type, comm);
+    }
+    create_large_contiguous(count, type, &large);
+    ret = MPI_Allgather(sendbuf, 1, large, recvbuf, 1, large, comm);
+    MPI_Type_free(&large);
+    return ret;
+#endif
+}
+
+
+int large_gather(const void *sendbuf, MPI_Count count, MPI_Datatype type, void *recvbuf, int root, MPI_Comm comm) {
+#if MPI_VERSION >= 4
+    return MPI_Gather_c(sendbuf, count, type, recvbuf, count, type, root, comm);
+#else
+    MPI_Datatype large;
+    int ret;
+
+    if (count <= INT_MAX) {
+        return MPI_Gather(sendbuf, (int)count, type, recvbuf, (int)count, type, root, comm);
+    }
+    create_large_contiguous(count, type, &large);
+    ret = MPI_Gather(sendbuf, 1, large, recvbuf, 1, large, root, comm);
+    MPI_Type_free(&large);
+    return ret;
+#endif
+}
+
+
+int large_scatter(const void *sendbuf, MPI_Count count, MPI_Datatype type, void *recvbuf, int root, MPI_Comm comm) {
+#if MPI_VERSION >= 4
+    return MPI_Scatter_c(sendbuf, count, type, recvbuf, count, type, root, comm);
+#else
+    MPI_Datatype large;
+    int ret;
+
+    if (count <= INT_MAX) {
+        return MPI_Scatter(sendbuf, (int)count, type, recvbuf, (int)count, type, root, comm);
+    }
+    create_large_contiguous(count, type, &large);
+    ret = MPI_Scatter(sendbuf, 1, large, recvbuf, 1, large, root, comm);
+    MPI_Type_free(&large);
+    return ret;
+#endif
+}
+
+
+int large_alltoall(const void *sendbuf, MPI_Count count, MPI_Datatype type, void *recvbuf, MPI_Comm comm) {
+#if MPI_VERSION >= 4
+    return MPI_Alltoall_c(sendbuf, count, type, recvbuf, count, type, comm);
+#else
+    MPI_Datatype large;
+    int ret;
+
+    if (count <= INT_MAX) {
+        return MPI_Alltoall(sendbuf, (int)count, type, recvbuf, (int)count, type, comm);
+    }
+    create_large_contiguous(count, type, &large);
+    ret = MPI_Alltoall(sendbuf, 1, large, recvbuf, 1, large, comm);
+    MPI_Type_free(&large);
+    return ret;
+#endif
+}
+
+
+#if MPI_VERSION < 4
+// int counts and displacements of the MPI-3 v/w collectives
+static void to_int_array(const MPI_Count *counts, int n, int *ints, const char* function) {
+    int i;
+
+    for (i = 0; i < n; i++) {
+        check_int_count(counts[i], function);
+        ints[i] = (int)counts[i];
+    }
+}
+#endif
+
+
+int large_alltoallv(const void *sendbuf, const MPI_Count *sendcounts, const MPI_Aint *sdispls,
+        void *recvbuf, const MPI_Count *recvcounts, const MPI_Aint *rdispls, MPI_Datatype type, MPI_Comm comm) {
+#if MPI_VERSION >= 4
+    return MPI_Alltoallv_c(sendbuf, sendcounts, sdispls, type, recvbuf, recvcounts, rdispls, type, comm);
+#else
+    int *ints;
+    MPI_Count *displs;
+    int size, i, ret;
+
+    MPI_Comm_size(comm, &size);
+    ints = (int*)malloc(4 * size * sizeof(int));
+    displs = (MPI_Count*)malloc(2 * size * sizeof(MPI_Count));
+    for (i = 0; i < size; i++) {
+        displs[i] = sdispls[i];
+        displs[size + i] = rdispls[i];
+    }
+    to_int_array(sendcounts, size, ints, "MPI_Alltoallv");
+    to_int_array(recvcounts, size, ints + size, "MPI_Alltoallv");
+    to_int_array(displs, 2 * size, ints + 2 * size, "MPI_Alltoallv");
+    ret = MPI_Alltoallv(sendbuf, ints, ints + 2 * size, type, recvbuf, ints + size, ints + 3 * size, type, comm);
+    free(displs);
+    free(ints);
+    return ret;
+#endif
+}
+
+
+int large_alltoallw(const void *sendbuf, const MPI_Count *sendcounts, const MPI_Aint *sdispls,
+        const MPI_Datatype *sendtypes, void *recvbuf, const MPI_Count *recvcounts, const MPI_Aint *rdispls,
+        const MPI_Datatype *recvtypes, MPI_Comm comm) {
+#if MPI_VERSION >= 4
+    return MPI_Alltoallw_c(sendbuf, sendcounts, sdispls, sendtypes, recvbuf, recvcounts, rdispls, recvtypes, comm);
+#else
+    int *ints;
+    MPI_Count *displs;
+    int size, i, ret;
+
+    MPI_Comm_size(comm, &size);
+    ints = (int*)malloc(4 * size * sizeof(int));
+    displs = (MPI_Count*)malloc(2 * size * sizeof(MPI_Count));
+    for (i = 0; i < size; i++) {
+        displs[i] = sdispls[i];
+        displs[size + i] = rdispls[i];
+    }
+    to_int_array(sendcounts, size, ints, "MPI_Alltoallw");
+    to_int_array(recvcounts, size, ints + size, "MPI_Alltoallw");
+    to_int_array(displs, 2 * size, ints + 2 * size, "MPI_Alltoallw");
+    ret = MPI_Alltoallw(sendbuf, ints, ints + 2 * size, sendtypes, recvbuf, ints + size, ints + 3 * size,
+            recvtypes, comm);
+    free(displs);
+    free(ints);
+    return ret;
+#endif
+}
+
+int large_isend(const void *buf, MPI_Count count, MPI_Datatype type, int dest, int tag, MPI_Comm comm,
+        MPI_Request *request) {
+#if MPI_VERSION >= 4
+    return MPI_Isend_c(buf, count, type, dest, tag, comm, request);
+#else
+    MPI_Datatype large;
+    int ret;
+
+    if (count <= INT_MAX) {
+        return MPI_Isend(buf, (int)count, type, dest, tag, comm, request);
+    }
+    create_large_contiguous(count, type, &large);
+    ret = MPI_Isend(buf, 1, large, dest, tag, comm, request);
+    MPI_Type_free(&large);
+    return ret;
+#endif
+}
+
+
+int large_irecv(void *buf, MPI_Count count, MPI_Datatype type, int source, int tag, MPI_Comm comm,
+        MPI_Request *request) {
+#if MPI_VERSION >= 4
+    return MPI_Irecv_c(buf, count, type, source, tag, comm, request);
+#else
+    MPI_Datatype large;
+    int ret;
+
+    if (count <= INT_MAX) {
+        return MPI_Irecv(buf, (int)count, type, source, tag, comm, request);
+    }
+    create_large_contiguous(count, type, &large);
+    ret = MPI_Irecv(buf, 1, large, source, tag, comm, request);
+    MPI_Type_free(&large);
+    return ret;
+#endif
+}
+
+
+int large_ibcast(void *buf, MPI_Count count, MPI_Datatype type, int root, MPI_Comm comm, MPI_Request *request) {
+#if MPI_VERSION >= 4
+    return MPI_Ibcast_c(buf, count, type, root, comm, request);
+#else
+    MPI_Datatype large;
+    int ret;
+
+    if (count <= INT_MAX) {
+        return MPI_Ibcast(buf, (int)count, type, root, comm, request);
+    }
+    create_large_contiguous(count, type, &large);
+    ret = MPI_Ibcast(buf, 1, large, root, comm, request);
+    MPI_Type_free(&large);
+    return ret;
+#endif
+}
+
+
+int large_iallgather(const void *sendbuf, MPI_Count count, MPI_Datatype type, void *recvbuf, MPI_Comm comm,
+        MPI_Request *request) {
+#if MPI_VERSION >= 4
+    return MPI_Iallgather_c(sendbuf, count, type, recvbuf, count, type, comm, request);
+#else
+    MPI_Datatype large;
+    int ret;
+
+    if (count <= INT_MAX) {
+        return MPI_Iallgather(sendbuf, (int)count, type, recvbuf, (int)count, type, comm, request);
+    }
+    create_large_contiguous(count, type, &large);
+    ret = MPI_Iallgather(sendbuf, 1, large, recvbuf, 1, large, comm, request);
+    MPI_Type_free(&large);
+    return ret;
+#endif
+}
+
+
+int large_send_init(const void *buf, MPI_Count count, MPI_Datatype type, int dest, int tag, MPI_Comm comm,
+        MPI_Request *request) {
+#if MPI_VERSION >= 4
+    return MPI_Send_init_c(buf, count, type, dest, tag, comm, request);
+#else
+    check_int_count(count, "MPI_Send_init");
+    return MPI_Send_init(buf, (int)count, type, dest, tag, comm, request);
+#endif
+}
+
+
+int large_recv_init(void *buf, MPI_Count count, MPI_Datatype type, int source, int tag, MPI_Comm comm,
+        MPI_Request *request) {
+#if MPI_VERSION >= 4
+    return MPI_Recv_init_c(buf, count, type, source, tag, comm, request);
+#else
+    check_int_count(count, "MPI_Recv_init");
+    return MPI_Recv_init(buf, (int)count, type, source, tag, comm, request);
+#endif
+}
+
+
+int large_bcast_init(void *buf, MPI_Count count, MPI_Datatype type, int root, MPI_Comm comm, MPI_Request *request) {
+#if MPI_VERSION >= 4
+    return MPI_Bcast_init_c(buf, count, type, root, comm, MPI_INFO_NULL, request);
+#elif defined(OMPI_HAVE_MPI_EXT_PCOLLREQ)
+    check_int_count(count, "MPIX_Bcast_init");
+    return MPIX_Bcast_init(buf, (int)count, type, root, comm, MPI_INFO_NULL, request);
+#else
+    printf("Error: MPI_Bcast_init requires an MPI-4 library\n");
+    exit(1);
+#endif
+}
+
+
+int large_allgather_init(const void *sendbuf, MPI_Count count, MPI_Datatype type, void *recvbuf, MPI_Comm comm,
+        MPI_Request *request) {
+#if MPI_VERSION >= 4
+    return MPI_Allgather_init_c(sendbuf, count, type, recvbuf, count, type, comm, MPI_INFO_NULL, request);
+#elif defined(OMPI_HAVE_MPI_EXT_PCOLLREQ)
+    check_int_count(count, "MPIX_Allgather_init");
+    return MPIX_Allgather_init(sendbuf, (int)count, type, recvbuf, (int)count, type, comm, MPI_INFO_NULL, request);
+#else
+    printf("Error: MPI_Allgather_init requires an MPI-4 library\n");
+    exit(1);
+#endif
+}
+
+
+int large_type_contiguous(MPI_Count count, MPI_Datatype type, MPI_Datatype *newtype) {
+#if MPI_VERSION >= 4
+    if (!fits_int(count)) {
+        return MPI_Type_contiguous_c(count, type, newtype);
+    }
+#else
+    check_int_count(count, "MPI_Type_contiguous");
+#endif
+    return MPI_Type_contiguous((int)count, type, newtype);
+}
+
+
+int large_type_vector(MPI_Count count, MPI_Count blocklength, MPI_Count stride, MPI_Datatype type,
+        MPI_Datatype *newtype) {
+#if MPI_VERSION >= 4
+    if (!fits_int(count) || !fits_int(blocklength) || !fits_int(stride)) {
+        return MPI_Type_vector_c(count, blocklength, stride, type, newtype);
+    }
+#else
+    check_int_count(count, "MPI_Type_vector");
+    check_int_count(blocklength, "MPI_Type_vector");
+    check_int_count(stride, "MPI_Type_vector");
+#endif
+    return MPI_Type_vector((int)count, (int)blocklength, (int)stride, type, newtype);
+}
+
+
+int large_type_create_hvector(MPI_Count count, MPI_Count blocklength, MPI_Aint stride, MPI_Datatype type,
+        MPI_Datatype *newtype) {
+#if MPI_VERSION >= 4
+    if (!fits_int(count) || !fits_int(blocklength)) {
+        return MPI_Type_create_hvector_c(count, blocklength, stride, type, newtype);
+    }
+#else
+    check_int_count(count, "MPI_Type_create_hvector");
+    check_int_count(blocklength, "MPI_Type_create_hvector");
+#endif
+    return MPI_Type_create_hvector((int)count, (int)blocklength, stride, type, newtype);
+}
+
+
+int large_type_create_hindexed(MPI_Count count, const int *blocklengths, const MPI_Aint *displs,
+        MPI_Datatype type, MPI_Datatype *newtype) {
+#if MPI_VERSION >= 4
+    MPI_Count *counts;
+    MPI_Count i;
+    int ret;
+
+    if (!fits_int(count)) {
+        counts = (MPI_Count*)malloc(2 * count * sizeof(MPI_Count));
+        for (i = 0; i < count; i++) {
+            counts[i] = blocklengths[i];
+            counts[count + i] = displs[i];
+        }
+        ret = MPI_Type_create_hindexed_c(count, counts, counts + count, type, newtype);
+        free(counts);
+        return ret;
+    }
+#else
+    check_int_count(count, "MPI_Type_create_hindexed");
+#endif
+    return MPI_Type_create_hindexed((int)count, blocklengths, displs, type, newtype);
+}
+
+
+int large_type_create_hindexed_block(MPI_Count count, MPI_Count blocklength, const MPI_Aint *displs,
+        MPI_Datatype type, MPI_Datatype *newtype) {
+#if MPI_VERSION >= 4
+    MPI_Count *counts;
+    MPI_Count i;
+    int ret;
+
+    if (!fits_int(count) || !fits_int(blocklength)) {
+        counts = (MPI_Count*)malloc(count * sizeof(MPI_Count));
+        for (i = 0; i < count; i++) {
+            counts[i] = displs[i];
+        }
+        ret = MPI_Type_create_hindexed_block_c(count, blocklength, counts, type, newtype);
+        free(counts);
+        return ret;
+    }
+#else
+    check_int_count(count, "MPI_Type_create_hindexed_block");
+    check_int_count(blocklength, "MPI_Type_create_hindexed_block");
+#endif
+    return MPI_Type_create_hindexed_block((int)count, (int)blocklength, displs, type, newtype);
+}
@@ -0,0 +1,92 @@
+/*  MPI-Datatybe - MPI Datatype Benchmark
+ *  
+ *  Copyright 2017 Alexandra Carpen-Amarie, Sascha Hunold, Jesper Larsson Träff
+ *      Research Group for Parallel Computing
+ *      Faculty of Informatics
+ *      Vienna University of Technology, Austria
+ *  
+ *  <license>
+ *      This program is free software: you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation, either version 2 of the License, or
+ *      (at your option) any later version.
+ *  
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *  
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *  </license>
+ */
+
+
+#ifndef LARGE_COUNT_H_
+#define LARGE_COUNT_H_
+
+#include <mpi.h>
+
+/* MPI_Count versions of the MPI calls used by the benchmark:
+ * with an MPI-4 library, the large-count (_c) functions are called;
+ * otherwise, counts up to INT_MAX use the regular functions and larger
+ * contiguous transfers are sent as one instance of a type built from 1 GiB chunks
+ * (packing more than INT_MAX bytes requires MPI-4) */
+
+MPI_Count get_type_size(MPI_Datatype type);
+MPI_Count get_pack_size(MPI_Count incount, MPI_Datatype type, MPI_Comm comm);
+
+int large_pack(const void *inbuf, MPI_Count incount, MPI_Datatype type,
+        void *outbuf, MPI_Count outsize, MPI_Count *position, MPI_Comm comm);
+int large_unpack(const void *inbuf, MPI_Count insize, MPI_Count *position,
+        void *outbuf, MPI_Count outcount, MPI_Datatype type, MPI_Comm comm);
+
+int large_send(const void *buf, MPI_Count count, MPI_Datatype type, int dest, int tag, MPI_Comm comm);
+int large_recv(void *buf, MPI_Count count, MPI_Datatype type, int source, int tag, MPI_Comm comm);
+int large_sendrecv(const void *sendbuf, MPI_Count sendcount, MPI_Datatype sendtype, int dest, int sendtag,
+        void *recvbuf, MPI_Count recvcount, MPI_Datatype recvtype, int source, int recvtag, MPI_Comm comm);
+int large_bcast(void *buf, MPI_Count count, MPI_Datatype type, int root, MPI_Comm comm);
+int large_allgather(const void *sendbuf, MPI_Count count, MPI_Datatype type, void *recvbuf, MPI_Comm comm);
+int large_gather(const void *sendbuf, MPI_Count count, MPI_Datatype type, void *recvbuf, int root, MPI_Comm comm);
+int large_scatter(const void *sendbuf, MPI_Count count, MPI_Datatype type, void *recvbuf, int root, MPI_Comm comm);
+int large_alltoall(const void *sendbuf, MPI_Count count, MPI_Datatype type, void *recvbuf, MPI_Comm comm);
+// counts and displacements per process (displacements in elements of type for alltoallv, in bytes for alltoallw)
+int large_alltoallv(const void *sendbuf, const MPI_Count *sendcounts, const MPI_Aint *sdispls,
+        void *recvbuf, const MPI_Count *recvcounts, const MPI_Aint *rdispls, MPI_Datatype type, MPI_Comm comm);
+int large_alltoallw(const void *sendbuf, const MPI_Count *sendcounts, const MPI_Aint *sdispls,
+        const MPI_Datatype *sendtypes, void *recvbuf, const MPI_Count *recvcounts, const MPI_Aint *rdispls,
+        const MPI_Datatype *recvtypes, MPI_Comm comm);
+
+// nonblocking versions (the chunked types of counts beyond INT_MAX are freed right after starting the operation)
+int large_isend(const void *buf, MPI_Count count, MPI_Datatype type, int dest, int tag, MPI_Comm comm,
+        MPI_Request *request);
+int large_irecv(void *buf, MPI_Count count, MPI_Datatype type, int source, int tag, MPI_Comm comm,
+        MPI_Request *request);
+int large_ibcast(void *buf, MPI_Count count, MPI_Datatype type, int root, MPI_Comm comm, MPI_Request *request);
+int large_iallgather(const void *sendbuf, MPI_Count count, MPI_Datatype type, void *recvbuf, MPI_Comm comm,
+        MPI_Request *request);
+
+/* persistent requests; without MPI-4, counts are limited to INT_MAX and the persistent collectives
+ * are only available with the MPIX extension of Open MPI (pcollreq), otherwise the program exits */
+int large_send_init(const void *buf, MPI_Count count, MPI_Datatype type, int dest, int tag, MPI_Comm comm,
+        MPI_Request *request);
+int large_recv_init(void *buf, MPI_Count count, MPI_Datatype type, int source, int tag, MPI_Comm comm,
+        MPI_Request *request);
+int large_bcast_init(void *buf, MPI_Count count, MPI_Datatype type, int root, MPI_Comm comm, MPI_Request *request);
+int large_allgather_init(const void *sendbuf, MPI_Count count, MPI_Datatype type, void *recvbuf, MPI_Comm comm,
+        MPI_Request *request);
+
+/* derived datatype constructors: the regular constructors while all counts, block lengths and strides
+ * fit into an int, the MPI-4 large-count constructors beyond (without MPI-4, the program exits) */
+int large_type_contiguous(MPI_Count count, MPI_Datatype type, MPI_Datatype *newtype);
+int large_type_vector(MPI_Count count, MPI_Count blocklength, MPI_Count stride, MPI_Datatype type,
+        MPI_Datatype *newtype);
+int large_type_create_hvector(MPI_Count count, MPI_Count blocklength, MPI_Aint stride, MPI_Datatype type,
+        MPI_Datatype *newtype);
+// displacements in bytes
+int large_type_create_hindexed(MPI_Count count, const int *blocklengths, const MPI_Aint *displs,
+        MPI_Datatype type, MPI_Datatype *newtype);
+int large_type_create_hindexed_block(MPI_Count count, MPI_Count blocklength, const MPI_Aint *displs,
+        MPI_Datatype type, MPI_Datatype *newtype);
+
+#endif /* LARGE_COUNT_H_ */
@@ -0,0 +1,535 @@
+/*  MPI-Datatybe - MPI Datatype Benchmark
+ *  
+ *  Copyright 2017 Alexandra Carpen-Amarie, Sascha Hunold, Jesper Larsson Träff
+ *      Research Group for Parallel Computing
+ *      Faculty of Informatics
+ *      Vienna University of Technology, Austria
+ *  
+ *  <license>
+ *      This program is free software: you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation, either version 2 of the License, or
+ *      (at your option) any later version.
+ *  
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *  
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *  </license>
+ */
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+#include <mpi.h>
+
+#include "layout_expr.h"
+#include "dictionary/dictionary_helpers.h"
+
+#define MAX_IDENTIFIER_LENGTH 64
+
+typedef struct expr_parser {
+    const char *text;           // the whole expression (for error messages)
+    const char *pos;            // next character to parse
+    const dictionary_t *dict;   // values of the variables
+} expr_parser_t;
+
+typedef struct expr_list {
+    long long *values;
+    int n;
+} expr_list_t;
+
+typedef struct type_list {
+    MPI_Datatype *types;
+    int n;
+} type_list_t;
+
+static const char* constructor_names[] = {
+    "contig", "vector", "hvector", "indexed", "hindexed",
+    "indexed_block", "hindexed_block", "struct", "resized",
+    "size", "extent"
+};
+
+static const int N_CONSTRUCTORS = sizeof(constructor_names) / sizeof(constructor_names[0]);
+
+
+static MPI_Datatype parse_type(expr_parser_t *p);
+static long long parse_int_expr(expr_parser_t *p);
+
+
+static void parse_error(const expr_parser_t *p, const char *msg) {
+    printf("Error: %s at position %ld of layout expression \"%s\"\n", msg, (long)(p->pos - p->text), p->text);
+    exit(1);
+}
+
+
+static void skip_spaces(expr_parser_t *p) {
+    while (isspace((unsigned char)*p->pos)) {
+        p->pos++;
+    }
+}
+
+
+static int accept(expr_parser_t *p, char c) {
+    skip_spaces(p);
+    if (*p->pos == c) {
+        p->pos++;
+        return 1;
+    }
+    return 0;
+}
+
+
+static void expect(expr_parser_t *p, char c) {
+    char msg[32];
+
+    if (!accept(p, c)) {
+        sprintf(msg, "expected '%c'", c);
+        parse_error(p, msg);
+    }
+}
+
+
+static int is_identifier_start(char c) {
+    return isalpha((unsigned char)c) || c == '_';
+}
+
+
+static void parse_identifier(expr_parser_t *p, char *name) {
+    int len = 0;
+
+    skip_spaces(p);
+    if (!is_identifier_start(*p->pos)) {
+        parse_error(p, "expected an identifier");
+    }
+    while (isalnum((unsigned char)*p->pos) || *p->pos == '_') {
+        if (len == MAX_IDENTIFIER_LENGTH - 1) {
+            parse_error(p, "identifier too long");
+        }
+        name[len++] = *p->pos;
+        p->pos++;
+    }
+    name[len] = '\0';
+}
+
+
+static int to_count(expr_parser_t *p, long long value) {
+    if (value < 0 || value > INT_MAX) {
+        parse_error(p, "count out of range");
+    }
+    return (int)value;
+}
+
+
+// displacements of the int-based constructors may be negative
+static int to_displacement(expr_parser_t *p, long long value) {
+    if (value < INT_MIN || value > INT_MAX) {
+        parse_error(p, "displacement out of range");
+    }
+    return (int)value;
+}
+
+
+static int is_predefined(MPI_Datatype t) {
+    int nints, naddrs, ntypes, combiner;
+
+    MPI_Type_get_envelope(t, &nints, &naddrs, &ntypes, &combiner);
+    return combiner == MPI_COMBINER_NAMED;
+}
+
+
+// intermediate types are freed as soon as the enclosing type is created
+static void free_derived_type(MPI_Datatype *t) {
+    if (!is_predefined(*t)) {
+        MPI_Type_free(t);
+    }
+}
+
+
+// [e1, e2, ...]
+static void parse_int_list(expr_parser_t *p, expr_list_t *list) {
+    int max = 16;
+
+    list->n = 0;
+    list->values = (long long*)malloc(max * sizeof(long long));
+    expect(p, '[');
+    if (accept(p, ']')) {
+        return;
+    }
+    do {
+        if (list->n == max) {
+            max *= 2;
+            list->values = (long long*)realloc(list->values, max * sizeof(long long));
+        }
+        list->values[list->n++] = parse_int_expr(p);
+    } while (accept(p, ','));
+    expect(p, ']');
+}
+
+
+// [T1, T2, ...]
+static void parse_type_list(expr_parser_t *p, type_list_t *list) {
+    int max = 4;
+
+    list->n = 0;
+    list->types = (MPI_Datatype*)malloc(max * sizeof(MPI_Datatype));
+    expect(p, '[');
+    do {
+        if (list->n == max) {
+            max *= 2;
+            list->types = (MPI_Datatype*)realloc(list->types, max * sizeof(MPI_Datatype));
+        }
+        list->types[list->n++] = parse_type(p);
+    } while (accept(p, ','));
+    expect(p, ']');
+}
+
+
+static int* to_count_array(expr_parser_t *p, const expr_list_t *list) {
+    int *counts;
+    int i;
+
+    counts = (int*)malloc((list->n + 1) * sizeof(int));
+    for (i=0; i<list->n; i++) {
+        counts[i] = to_count(p, list->values[i]);
+    }
+    return counts;
+}
+
+
+static int* to_displacement_array(expr_parser_t *p, const expr_list_t *list) {
+    int *index;
+    int i;
+
+    index = (int*)malloc((list->n + 1) * sizeof(int));
+    for (i=0; i<list->n; i++) {
+        index[i] = to_displacement(p, list->values[i]);
+    }
+    return index;
+}
+
+
+static MPI_Aint* to_aint_array(const expr_list_t *list) {
+    MPI_Aint *displs;
+    int i;
+
+    displs = (MPI_Aint*)malloc((list->n + 1) * sizeof(MPI_Aint));
+    for (i=0; i<list->n; i++) {
+        displs[i] = (MPI_Aint)list->values[i];
+    }
+    return displs;
+}
+
+
+static void check_lengths(expr_parser_t *p, int n1, int n2) {
+    if (n1 != n2) {
+        parse_error(p, "lists of different lengths");
+    }
+}
+
+
+static long long multiply(expr_parser_t *p, long long a, long long b) {
+    int overflow;
+
+    if (a == 0 || b == 0) {
+        return 0;
+    }
+    if (a > 0) {
+        overflow = (b > 0) ? (a > LLONG_MAX / b) : (b < LLONG_MIN / a);
+    } else {
+        overflow = (b > 0) ? (a < LLONG_MIN / b) : (b < LLONG_MAX / a);
+    }
+    if (overflow) {
+        parse_error(p, "product out of range");
+    }
+    return a * b;
+}
+
+
+// factor := number | variable | size(T) | extent(T) | '(' expr ')' | '-' factor
+static long long parse_factor(expr_parser_t *p) {
+    char name[MAX_IDENTIFIER_LENGTH];
+    long long value;
+    char *end;
+    MPI_Datatype t;
+    MPI_Aint lb, extent;
+    MPI_Count size;
+
+    skip_spaces(p);
+    if (accept(p, '(')) {
+        value = parse_int_expr(p);
+        expect(p, ')');
+    } else if (accept(p, '-')) {
+        value = -parse_factor(p);
+    } else if (isdigit((unsigned char)*p->pos)) {
+        errno = 0;
+        value = strtoll(p->pos, &end, 10);
+        if (errno == ERANGE) {
+            parse_error(p, "number out of range");
+        }
+        p->pos = end;
+    } else {
+        parse_identifier(p, name);
+        if (strcmp(name, "size") == 0 || strcmp(name, "extent") == 0) {
+            expect(p, '(');
+            t = parse_type(p);
+            expect(p, ')');
+            if (strcmp(name, "size") == 0) {
+                MPI_Type_size_x(t, &size);
+                value = size;
+            } else {
+                MPI_Type_get_extent(t, &lb, &extent);
+                value = extent;
+            }
+            free_derived_type(&t);
+        } else {
+            value = get_long_value_from_dict(name, p->dict);
+        }
+    }
+    return value;
+}
+
+
+// term := factor { ('*' | '/' | '%') factor }
+static long long parse_term(expr_parser_t *p) {
+    long long value, rhs;
+    char op;
+
+    value = parse_factor(p);
+    while (1) {
+        skip_spaces(p);
+        op = *p->pos;
+        if (op != '*' && op != '/' && op != '%') {
+            break;
+        }
+        p->pos++;
+        rhs = parse_factor(p);
+        if (op == '*') {
+            value = multiply(p, value, rhs);
+        } else if (rhs == 0) {
+            parse_error(p, "division by zero");
+        } else if (op == '/') {
+            value /= rhs;
+        } else {
+            value %= rhs;
+        }
+    }
+    return value;
+}
+
+
+// expr := term { ('+' | '-') term }
+static long long parse_int_expr(expr_parser_t *p) {
+    long long value;
+
+    value = parse_term(p);
+    while (1) {
+        if (accept(p, '+')) {
+            value += parse_term(p);
+        } else if (accept(p, '-')) {
+            value -= parse_term(p);
+        } else {
+            break;
+        }
+    }
+    return value;
+}
+
+
+static MPI_Datatype parse_constructor(expr_parser_t *p, const char *name) {
+    MPI_Datatype t, old;
+    expr_list_t blocks, displs;
+    type_list_t types;
+    int *counts;
+    MPI_Aint *addrs;
+    long long count, blocklength, stride, lb, extent;
+    int i;
+
+    expect(p, '(');
+    if (strcmp(name, "contig") == 0) {
+        count = parse_int_expr(p);
+        expect(p, ',');
+        old = parse_type(p);
+        MPI_Type_contiguous(to_count(p, count), old, &t);
+        free_derived_type(&old);
+    } else if (strcmp(name, "vector") == 0 || strcmp(name, "hvector") == 0) {
+        count = parse_int_expr(p);
+        expect(p, ',');
+        blocklength = parse_int_expr(p);
+        expect(p, ',');
+        stride = parse_int_expr(p);
+        expect(p, ',');
+        old = parse_type(p);
+        if (name[0] == 'h') {
+            MPI_Type_create_hvector(to_count(p, count), to_count(p, blocklength), (MPI_Aint)stride, old, &t);
+        } else {
+            if (stride < INT_MIN || stride > INT_MAX) {
+                parse_error(p, "stride out of range");
+            }
+            MPI_Type_vector(to_count(p, count), to_count(p, blocklength), (int)stride, old, &t);
+        }
+        free_derived_type(&old);
+    } else if (strcmp(name, "indexed") == 0 || strcmp(name, "hindexed") == 0) {
+        parse_int_list(p, &blocks);
+        expect(p, ',');
+        parse_int_list(p, &displs);
+        expect(p, ',');
+        old = parse_type(p);
+        check_lengths(p, blocks.n, displs.n);
+        counts = to_count_array(p, &blocks);
+        if (name[0] == 'h') {
+            addrs = to_aint_array(&displs);
+            MPI_Type_create_hindexed(blocks.n, counts, addrs, old, &t);
+            free(addrs);
+        } else {
+            int *index = to_displacement_array(p, &displs);
+            MPI_Type_indexed(blocks.n, counts, index, old, &t);
+            free(index);
+        }
+        free(counts);
+        free(blocks.values);
+        free(displs.values);
+        free_derived_type(&old);
+    } else if (strcmp(name, "indexed_block") == 0 || strcmp(name, "hindexed_block") == 0) {
+        blocklength = parse_int_expr(p);
+        expect(p, ',');
+        parse_int_list(p, &displs);
+        expect(p, ',');
+        old = parse_type(p);
+        if (name[0] == 'h') {
+            addrs = to_aint_array(&displs);
+            MPI_Type_create_hindexed_block(displs.n, to_count(p, blocklength), addrs, old, &t);
+            free(addrs);
+        } else {
+            int *index = to_displacement_array(p, &displs);
+            MPI_Type_create_indexed_block(displs.n, to_count(p, blocklength), index, old, &t);
+            free(index);
+        }
+        free(displs.values);
+        free_derived_type(&old);
+    } else if (strcmp(name, "struct") == 0) {
+        parse_int_list(p, &blocks);
+        expect(p, ',');
+        parse_int_list(p, &displs);
+        expect(p, ',');
+        parse_type_list(p, &types);
+        check_lengths(p, blocks.n, displs.n);
+        check_lengths(p, blocks.n, types.n);
+        counts = to_count_array(p, &blocks);
+        addrs = to_aint_array(&displs);
+        MPI_Type_create_struct(blocks.n, counts, addrs, types.types, &t);
+        for (i=0; i<types.n; i++) {
+            free_derived_type(&types.types[i]);
+        }
+        free(counts);
+        free(addrs);
+        free(blocks.values);
+        free(displs.values);
+        free(types.types);
+    } else if (strcmp(name, "resized") == 0) {
+        old = parse_type(p);
+        expect(p, ',');
+        lb = parse_int_expr(p);
+        expect(p, ',');
+        extent = parse_int_expr(p);
+        MPI_Type_create_resized(old, (MPI_Aint)lb, (MPI_Aint)extent, &t);
+        free_derived_type(&old);
+    } else {
+        parse_error(p, "unknown type constructor");
+        t = MPI_DATATYPE_NULL;
+    }
+    expect(p, ')');
+    return t;
+}
+
+
+// type := basetype | b | constructor '(' args ')'
+static MPI_Datatype parse_type(expr_parser_t *p) {
+    char name[MAX_IDENTIFIER_LENGTH];
+
+    parse_identifier(p, name);
+    if (strncmp(name, "MPI_", 4) == 0) {
+        return to_basetype(name);
+    }
+    if (strcmp(name, "b") == 0) {
+        return get_basetype_value_from_dict("b", p->dict);
+    }
+    return parse_constructor(p, name);
+}
+
+
+void create_layout_expr_datatype(const char *expr, const dictionary_t *dict, MPI_Datatype *t) {
+    expr_parser_t p;
+    MPI_Datatype result;
+    MPI_Aint lb, extent, true_lb, true_extent;
+
+    p.text = expr;
+    p.pos = expr;
+    p.dict = dict;
+
+    result = parse_type(&p);
+    skip_spaces(&p);
+    if (*p.pos != '\0') {
+        parse_error(&p, "unexpected characters");
+    }
+
+    // displacements may be negative, but the benchmark buffers hold the instances of
+    // the type at multiples of its extent, starting at the origin
+    MPI_Type_get_extent(result, &lb, &extent);
+    MPI_Type_get_true_extent(result, &true_lb, &true_extent);
+    if (true_lb < 0 || true_lb + true_extent > extent) {
+        printf("Error: layout expression \"%s\" has data outside [0,%ld) (use resized(T,0,extent))\n",
+            expr, (long)extent);
+        exit(1);
+    }
+
+    // the benchmark frees the created type, thus predefined types are wrapped
+    if (is_predefined(result)) {
+        MPI_Type_contiguous(1, result, t);
+    } else {
+        *t = result;
+    }
+}
+
+
+void copy_layout_expr_variables(const char *expr, const dictionary_t *dict, dictionary_t *typedict) {
+    char name[MAX_IDENTIFIER_LENGTH];
+    const char *pos = expr;
+    char *value;
+    int len, i, ret;
+
+    while (*pos != '\0') {
+        if (!is_identifier_start(*pos) || (pos > expr && (isalnum((unsigned char)pos[-1]) || pos[-1] == '_'))) {
+            pos++;
+            continue;
+        }
+        len = 0;
+        while ((isalnum((unsigned char)*pos) || *pos == '_') && len < MAX_IDENTIFIER_LENGTH - 1) {
+            name[len++] = *pos++;
+        }
+        name[len] = '\0';
+
+        for (i=0; i<N_CONSTRUCTORS; i++) {
+            if (strcmp(name, constructor_names[i]) == 0) {
+                break;
+            }
+        }
+        if (i < N_CONSTRUCTORS || strncmp(name, "MPI_", 4) == 0) {
+            continue;
+        }
+        // keep the entries already set for the type (e.g. n)
+        ret = get_value_from_dict(typedict, name, &value);
+        if (ret == 0) {
+            free(value);
+            continue;
+        }
+        copy_dict_entry(name, dict, typedict);
+    }
+}
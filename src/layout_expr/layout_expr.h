@@ -0,0 +1,52 @@
+/*  MPI-Datatybe - MPI Datatype Benchmark
+ *  
+ *  Copyright 2017 Alexandra Carpen-Amarie, Sascha Hunold, Jesper Larsson Träff
+ *      Research Group for Parallel Computing
+ *      Faculty of Informatics
+ *      Vienna University of Technology, Austria
+ *  
+ *  <license>
+ *      This program is free software: you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation, either version 2 of the License, or
+ *      (at your option) any later version.
+ *  
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *  
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *  </license>
+ */
+
+
+#ifndef LAYOUT_EXPR_H_
+#define LAYOUT_EXPR_H_
+
+#include <mpi.h>
+#include "dictionary/keyvalue_store.h"
+
+/* textual description of (nested) derived datatypes, e.g.
+ *   vector(n/8, 2, 5, struct([1,2], [0,16], [MPI_INT,contig(4,b)]))
+ *
+ * type constructors (displacements and strides of the h-variants, lb and extent in bytes):
+ *   contig(count, T)
+ *   vector(count, blocklength, stride, T)          hvector(count, blocklength, stride, T)
+ *   indexed([blocklengths], [displs], T)           hindexed([blocklengths], [displs], T)
+ *   indexed_block(blocklength, [displs], T)        hindexed_block(blocklength, [displs], T)
+ *   struct([blocklengths], [displs], [types])
+ *   resized(T, lb, extent)
+ * base types are MPI_CHAR, MPI_INT, ... or b (the basetype parameter);
+ * integers are expressions with + - * / % and parentheses over constants,
+ * dictionary keys (e.g. n) and the functions size(T) and extent(T);
+ * displacements may be negative, but all data of the whole type must lie in [0, extent) */
+
+// builds the (not committed) datatype described by expr
+void create_layout_expr_datatype(const char *expr, const dictionary_t *dict, MPI_Datatype *t);
+
+// copies all dictionary keys used as variables in expr from dict into typedict
+void copy_layout_expr_variables(const char *expr, const dictionary_t *dict, dictionary_t *typedict);
+
+#endif /* LAYOUT_EXPR_H_ */
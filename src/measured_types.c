@@ -0,0 +1,212 @@
+/*  MPI-Datatybe - MPI Datatype Benchmark
+ *  
+ *  Copyright 2017 Alexandra Carpen-Amarie, Sascha Hunold, Jesper Larsson Träff
+ *      Research Group for Parallel Computing
+ *      Faculty of Informatics
+ *      Vienna University of Technology, Austria
+ *  
+ *  <license>
+ *      This program is free software: you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation, either version 2 of the License, or
+ *      (at your option) any later version.
+ *  
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *  
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *  </license>
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <assert.h>
+#include <mpi.h>
+
+#include "measured_types.h"
+#include "perftypes.h"
+#include "typemap/typemap.h"
+
+typedef struct measured_types {
+    char* path;                 // NULL if not enabled
+    uint64_t context;
+    uint64_t* fingerprints;
+    int n_fingerprints;
+    int max_fingerprints;
+} measured_types_t;
+
+static measured_types_t measured = { NULL, 0, NULL, 0, 0 };
+
+// parameters that select or describe the datatype and the message sizes
+static const char* IGNORED_KEYS[] = { "layout", "b", "nbytes_list", "skip_measured", "typemap_export" };
+static const int N_IGNORED_KEYS = sizeof(IGNORED_KEYS) / sizeof(IGNORED_KEYS[0]);
+
+
+static uint64_t hash_string(uint64_t h, const char* s) {
+    // FNV-1a, terminated by the 0 byte
+    do {
+        h ^= (unsigned char)*s;
+        h *= 1099511628211ULL;
+    } while (*s++ != '\0');
+    return h;
+}
+
+
+static int is_layout_key(const pattern_config_t conf, const dictionary_t *typedict, const char* key) {
+    char* value;
+    int i;
+
+    for (i = 0; i < N_IGNORED_KEYS; i++) {
+        if (strcmp(key, IGNORED_KEYS[i]) == 0) {
+            return 1;
+        }
+    }
+    if (typedict != NULL) {
+        if (get_value_from_dict(typedict, key, &value) == 0 && value != NULL) {
+            free(value);
+            return 1;
+        }
+        return 0;
+    }
+    for (i = 0; i < conf.nb_params; i++) {
+        if (strcmp(key, conf.dt_parameters[i]) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+// hash of the number of processes and of the parameters that do not describe the datatype
+static uint64_t get_context_hash(const pattern_config_t conf, const dictionary_t *dict) {
+    dictionary_t typedict;
+    entry_t *pair;
+    char nprocs[32];
+    uint64_t h;
+    int size, i;
+
+    // the parameters of a dynamic layout are the keys of its type dictionary (independent of nbytes)
+    if (conf.type_info == dynamic) {
+        init_dynamic_type_dict(conf, dict, 0, &typedict);
+    }
+
+    MPI_Comm_size(conf.comm, &size);
+    sprintf(nprocs, "%d", size);
+    h = hash_string(14695981039346656037ULL, "nprocs");
+    h = hash_string(h, nprocs);
+
+    // the order of the dictionary only depends on its keys
+    for (i = 0; i < dict->size; i++) {
+        for (pair = dict->table[i]; pair != NULL; pair = pair->next) {
+            if (!is_layout_key(conf, (conf.type_info == dynamic) ? &typedict : NULL, pair->key)) {
+                h = hash_string(h, pair->key);
+                h = hash_string(h, pair->value);
+            }
+        }
+    }
+
+    if (conf.type_info == dynamic) {
+        cleanup_dictionary(&typedict);
+    }
+    return h;
+}
+
+
+static void add_fingerprint(uint64_t fingerprint) {
+    if (measured.n_fingerprints == measured.max_fingerprints) {
+        measured.max_fingerprints = (measured.max_fingerprints > 0) ? 2 * measured.max_fingerprints : 64;
+        measured.fingerprints = (uint64_t*)realloc(measured.fingerprints, measured.max_fingerprints * sizeof(uint64_t));
+        assert(measured.fingerprints != NULL);
+    }
+    measured.fingerprints[measured.n_fingerprints++] = fingerprint;
+}
+
+
+void init_measured_types(const pattern_config_t conf, const dictionary_t *dict, const char* path) {
+    FILE *f;
+    uint64_t context, fingerprint;
+    int rank, n;
+
+    MPI_Comm_rank(conf.comm, &rank);
+
+    measured.path = strdup(path);
+    measured.context = get_context_hash(conf, dict);
+    measured.n_fingerprints = 0;
+
+    // file lines: <context> <fingerprint> (hexadecimal)
+    if (rank == conf.root_proc) {
+        f = fopen(path, "r");
+        if (f != NULL) {
+            while (fscanf(f, "%" SCNx64 " %" SCNx64, &context, &fingerprint) == 2) {
+                if (context == measured.context) {
+                    add_fingerprint(fingerprint);
+                }
+            }
+            fclose(f);
+        }
+    }
+
+    n = measured.n_fingerprints;
+    MPI_Bcast(&n, 1, MPI_INT, conf.root_proc, conf.comm);
+    if (rank != conf.root_proc) {
+        measured.fingerprints = (uint64_t*)malloc(((n > 0) ? n : 1) * sizeof(uint64_t));
+        assert(measured.fingerprints != NULL);
+        measured.n_fingerprints = measured.max_fingerprints = n;
+    }
+    if (n > 0) {
+        MPI_Bcast(measured.fingerprints, n, MPI_UINT64_T, conf.root_proc, conf.comm);
+    }
+}
+
+
+int skip_measured_type(const pattern_config_t conf, MPI_Datatype type, int count) {
+    FILE *f;
+    uint64_t fingerprint;
+    int rank, i;
+
+    if (measured.path == NULL) {
+        return 0;
+    }
+
+    // the types of the processes may differ (e.g., darray_block), the root decides for all
+    fingerprint = get_typemap_fingerprint(type, count);
+    MPI_Bcast(&fingerprint, 1, MPI_UINT64_T, conf.root_proc, conf.comm);
+    MPI_Comm_rank(conf.comm, &rank);
+
+    for (i = 0; i < measured.n_fingerprints; i++) {
+        if (measured.fingerprints[i] == fingerprint) {
+            if (rank == conf.root_proc) {
+                fprintf(stderr, "WARNING: typemap of %d instances already measured (fingerprint %016" PRIx64 ")...skipping case\n",
+                        count, fingerprint);
+            }
+            return 1;
+        }
+    }
+
+    add_fingerprint(fingerprint);
+    if (rank == conf.root_proc) {
+        f = fopen(measured.path, "a");
+        if (f == NULL) {
+            printf("\nError: cannot write to %s\n", measured.path);
+            exit(1);
+        }
+        fprintf(f, "%016" PRIx64 " %016" PRIx64 "\n", measured.context, fingerprint);
+        fclose(f);
+    }
+    return 0;
+}
+
+
+void cleanup_measured_types(void) {
+    free(measured.path);
+    free(measured.fingerprints);
+    measured.path = NULL;
+    measured.fingerprints = NULL;
+    measured.n_fingerprints = 0;
+    measured.max_fingerprints = 0;
+}
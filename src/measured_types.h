@@ -0,0 +1,47 @@
+/*  MPI-Datatybe - MPI Datatype Benchmark
+ *  
+ *  Copyright 2017 Alexandra Carpen-Amarie, Sascha Hunold, Jesper Larsson Träff
+ *      Research Group for Parallel Computing
+ *      Faculty of Informatics
+ *      Vienna University of Technology, Austria
+ *  
+ *  <license>
+ *      This program is free software: you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation, either version 2 of the License, or
+ *      (at your option) any later version.
+ *  
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *  
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *  </license>
+ */
+
+
+#ifndef MEASURED_TYPES_H_
+#define MEASURED_TYPES_H_
+
+#include <mpi.h>
+#include "datatypes_bench.h"
+#include "dictionary/keyvalue_store.h"
+
+/* record of the measured configurations of a sweep (parameter skip_measured):
+ * a configuration is identified by the run context (number of processes and all
+ * parameters except the layout, its parameters, the basetype and the message sizes)
+ * and the typemap fingerprint of the communicated datatype instances;
+ * the record is kept in a file that is read and extended by each run of the sweep */
+
+// reads the fingerprints recorded in path for the context of this run (root process, broadcast to all)
+void init_measured_types(const pattern_config_t conf, const dictionary_t *dict, const char *path);
+
+// returns 1 if count instances of type (of the root process) have already been measured in this context;
+// otherwise records them and returns 0 (always 0 if init_measured_types was not called); collective
+int skip_measured_type(const pattern_config_t conf, MPI_Datatype type, int count);
+
+void cleanup_measured_types(void);
+
+#endif /* MEASURED_TYPES_H_ */
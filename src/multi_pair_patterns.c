@@ -0,0 +1,475 @@
+/*  MPI-Datatybe - MPI Datatype Benchmark
+ *  
+ *  Copyright 2017 Alexandra Carpen-Amarie, Sascha Hunold, Jesper Larsson Träff
+ *      Research Group for Parallel Computing
+ *      Faculty of Informatics
+ *      Vienna University of Technology, Austria
+ *  
+ *  <license>
+ *      This program is free software: you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation, either version 2 of the License, or
+ *      (at your option) any later version.
+ *  
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *  
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *  </license>
+ */
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <mpi.h>
+
+#include "multi_pair_patterns.h"
+#include "comm_patterns.h"
+#include "util.h"
+#include "large_count.h"
+//@ add_includes
+
+//@ declare_variables
+
+
+#define TYPETAG 12345
+
+static const int CACHE_LINE_SIZE = 64;
+
+typedef enum PairingModes {
+    pairing_neighbor,
+    pairing_half_shift,
+    pairing_random
+} pairing_t;
+
+static const char* PAIRING_NAMES[] = { "neighbor", "half_shift", "random" };
+
+// the pairing of the multi_pingpong pattern (set up by the pattern functions)
+static pairing_t selected_pairing = pairing_neighbor;
+static int *partners = NULL;    // partner of each rank, -1 if idle
+
+
+typedef struct exchange_args {
+    int rank;
+    int size;
+    int partner;        // multi_pingpong
+    void *sendbuf;
+    void *recvbuf;
+    int c;
+    MPI_Datatype type;
+    void *packbuf;
+    void *recvpack;     // ring
+    MPI_Count packsize;
+    MPI_Comm comm;
+} exchange_args_t;
+
+
+// each process measures its own link (runtime_min: the fastest link, runtime: the slowest)
+static void ring_datatype(const exchange_args_t *args) {
+    int c = args->c;
+
+    //@ set test_type="datatype"
+
+    //@ initialize_timestamps t1
+    //@ initialize_timestamps t2
+
+    //@ start_measurement_loop
+
+    //@ start_sync
+    //@ measure_timestamp t1
+    MPI_Sendrecv(args->sendbuf, c, args->type, (args->rank + 1) % args->size, TYPETAG,
+            args->recvbuf, c, args->type, (args->rank + args->size - 1) % args->size, TYPETAG,
+            args->comm, MPI_STATUS_IGNORE);
+    //@ measure_timestamp t2
+    //@ stop_sync
+    //@stop_measurement_loop
+
+    //@ print_runtime_array name=runtime end_time=t2 start_time=t1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+    //@ print_runtime_array name=runtime_min end_time=t2 start_time=t1 type=reduce op=min nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+
+    //@cleanup_variables
+}
+
+
+// as ring_datatype, with MPI_Pack/MPI_Unpack
+static void ring_pack(const exchange_args_t *args) {
+    MPI_Count position;
+    int c = args->c;
+
+    //@ set test_type="pack"
+
+    //@ initialize_timestamps t1
+    //@ initialize_timestamps t2
+    //@ initialize_timestamps tp1
+    //@ initialize_timestamps tp2
+    //@ initialize_timestamps tc1
+    //@ initialize_timestamps tc2
+    //@ initialize_timestamps tu1
+    //@ initialize_timestamps tu2
+
+    //@ start_measurement_loop
+
+    //@ start_sync
+    position = 0;
+    //@ measure_timestamp t1
+    //@ measure_timestamp tp1
+    large_pack(args->sendbuf, c, args->type, args->packbuf, args->packsize, &position, args->comm);
+    //@ measure_timestamp tp2
+    //@ measure_timestamp tc1
+    large_sendrecv(args->packbuf, args->packsize, MPI_PACKED, (args->rank + 1) % args->size, TYPETAG,
+            args->recvpack, args->packsize, MPI_PACKED, (args->rank + args->size - 1) % args->size, TYPETAG,
+            args->comm);
+    //@ measure_timestamp tc2
+    position = 0;
+    //@ measure_timestamp tu1
+    large_unpack(args->recvpack, args->packsize, &position, args->recvbuf, c, args->type, args->comm);
+    //@ measure_timestamp tu2
+    //@ measure_timestamp t2
+    //@ stop_sync
+    //@stop_measurement_loop
+
+    //@ print_runtime_array name=runtime end_time=t2 start_time=t1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+    //@ print_runtime_array name=runtime_min end_time=t2 start_time=t1 type=reduce op=min nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+    //@ print_runtime_array name=pack_time end_time=tp2 start_time=tp1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+    //@ print_runtime_array name=comm_time end_time=tc2 start_time=tc1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+    //@ print_runtime_array name=unpack_time end_time=tu2 start_time=tu1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+
+    //@cleanup_variables
+}
+
+
+// the round trip of each pair is timed on its lower rank (runtime: the slowest pair, runtime_min:
+// the fastest); the other processes time empty intervals for runtime and, for runtime_min, an
+// interval from before the synchronization to a barrier after all round trips, which contains the
+// round trip of every pair
+static void multi_pingpong_datatype(const exchange_args_t *args) {
+    int c = args->c;
+    int leader = (args->partner >= 0 && args->rank < args->partner);
+
+    //@ set test_type="datatype"
+
+    //@ initialize_timestamps t1
+    //@ initialize_timestamps t2
+    //@ initialize_timestamps tm1
+    //@ initialize_timestamps tm2
+
+    //@ start_measurement_loop
+
+    if (!leader) {
+        //@ measure_timestamp tm1
+    }
+    //@ start_sync
+    if (leader) {
+        //@ measure_timestamp t1
+        //@ measure_timestamp tm1
+        MPI_Send(args->sendbuf, c, args->type, args->partner, TYPETAG, args->comm);
+        MPI_Recv(args->recvbuf, c, args->type, args->partner, TYPETAG, args->comm, MPI_STATUS_IGNORE);
+        //@ measure_timestamp tm2
+        //@ measure_timestamp t2
+    } else {
+        //@ measure_timestamp t1
+        //@ measure_timestamp t2
+        if (args->partner >= 0) {
+            MPI_Recv(args->recvbuf, c, args->type, args->partner, TYPETAG, args->comm, MPI_STATUS_IGNORE);
+            MPI_Send(args->sendbuf, c, args->type, args->partner, TYPETAG, args->comm);
+        }
+    }
+    MPI_Barrier(args->comm);
+    if (!leader) {
+        //@ measure_timestamp tm2
+    }
+    //@ stop_sync
+    //@stop_measurement_loop
+
+    //@ print_runtime_array name=runtime end_time=t2 start_time=t1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+    //@ print_runtime_array name=runtime_min end_time=tm2 start_time=tm1 type=reduce op=min nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+
+    //@cleanup_variables
+}
+
+
+// as multi_pingpong_datatype, with MPI_Pack/MPI_Unpack; the phases are timed on the lower rank as
+// in the pingpong pattern, the unpack and pack on the higher rank are reported as peer_time
+static void multi_pingpong_pack(const exchange_args_t *args) {
+    MPI_Count position;
+    int c = args->c;
+    int leader = (args->partner >= 0 && args->rank < args->partner);
+
+    //@ set test_type="pack"
+
+    //@ initialize_timestamps t1
+    //@ initialize_timestamps t2
+    //@ initialize_timestamps tm1
+    //@ initialize_timestamps tm2
+    //@ initialize_timestamps tp1
+    //@ initialize_timestamps tp2
+    //@ initialize_timestamps tc1
+    //@ initialize_timestamps tc2
+    //@ initialize_timestamps tu1
+    //@ initialize_timestamps tu2
+    //@ initialize_timestamps tr1
+    //@ initialize_timestamps tr2
+
+    //@ start_measurement_loop
+
+    if (!leader) {
+        //@ measure_timestamp tm1
+    }
+    //@ start_sync
+    if (leader) {
+        position = 0;
+        //@ measure_timestamp t1
+        //@ measure_timestamp tm1
+        //@ measure_timestamp tp1
+        large_pack(args->sendbuf, c, args->type, args->packbuf, args->packsize, &position, args->comm);
+        //@ measure_timestamp tp2
+        //@ measure_timestamp tc1
+        large_send(args->packbuf, args->packsize, MPI_PACKED, args->partner, TYPETAG, args->comm);
+        large_recv(args->packbuf, args->packsize, MPI_PACKED, args->partner, TYPETAG, args->comm);
+        //@ measure_timestamp tc2
+        position = 0;
+        //@ measure_timestamp tu1
+        large_unpack(args->packbuf, args->packsize, &position, args->recvbuf, c, args->type, args->comm);
+        //@ measure_timestamp tu2
+        //@ measure_timestamp tm2
+        //@ measure_timestamp t2
+        //@ measure_timestamp tr1
+        //@ measure_timestamp tr2
+    } else if (args->partner >= 0) {
+        //@ measure_timestamp t1
+        //@ measure_timestamp t2
+        //@ measure_timestamp tp1
+        //@ measure_timestamp tp2
+        //@ measure_timestamp tc1
+        //@ measure_timestamp tc2
+        //@ measure_timestamp tu1
+        //@ measure_timestamp tu2
+        large_recv(args->packbuf, args->packsize, MPI_PACKED, args->partner, TYPETAG, args->comm);
+        //@ measure_timestamp tr1
+        position = 0;
+        large_unpack(args->packbuf, args->packsize, &position, args->recvbuf, c, args->type, args->comm);
+        position = 0;
+        large_pack(args->recvbuf, c, args->type, args->packbuf, args->packsize, &position, args->comm);
+        //@ measure_timestamp tr2
+        large_send(args->packbuf, args->packsize, MPI_PACKED, args->partner, TYPETAG, args->comm);
+    } else {
+        //@ measure_timestamp t1
+        //@ measure_timestamp t2
+        //@ measure_timestamp tp1
+        //@ measure_timestamp tp2
+        //@ measure_timestamp tc1
+        //@ measure_timestamp tc2
+        //@ measure_timestamp tu1
+        //@ measure_timestamp tu2
+        //@ measure_timestamp tr1
+        //@ measure_timestamp tr2
+    }
+    MPI_Barrier(args->comm);
+    if (!leader) {
+        //@ measure_timestamp tm2
+    }
+    //@ stop_sync
+    //@stop_measurement_loop
+
+    //@ print_runtime_array name=runtime end_time=t2 start_time=t1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+    //@ print_runtime_array name=runtime_min end_time=tm2 start_time=tm1 type=reduce op=min nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+    //@ print_runtime_array name=pack_time end_time=tp2 start_time=tp1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+    //@ print_runtime_array name=comm_time end_time=tc2 start_time=tc1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+    //@ print_runtime_array name=unpack_time end_time=tu2 start_time=tu1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+    //@ print_runtime_array name=peer_time end_time=tr2 start_time=tr1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+
+    //@cleanup_variables
+}
+
+
+static void run_exchange(pattern_config_t conf, int rank, void* sendbuf, void* recvbuf, int c,
+        MPI_Datatype type, int ring) {
+    exchange_args_t args;
+    char *npairs_str, *pair_bytes_str;
+    int npairs, r;
+    MPI_Count pair_bytes;
+
+    if (conf.test_type != test_datatype && conf.test_type != test_pack) {
+        printf("Error: the %s pattern only supports the test types datatype and pack\n", (ring) ? "ring" : "multi_pingpong");
+        exit(1);
+    }
+
+    // not to measure
+    args.rank = rank;
+    MPI_Comm_size(conf.comm, &args.size);
+    args.partner = (ring) ? -1 : partners[rank];
+    args.sendbuf = sendbuf;
+    args.recvbuf = recvbuf;
+    args.c = c;
+    args.type = type;
+    args.comm = conf.comm;
+    args.packbuf = NULL;
+    args.recvpack = NULL;
+    args.packsize = 0;
+    if (conf.test_type == test_pack) {
+        args.packsize = get_pack_size(c, type, conf.comm);
+        posix_memalign(&args.packbuf, CACHE_LINE_SIZE, args.packsize);
+        assert(args.packbuf!=NULL);
+        if (ring) {
+            posix_memalign(&args.recvpack, CACHE_LINE_SIZE, args.packsize);
+            assert(args.recvpack!=NULL);
+        }
+    }
+
+    // the throughput is derived from the measured runtime: a pair moves 2 messages per round trip,
+    // a ring link (one per process) 1 message
+    npairs = args.size;
+    if (!ring) {
+        npairs = 0;
+        for (r = 0; r < args.size; r++) {
+            if (partners[r] > r) {
+                npairs++;
+            }
+        }
+    }
+    pair_bytes = ((ring) ? 1 : 2) * (MPI_Count)c * get_type_size(type);
+    npairs_str = my_int_to_string(npairs);
+    pair_bytes_str = my_count_to_string(pair_bytes);
+
+    //@ set npairs=npairs_str
+    //@ set pair_bytes=pair_bytes_str
+
+    if (ring) {
+        if (conf.test_type == test_pack) {
+            ring_pack(&args);
+        } else {
+            ring_datatype(&args);
+        }
+    } else {
+        if (conf.test_type == test_pack) {
+            multi_pingpong_pack(&args);
+        } else {
+            multi_pingpong_datatype(&args);
+        }
+    }
+
+    free(npairs_str);
+    free(pair_bytes_str);
+    free(args.packbuf);
+    free(args.recvpack);
+}
+
+static void run_multi_pingpong(pattern_config_t conf, int rank, void* sendbuf, void* recvbuf, int c,
+        MPI_Datatype type) {
+    run_exchange(conf, rank, sendbuf, recvbuf, c, type, 0);
+}
+
+static void run_ring(pattern_config_t conf, int rank, void* sendbuf, void* recvbuf, int c,
+        MPI_Datatype type) {
+    run_exchange(conf, rank, sendbuf, recvbuf, c, type, 1);
+}
+
+
+// same xorshift64* generator as the random layouts: the same matching on all processes
+static unsigned long long next_pairing_random(unsigned long long *state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545F4914F6CDD1DULL;
+}
+
+
+static void init_pairing(const pattern_config_t conf, dictionary_t *dict) {
+    char *value;
+    int *perm;
+    unsigned long long state;
+    int size, half, r, j, tmp;
+
+    MPI_Comm_size(conf.comm, &size);
+
+    selected_pairing = pairing_neighbor;
+    if (get_value_from_dict(dict, "pairing", &value) == 0 && value != NULL) {
+        if (strcmp(value, "half_shift") == 0) {
+            selected_pairing = pairing_half_shift;
+        } else if (strcmp(value, "random") == 0) {
+            selected_pairing = pairing_random;
+        } else if (strcmp(value, "neighbor") != 0) {
+            printf("\nError: unknown value for \"pairing\": %s\n", value);
+            exit(1);
+        }
+        free(value);
+    }
+
+    // perm[2k] and perm[2k+1] form a pair
+    perm = (int*)malloc(size * sizeof(int));
+    assert(perm != NULL);
+    half = size / 2;
+    for (r = 0; r < size; r++) {
+        if (selected_pairing == pairing_half_shift) {
+            perm[r] = (r < 2*half) ? ((r % 2 == 0) ? r/2 : half + r/2) : r;
+        } else {
+            perm[r] = r;
+        }
+    }
+    if (selected_pairing == pairing_random) {
+        state = 1;
+        if (get_value_from_dict(dict, "pairing_seed", &value) == 0 && value != NULL) {
+            state = (unsigned long long)atoll(value);
+            free(value);
+        }
+        state = state * 0x9E3779B97F4A7C15ULL + 1;
+        // Fisher-Yates shuffle
+        for (r = size - 1; r > 0; r--) {
+            j = next_pairing_random(&state) % (r + 1);
+            tmp = perm[r];
+            perm[r] = perm[j];
+            perm[j] = tmp;
+        }
+    }
+
+    partners = (int*)malloc(size * sizeof(int));
+    assert(partners != NULL);
+    for (r = 0; r < size; r++) {
+        partners[perm[r]] = (r < 2*half) ? perm[r ^ 1] : -1;
+    }
+    free(perm);
+
+    //@ set pairing=PAIRING_NAMES[selected_pairing]
+}
+
+
+static void cleanup_pairing(void) {
+    free(partners);
+    partners = NULL;
+}
+
+
+int multi_pingpongpattern(pattern_config_t conf, dictionary_t *dict)
+{
+    int ret;
+
+    init_pairing(conf, dict);
+    ret = measure_basic_pattern(conf, dict, run_multi_pingpong, 1, 1);
+    cleanup_pairing();
+    return ret;
+}
+
+int ringpattern(pattern_config_t conf, dictionary_t *dict)
+{
+    return measure_basic_pattern(conf, dict, run_ring, 1, 1);
+}
+
+int multi_pingpongpattern_dynamictype(pattern_config_t conf, dictionary_t *dict)
+{
+    int ret;
+
+    init_pairing(conf, dict);
+    ret = measure_dynamic_pattern(conf, dict, run_multi_pingpong, 1, 1);
+    cleanup_pairing();
+    return ret;
+}
+
+int ringpattern_dynamictype(pattern_config_t conf, dictionary_t *dict)
+{
+    return measure_dynamic_pattern(conf, dict, run_ring, 1, 1);
+}
@@ -0,0 +1,47 @@
+/*  MPI-Datatybe - MPI Datatype Benchmark
+ *  
+ *  Copyright 2017 Alexandra Carpen-Amarie, Sascha Hunold, Jesper Larsson Träff
+ *      Research Group for Parallel Computing
+ *      Faculty of Informatics
+ *      Vienna University of Technology, Austria
+ *  
+ *  <license>
+ *      This program is free software: you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation, either version 2 of the License, or
+ *      (at your option) any later version.
+ *  
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *  
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *  </license>
+ */
+
+
+#ifndef MULTI_PAIR_PATTERNS_H_
+#define MULTI_PAIR_PATTERNS_H_
+
+#include "datatypes_bench.h"
+#include "dictionary/keyvalue_store.h"
+
+/* all processes communicate concurrently, test types datatype and pack:
+ * multi_pingpong - the ping-pong of comm_patterns.h between all pairs of processes, paired by the
+ *                  pairing parameter (neighbor: 2k and 2k+1, half_shift: k and k+size/2, random:
+ *                  random perfect matching drawn from pairing_seed); with an odd number of
+ *                  processes, one process is idle; the round trip is timed on the lower rank of
+ *                  each pair
+ * ring           - each process sends to rank+1 and receives from rank-1 with MPI_Sendrecv
+ * the run-times of the slowest (runtime) and the fastest pair or link (runtime_min), the number of
+ * pairs (ring: links) and the bytes a pair moves per repetition are reported, from which the
+ * throughput is derived */
+int multi_pingpongpattern(pattern_config_t conf, dictionary_t *dict);
+int ringpattern(pattern_config_t conf, dictionary_t *dict);
+
+int multi_pingpongpattern_dynamictype(pattern_config_t conf, dictionary_t *dict);
+int ringpattern_dynamictype(pattern_config_t conf, dictionary_t *dict);
+
+#endif /* MULTI_PAIR_PATTERNS_H_ */
@@ -0,0 +1,790 @@
+/*  MPI-Datatybe - MPI Datatype Benchmark
+ *  
+ *  Copyright 2017 Alexandra Carpen-Amarie, Sascha Hunold, Jesper Larsson Träff
+ *      Research Group for Parallel Computing
+ *      Faculty of Informatics
+ *      Vienna University of Technology, Austria
+ *  
+ *  <license>
+ *      This program is free software: you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation, either version 2 of the License, or
+ *      (at your option) any later version.
+ *  
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *  
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *  </license>
+ */
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <mpi.h>
+
+#include "nonblocking_patterns.h"
+#include "comm_patterns.h"
+#include "util.h"
+#include "large_count.h"
+//@ add_includes
+
+//@ declare_variables
+
+
+#define TYPETAG 12345
+#define ACKTAG 12346
+
+static const int PROC1 = 0;
+static const int PROC2 = 1;
+
+static const int CACHE_LINE_SIZE = 64;
+
+// repetitions (not measured) to calibrate the compute kernel
+static const int OVERLAP_CALIBRATION_NREP = 11;
+
+// messages in flight per repetition of the stream pattern (set by the pattern functions)
+static const int DEFAULT_STREAM_WINDOW = 64;
+static int stream_window = 1;
+
+
+typedef struct nonblocking_args {
+    int rank;
+    int size;
+    void *sendbuf;
+    void *recvbuf;
+    int c;
+    MPI_Datatype type;
+    MPI_Aint extent;
+    int root_proc;
+    MPI_Comm comm;
+    void *sendpack;     // packed buffers (test type pack)
+    void *recvpack;
+    MPI_Count packsize; // of one process
+    MPI_Request reqs[2];    // persistent requests, in the order they are started
+    int nreqs;
+    int window;             // stream pattern: messages per repetition (one packed buffer each)
+    MPI_Request *window_reqs;
+} nonblocking_args_t;
+
+// one repetition of a pattern, compute_iterations of the compute kernel before each wait
+typedef void (*nonblocking_round_t)(const nonblocking_args_t *args, long compute_iterations);
+
+// creates the persistent requests of a pattern
+typedef void (*persistent_init_t)(nonblocking_args_t *args);
+
+typedef struct nonblocking_pattern {
+    char* name;
+    nonblocking_round_t round[2];   // test types datatype and pack
+    persistent_init_t init[2];      // persistent patterns (NULL for the nonblocking patterns)
+    int ngaps;                      // waits per repetition of a participating process
+    int pairwise;                   // only PROC1 and PROC2 take part
+    int gather;                     // a packed unit of each process is received
+    int stream;                     // a window of messages from PROC1 to PROC2 per repetition
+} nonblocking_pattern_t;
+
+// measures the repetitions of a pattern (overlap mode or not)
+typedef void (*measure_t)(const pattern_config_t conf, const nonblocking_pattern_t *pattern,
+        nonblocking_round_t round, const nonblocking_args_t *args, const char* test_type);
+
+
+static void compute_and_wait(int n, MPI_Request *reqs, long compute_iterations) {
+    if (compute_iterations > 0) {
+        run_compute_kernel(compute_iterations);
+    }
+    MPI_Waitall(n, reqs, MPI_STATUSES_IGNORE);
+}
+
+
+static void ipingpong_datatype(const nonblocking_args_t *args, long compute_iterations) {
+    MPI_Request req;
+
+    if (args->rank == PROC1) {
+        MPI_Isend(args->sendbuf, args->c, args->type, PROC2, TYPETAG, args->comm, &req);
+        compute_and_wait(1, &req, compute_iterations);
+        MPI_Irecv(args->recvbuf, args->c, args->type, PROC2, TYPETAG, args->comm, &req);
+        compute_and_wait(1, &req, compute_iterations);
+    } else if (args->rank == PROC2) {
+        MPI_Irecv(args->recvbuf, args->c, args->type, PROC1, TYPETAG, args->comm, &req);
+        compute_and_wait(1, &req, compute_iterations);
+        MPI_Isend(args->sendbuf, args->c, args->type, PROC1, TYPETAG, args->comm, &req);
+        compute_and_wait(1, &req, compute_iterations);
+    }
+}
+
+
+static void ipingpong_pack(const nonblocking_args_t *args, long compute_iterations) {
+    MPI_Request req;
+    MPI_Count position;
+
+    if (args->rank == PROC1) {
+        position = 0;
+        large_pack(args->sendbuf, args->c, args->type, args->sendpack, args->packsize, &position, args->comm);
+        large_isend(args->sendpack, args->packsize, MPI_PACKED, PROC2, TYPETAG, args->comm, &req);
+        compute_and_wait(1, &req, compute_iterations);
+        large_irecv(args->recvpack, args->packsize, MPI_PACKED, PROC2, TYPETAG, args->comm, &req);
+        compute_and_wait(1, &req, compute_iterations);
+        position = 0;
+        large_unpack(args->recvpack, args->packsize, &position, args->recvbuf, args->c, args->type, args->comm);
+    } else if (args->rank == PROC2) {
+        large_irecv(args->recvpack, args->packsize, MPI_PACKED, PROC1, TYPETAG, args->comm, &req);
+        compute_and_wait(1, &req, compute_iterations);
+        position = 0;
+        large_unpack(args->recvpack, args->packsize, &position, args->recvbuf, args->c, args->type, args->comm);
+        position = 0;
+        large_pack(args->recvbuf, args->c, args->type, args->sendpack, args->packsize, &position, args->comm);
+        large_isend(args->sendpack, args->packsize, MPI_PACKED, PROC1, TYPETAG, args->comm, &req);
+        compute_and_wait(1, &req, compute_iterations);
+    }
+}
+
+
+static void ibcast_datatype(const nonblocking_args_t *args, long compute_iterations) {
+    MPI_Request req;
+
+    MPI_Ibcast(args->sendbuf, args->c, args->type, args->root_proc, args->comm, &req);
+    compute_and_wait(1, &req, compute_iterations);
+}
+
+
+static void ibcast_pack(const nonblocking_args_t *args, long compute_iterations) {
+    MPI_Request req;
+    MPI_Count position = 0;
+
+    if (args->rank == args->root_proc) {
+        large_pack(args->sendbuf, args->c, args->type, args->sendpack, args->packsize, &position, args->comm);
+    }
+    large_ibcast(args->sendpack, args->packsize, MPI_PACKED, args->root_proc, args->comm, &req);
+    compute_and_wait(1, &req, compute_iterations);
+    if (args->rank != args->root_proc) {
+        large_unpack(args->sendpack, args->packsize, &position, args->sendbuf, args->c, args->type, args->comm);
+    }
+}
+
+
+static void iallgather_datatype(const nonblocking_args_t *args, long compute_iterations) {
+    MPI_Request req;
+
+    MPI_Iallgather(args->sendbuf, args->c, args->type, args->recvbuf, args->c, args->type, args->comm, &req);
+    compute_and_wait(1, &req, compute_iterations);
+}
+
+
+static void iallgather_pack(const nonblocking_args_t *args, long compute_iterations) {
+    MPI_Request req;
+    MPI_Count position = 0;
+    int j;
+
+    large_pack(args->sendbuf, args->c, args->type, args->sendpack, args->packsize, &position, args->comm);
+    large_iallgather(args->sendpack, args->packsize, MPI_PACKED, args->recvpack, args->comm, &req);
+    compute_and_wait(1, &req, compute_iterations);
+    for (j = 0; j < args->size; j++) {
+        position = 0;
+        large_unpack((char*)args->recvpack + (size_t)j * args->packsize, args->packsize, &position,
+                (char*)args->recvbuf + (size_t)j * args->c * args->extent, args->c, args->type, args->comm);
+    }
+}
+
+
+/* stream: PROC1 keeps a window of messages in flight to PROC2, which acknowledges the whole
+ * window with an empty message (each message is received into its own buffer) */
+
+static void stream_datatype(const nonblocking_args_t *args, long compute_iterations) {
+    int w;
+
+    if (args->rank == PROC1) {
+        for (w = 0; w < args->window; w++) {
+            MPI_Isend(args->sendbuf, args->c, args->type, PROC2, TYPETAG, args->comm, &args->window_reqs[w]);
+        }
+        compute_and_wait(args->window, args->window_reqs, compute_iterations);
+        MPI_Recv(NULL, 0, MPI_BYTE, PROC2, ACKTAG, args->comm, MPI_STATUS_IGNORE);
+    } else if (args->rank == PROC2) {
+        for (w = 0; w < args->window; w++) {
+            MPI_Irecv((char*)args->recvbuf + (size_t)w * args->c * args->extent, args->c, args->type,
+                    PROC1, TYPETAG, args->comm, &args->window_reqs[w]);
+        }
+        compute_and_wait(args->window, args->window_reqs, compute_iterations);
+        MPI_Send(NULL, 0, MPI_BYTE, PROC1, ACKTAG, args->comm);
+    }
+}
+
+
+static void stream_pack(const nonblocking_args_t *args, long compute_iterations) {
+    MPI_Count position;
+    int w;
+
+    if (args->rank == PROC1) {
+        for (w = 0; w < args->window; w++) {
+            position = 0;
+            large_pack(args->sendbuf, args->c, args->type, (char*)args->sendpack + (size_t)w * args->packsize,
+                    args->packsize, &position, args->comm);
+            large_isend((char*)args->sendpack + (size_t)w * args->packsize, args->packsize, MPI_PACKED, PROC2,
+                    TYPETAG, args->comm, &args->window_reqs[w]);
+        }
+        compute_and_wait(args->window, args->window_reqs, compute_iterations);
+        MPI_Recv(NULL, 0, MPI_BYTE, PROC2, ACKTAG, args->comm, MPI_STATUS_IGNORE);
+    } else if (args->rank == PROC2) {
+        for (w = 0; w < args->window; w++) {
+            large_irecv((char*)args->recvpack + (size_t)w * args->packsize, args->packsize, MPI_PACKED, PROC1,
+                    TYPETAG, args->comm, &args->window_reqs[w]);
+        }
+        compute_and_wait(args->window, args->window_reqs, compute_iterations);
+        for (w = 0; w < args->window; w++) {
+            position = 0;
+            large_unpack((char*)args->recvpack + (size_t)w * args->packsize, args->packsize, &position,
+                    (char*)args->recvbuf + (size_t)w * args->c * args->extent, args->c, args->type, args->comm);
+        }
+        MPI_Send(NULL, 0, MPI_BYTE, PROC1, ACKTAG, args->comm);
+    }
+}
+
+
+/* persistent patterns: the requests are created once per size, each repetition starts them */
+
+static void pingpong_init_datatype(nonblocking_args_t *args) {
+    args->nreqs = 0;
+    if (args->rank == PROC1) {
+        MPI_Send_init(args->sendbuf, args->c, args->type, PROC2, TYPETAG, args->comm, &args->reqs[0]);
+        MPI_Recv_init(args->recvbuf, args->c, args->type, PROC2, TYPETAG, args->comm, &args->reqs[1]);
+        args->nreqs = 2;
+    } else if (args->rank == PROC2) {
+        MPI_Recv_init(args->recvbuf, args->c, args->type, PROC1, TYPETAG, args->comm, &args->reqs[0]);
+        MPI_Send_init(args->sendbuf, args->c, args->type, PROC1, TYPETAG, args->comm, &args->reqs[1]);
+        args->nreqs = 2;
+    }
+}
+
+
+static void pingpong_init_pack(nonblocking_args_t *args) {
+    args->nreqs = 0;
+    if (args->rank == PROC1) {
+        large_send_init(args->sendpack, args->packsize, MPI_PACKED, PROC2, TYPETAG, args->comm, &args->reqs[0]);
+        large_recv_init(args->recvpack, args->packsize, MPI_PACKED, PROC2, TYPETAG, args->comm, &args->reqs[1]);
+        args->nreqs = 2;
+    } else if (args->rank == PROC2) {
+        large_recv_init(args->recvpack, args->packsize, MPI_PACKED, PROC1, TYPETAG, args->comm, &args->reqs[0]);
+        large_send_init(args->sendpack, args->packsize, MPI_PACKED, PROC1, TYPETAG, args->comm, &args->reqs[1]);
+        args->nreqs = 2;
+    }
+}
+
+
+static void pingpong_start_datatype(const nonblocking_args_t *args, long compute_iterations) {
+    MPI_Request req;
+
+    if (args->nreqs > 0) {
+        req = args->reqs[0];
+        MPI_Start(&req);
+        compute_and_wait(1, &req, compute_iterations);
+        req = args->reqs[1];
+        MPI_Start(&req);
+        compute_and_wait(1, &req, compute_iterations);
+    }
+}
+
+
+static void pingpong_start_pack(const nonblocking_args_t *args, long compute_iterations) {
+    MPI_Request req;
+    MPI_Count position;
+
+    if (args->rank == PROC1) {
+        position = 0;
+        large_pack(args->sendbuf, args->c, args->type, args->sendpack, args->packsize, &position, args->comm);
+        req = args->reqs[0];
+        MPI_Start(&req);
+        compute_and_wait(1, &req, compute_iterations);
+        req = args->reqs[1];
+        MPI_Start(&req);
+        compute_and_wait(1, &req, compute_iterations);
+        position = 0;
+        large_unpack(args->recvpack, args->packsize, &position, args->recvbuf, args->c, args->type, args->comm);
+    } else if (args->rank == PROC2) {
+        req = args->reqs[0];
+        MPI_Start(&req);
+        compute_and_wait(1, &req, compute_iterations);
+        position = 0;
+        large_unpack(args->recvpack, args->packsize, &position, args->recvbuf, args->c, args->type, args->comm);
+        position = 0;
+        large_pack(args->recvbuf, args->c, args->type, args->sendpack, args->packsize, &position, args->comm);
+        req = args->reqs[1];
+        MPI_Start(&req);
+        compute_and_wait(1, &req, compute_iterations);
+    }
+}
+
+
+static void bcast_init_datatype(nonblocking_args_t *args) {
+    large_bcast_init(args->sendbuf, args->c, args->type, args->root_proc, args->comm, &args->reqs[0]);
+    args->nreqs = 1;
+}
+
+
+static void bcast_init_pack(nonblocking_args_t *args) {
+    large_bcast_init(args->sendpack, args->packsize, MPI_PACKED, args->root_proc, args->comm, &args->reqs[0]);
+    args->nreqs = 1;
+}
+
+
+// (the handles of persistent requests stay valid when they complete, the copies are started and completed)
+static void collective_start_datatype(const nonblocking_args_t *args, long compute_iterations) {
+    MPI_Request req = args->reqs[0];
+
+    MPI_Start(&req);
+    compute_and_wait(1, &req, compute_iterations);
+}
+
+
+static void bcast_start_pack(const nonblocking_args_t *args, long compute_iterations) {
+    MPI_Request req = args->reqs[0];
+    MPI_Count position = 0;
+
+    if (args->rank == args->root_proc) {
+        large_pack(args->sendbuf, args->c, args->type, args->sendpack, args->packsize, &position, args->comm);
+    }
+    MPI_Start(&req);
+    compute_and_wait(1, &req, compute_iterations);
+    if (args->rank != args->root_proc) {
+        large_unpack(args->sendpack, args->packsize, &position, args->sendbuf, args->c, args->type, args->comm);
+    }
+}
+
+
+static void allgather_init_datatype(nonblocking_args_t *args) {
+    large_allgather_init(args->sendbuf, args->c, args->type, args->recvbuf, args->comm, &args->reqs[0]);
+    args->nreqs = 1;
+}
+
+
+static void allgather_init_pack(nonblocking_args_t *args) {
+    large_allgather_init(args->sendpack, args->packsize, MPI_PACKED, args->recvpack, args->comm, &args->reqs[0]);
+    args->nreqs = 1;
+}
+
+
+static void allgather_start_pack(const nonblocking_args_t *args, long compute_iterations) {
+    MPI_Request req = args->reqs[0];
+    MPI_Count position = 0;
+    int j;
+
+    large_pack(args->sendbuf, args->c, args->type, args->sendpack, args->packsize, &position, args->comm);
+    MPI_Start(&req);
+    compute_and_wait(1, &req, compute_iterations);
+    for (j = 0; j < args->size; j++) {
+        position = 0;
+        large_unpack((char*)args->recvpack + (size_t)j * args->packsize, args->packsize, &position,
+                (char*)args->recvbuf + (size_t)j * args->c * args->extent, args->c, args->type, args->comm);
+    }
+}
+
+
+static void free_persistent_requests(nonblocking_args_t *args) {
+    int i;
+
+    for (i = 0; i < args->nreqs; i++) {
+        MPI_Request_free(&args->reqs[i]);
+    }
+    args->nreqs = 0;
+}
+
+
+static const nonblocking_pattern_t IPINGPONG = { "ipingpong", { ipingpong_datatype, ipingpong_pack },
+        { NULL, NULL }, 2, 1, 0, 0 };
+static const nonblocking_pattern_t IBCAST = { "ibcast", { ibcast_datatype, ibcast_pack },
+        { NULL, NULL }, 1, 0, 0, 0 };
+static const nonblocking_pattern_t IALLGATHER = { "iallgather", { iallgather_datatype, iallgather_pack },
+        { NULL, NULL }, 1, 0, 1, 0 };
+static const nonblocking_pattern_t PINGPONG_INIT = { "pingpong_init", { pingpong_start_datatype, pingpong_start_pack },
+        { pingpong_init_datatype, pingpong_init_pack }, 2, 1, 0, 0 };
+static const nonblocking_pattern_t BCAST_INIT = { "bcast_init", { collective_start_datatype, bcast_start_pack },
+        { bcast_init_datatype, bcast_init_pack }, 1, 0, 0, 0 };
+static const nonblocking_pattern_t ALLGATHER_INIT = { "allgather_init", { collective_start_datatype, allgather_start_pack },
+        { allgather_init_datatype, allgather_init_pack }, 1, 0, 1, 0 };
+static const nonblocking_pattern_t STREAM = { "stream", { stream_datatype, stream_pack },
+        { NULL, NULL }, 1, 1, 0, 1 };
+
+
+// median time of a repetition (maximum over the processes), not measured with the benchmark timer
+static double time_rounds(nonblocking_round_t round, const nonblocking_args_t *args, long compute_iterations) {
+    double times[OVERLAP_CALIBRATION_NREP];
+    double t, median;
+    int r, i, j;
+
+    for (r = 0; r < OVERLAP_CALIBRATION_NREP; r++) {
+        MPI_Barrier(args->comm);
+        t = MPI_Wtime();
+        round(args, compute_iterations);
+        t = MPI_Wtime() - t;
+        // insertion sort
+        for (i = r; i > 0 && times[i-1] > t; i--) {
+            times[i] = times[i-1];
+        }
+        times[i] = t;
+    }
+    j = OVERLAP_CALIBRATION_NREP / 2;
+    MPI_Allreduce(&times[j], &median, 1, MPI_DOUBLE, MPI_MAX, args->comm);
+    return median;
+}
+
+
+/* overlap mode: the compute kernel takes compute_factor times the communication time per repetition
+ * (split evenly between the waits); the communication time is estimated before the measurement
+ * only to size the kernel, the overlap is derived from the measured times */
+static long calibrate_compute(const pattern_config_t conf, const nonblocking_pattern_t *pattern,
+        nonblocking_round_t round, const nonblocking_args_t *args, int *ngaps) {
+    long compute_iterations = 0;
+    double t_comm;
+
+    // processes that do not take part in the pattern do not compute
+    *ngaps = pattern->ngaps;
+    if (pattern->pairwise && args->rank != PROC1 && args->rank != PROC2) {
+        *ngaps = 0;
+    }
+
+    round(args, 0); // warm-up
+    t_comm = time_rounds(round, args, 0);
+
+    if (*ngaps > 0) {
+        compute_iterations = get_compute_iterations(conf.compute_factor * t_comm / *ngaps);
+    }
+    return compute_iterations;
+}
+
+
+// stream: the runtime covers the window, thus bandwidth = window_bytes / runtime
+// and message rate = window / runtime (the strings are freed by the caller)
+static void set_stream_fields(const nonblocking_args_t *args, char **out_window, char **out_window_bytes) {
+    char *window_str, *window_bytes_str;
+
+    window_str = my_int_to_string(args->window);
+    window_bytes_str = my_count_to_string(args->window * (MPI_Count)args->c * get_type_size(args->type));
+
+    //@ set window=window_str
+    //@ set window_bytes=window_bytes_str
+
+    *out_window = window_str;
+    *out_window_bytes = window_bytes_str;
+}
+
+
+static void measure_nonblocking(const pattern_config_t conf, const nonblocking_pattern_t *pattern,
+        nonblocking_round_t round, const nonblocking_args_t *args, const char* test_type) {
+    char *window_str = NULL, *window_bytes_str = NULL;
+
+    if (pattern->stream) {
+        set_stream_fields(args, &window_str, &window_bytes_str);
+    }
+
+    //@ set test_type=test_type
+
+    //@ initialize_timestamps t1
+    //@ initialize_timestamps t2
+
+    //@ start_measurement_loop
+
+    //@ start_sync
+    //@ measure_timestamp t1
+    round(args, 0);
+    //@ measure_timestamp t2
+    //@ stop_sync
+    //@stop_measurement_loop
+
+    //@ print_runtime_array name=runtime end_time=t2 start_time=t1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+
+    //@cleanup_variables
+    free(window_str);
+    free(window_bytes_str);
+}
+
+
+/* each repetition runs the pattern with the compute kernel (runtime), then without it
+ * (nonblocking_comm_time) and the compute kernel alone (compute_time), separated by barriers;
+ * the overlap fraction of a repetition is 1 - (runtime - compute_time) / nonblocking_comm_time */
+static void measure_overlap(const pattern_config_t conf, const nonblocking_pattern_t *pattern,
+        nonblocking_round_t round, const nonblocking_args_t *args, const char* test_type) {
+    long compute_iterations;
+    int ngaps, g;
+    char *window_str = NULL, *window_bytes_str = NULL;
+
+    compute_iterations = calibrate_compute(conf, pattern, round, args, &ngaps);
+
+    if (pattern->stream) {
+        set_stream_fields(args, &window_str, &window_bytes_str);
+    }
+
+    //@ set test_type=test_type
+
+    //@ initialize_timestamps t1
+    //@ initialize_timestamps t2
+    //@ initialize_timestamps tn1
+    //@ initialize_timestamps tn2
+    //@ initialize_timestamps tk1
+    //@ initialize_timestamps tk2
+
+    //@ start_measurement_loop
+
+    //@ start_sync
+    //@ measure_timestamp t1
+    round(args, compute_iterations);
+    //@ measure_timestamp t2
+    MPI_Barrier(args->comm);
+    //@ measure_timestamp tn1
+    round(args, 0);
+    //@ measure_timestamp tn2
+    MPI_Barrier(args->comm);
+    //@ measure_timestamp tk1
+    for (g = 0; g < ngaps; g++) {
+        run_compute_kernel(compute_iterations);
+    }
+    //@ measure_timestamp tk2
+    //@ stop_sync
+    //@stop_measurement_loop
+
+    //@ print_runtime_array name=runtime end_time=t2 start_time=t1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+    //@ print_runtime_array name=nonblocking_comm_time end_time=tn2 start_time=tn1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+    //@ print_runtime_array name=compute_time end_time=tk2 start_time=tk1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+
+    //@cleanup_variables
+    free(window_str);
+    free(window_bytes_str);
+}
+
+
+static void measure_persistent_init(persistent_init_t init, nonblocking_args_t *args, const char* test_type) {
+
+    //@ set test_type=test_type
+
+    //@ initialize_timestamps t1
+    //@ initialize_timestamps t2
+    //@ initialize_timestamps t3
+
+    //@ start_measurement_loop
+
+    //@ start_sync
+    //@ measure_timestamp t1
+    init(args);
+    //@ measure_timestamp t2
+    free_persistent_requests(args);
+    //@ measure_timestamp t3
+    //@ stop_sync
+    //@stop_measurement_loop
+
+    //@ print_runtime_array name=init_time end_time=t2 start_time=t1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+    //@ print_runtime_array name=request_free_time end_time=t3 start_time=t2 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+
+    //@cleanup_variables
+}
+
+
+// persistent patterns: the creation of the requests is measured first, then their start and completion
+static void measure_pattern(const pattern_config_t conf, const nonblocking_pattern_t *pattern, int test_index,
+        nonblocking_args_t *args, const char* test_type) {
+    persistent_init_t init = pattern->init[test_index];
+
+    measure_t measure = (conf.compute_factor > 0) ? measure_overlap : measure_nonblocking;
+
+    if (init == NULL) {
+        measure(conf, pattern, pattern->round[test_index], args, test_type);
+        return;
+    }
+
+    measure_persistent_init(init, args, test_type);
+    init(args); // not to measure
+    measure(conf, pattern, pattern->round[test_index], args, test_type);
+    free_persistent_requests(args);
+}
+
+
+static void run_nonblocking(const nonblocking_pattern_t *pattern, pattern_config_t conf, int rank,
+        void* sendbuf, void* recvbuf, int c, MPI_Datatype type) {
+    nonblocking_args_t args;
+    MPI_Aint lb;
+    int send_packs, recv_packs;
+
+    args.rank = rank;
+    MPI_Comm_size(conf.comm, &args.size);
+    args.sendbuf = sendbuf;
+    args.recvbuf = recvbuf;
+    args.c = c;
+    args.type = type;
+    MPI_Type_get_extent(type, &lb, &args.extent);
+    args.root_proc = conf.root_proc;
+    args.comm = conf.comm;
+    args.sendpack = NULL;
+    args.recvpack = NULL;
+    args.packsize = 0;
+    args.nreqs = 0;
+    args.window = (pattern->stream) ? stream_window : 1;
+    args.window_reqs = (MPI_Request*)malloc(args.window * sizeof(MPI_Request));
+    assert(args.window_reqs!=NULL);
+
+    switch (conf.test_type) {
+    case test_datatype:
+        measure_pattern(conf, pattern, 0, &args, "datatype");
+        break;
+    case test_pack:
+        // not to measure
+        send_packs = args.window;
+        recv_packs = (pattern->gather) ? args.size : args.window;
+        args.packsize = get_pack_size(c, type, conf.comm);
+        posix_memalign(&args.sendpack, CACHE_LINE_SIZE, (size_t)args.packsize * send_packs);
+        assert(args.sendpack!=NULL);
+        posix_memalign(&args.recvpack, CACHE_LINE_SIZE, (size_t)args.packsize * recv_packs);
+        assert(args.recvpack!=NULL);
+
+        measure_pattern(conf, pattern, 1, &args, "pack");
+
+        free(args.sendpack);
+        free(args.recvpack);
+        break;
+    default:
+        printf("Error: the %s pattern only supports the test types datatype and pack\n", pattern->name);
+        exit(1);
+    }
+    free(args.window_reqs);
+}
+
+
+static void run_ipingpong(pattern_config_t conf, int rank, void* sendbuf, void* recvbuf, int c,
+        MPI_Datatype type) {
+    run_nonblocking(&IPINGPONG, conf, rank, sendbuf, recvbuf, c, type);
+}
+
+static void run_ibcast(pattern_config_t conf, int rank, void* sendbuf, void* recvbuf, int c,
+        MPI_Datatype type) {
+    run_nonblocking(&IBCAST, conf, rank, sendbuf, recvbuf, c, type);
+}
+
+static void run_iallgather(pattern_config_t conf, int rank, void* sendbuf, void* recvbuf, int c,
+        MPI_Datatype type) {
+    run_nonblocking(&IALLGATHER, conf, rank, sendbuf, recvbuf, c, type);
+}
+
+static void run_pingpong_init(pattern_config_t conf, int rank, void* sendbuf, void* recvbuf, int c,
+        MPI_Datatype type) {
+    run_nonblocking(&PINGPONG_INIT, conf, rank, sendbuf, recvbuf, c, type);
+}
+
+static void run_bcast_init(pattern_config_t conf, int rank, void* sendbuf, void* recvbuf, int c,
+        MPI_Datatype type) {
+    run_nonblocking(&BCAST_INIT, conf, rank, sendbuf, recvbuf, c, type);
+}
+
+static void run_allgather_init(pattern_config_t conf, int rank, void* sendbuf, void* recvbuf, int c,
+        MPI_Datatype type) {
+    run_nonblocking(&ALLGATHER_INIT, conf, rank, sendbuf, recvbuf, c, type);
+}
+
+static void run_stream(pattern_config_t conf, int rank, void* sendbuf, void* recvbuf, int c,
+        MPI_Datatype type) {
+    run_nonblocking(&STREAM, conf, rank, sendbuf, recvbuf, c, type);
+}
+
+
+// window of the stream pattern (default: DEFAULT_STREAM_WINDOW)
+static void init_stream_window(dictionary_t *dict) {
+    char *value;
+
+    stream_window = DEFAULT_STREAM_WINDOW;
+    if (get_value_from_dict(dict, "window", &value) == 0 && value != NULL) {
+        stream_window = atoi(value);
+        if (stream_window <= 0) {
+            printf("\nError: \"window\" has to be a positive integer\n");
+            exit(1);
+        }
+        free(value);
+    }
+}
+
+
+int ipingpongpattern(pattern_config_t conf, dictionary_t *dict)
+{
+    return measure_basic_pattern(conf, dict, run_ipingpong, 1, 1);
+}
+
+int ibcastpattern(pattern_config_t conf, dictionary_t *dict)
+{
+    return measure_basic_pattern(conf, dict, run_ibcast, 1, 0);
+}
+
+int iallgatherpattern(pattern_config_t conf, dictionary_t *dict)
+{
+    int size;
+
+    MPI_Comm_size(conf.comm,&size);
+    return measure_basic_pattern(conf, dict, run_iallgather, 1, size);
+}
+
+
+int ipingpongpattern_dynamictype(pattern_config_t conf, dictionary_t *dict)
+{
+    return measure_dynamic_pattern(conf, dict, run_ipingpong, 1, 1);
+}
+
+int ibcastpattern_dynamictype(pattern_config_t conf, dictionary_t *dict)
+{
+    return measure_dynamic_pattern(conf, dict, run_ibcast, 1, 0);
+}
+
+int iallgatherpattern_dynamictype(pattern_config_t conf, dictionary_t *dict)
+{
+    int size;
+
+    MPI_Comm_size(conf.comm,&size);
+    return measure_dynamic_pattern(conf, dict, run_iallgather, 1, size);
+}
+
+
+int pingpong_initpattern(pattern_config_t conf, dictionary_t *dict)
+{
+    return measure_basic_pattern(conf, dict, run_pingpong_init, 1, 1);
+}
+
+int bcast_initpattern(pattern_config_t conf, dictionary_t *dict)
+{
+    return measure_basic_pattern(conf, dict, run_bcast_init, 1, 0);
+}
+
+int allgather_initpattern(pattern_config_t conf, dictionary_t *dict)
+{
+    int size;
+
+    MPI_Comm_size(conf.comm,&size);
+    return measure_basic_pattern(conf, dict, run_allgather_init, 1, size);
+}
+
+
+int pingpong_initpattern_dynamictype(pattern_config_t conf, dictionary_t *dict)
+{
+    return measure_dynamic_pattern(conf, dict, run_pingpong_init, 1, 1);
+}
+
+int bcast_initpattern_dynamictype(pattern_config_t conf, dictionary_t *dict)
+{
+    return measure_dynamic_pattern(conf, dict, run_bcast_init, 1, 0);
+}
+
+int allgather_initpattern_dynamictype(pattern_config_t conf, dictionary_t *dict)
+{
+    int size;
+
+    MPI_Comm_size(conf.comm,&size);
+    return measure_dynamic_pattern(conf, dict, run_allgather_init, 1, size);
+}
+
+
+int streampattern(pattern_config_t conf, dictionary_t *dict)
+{
+    init_stream_window(dict);
+    return measure_basic_pattern(conf, dict, run_stream, 1, stream_window);
+}
+
+int streampattern_dynamictype(pattern_config_t conf, dictionary_t *dict)
+{
+    init_stream_window(dict);
+    return measure_dynamic_pattern(conf, dict, run_stream, 1, stream_window);
+}
@@ -0,0 +1,62 @@
+/*  MPI-Datatybe - MPI Datatype Benchmark
+ *  
+ *  Copyright 2017 Alexandra Carpen-Amarie, Sascha Hunold, Jesper Larsson Träff
+ *      Research Group for Parallel Computing
+ *      Faculty of Informatics
+ *      Vienna University of Technology, Austria
+ *  
+ *  <license>
+ *      This program is free software: you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation, either version 2 of the License, or
+ *      (at your option) any later version.
+ *  
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *  
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *  </license>
+ */
+
+
+#ifndef NONBLOCKING_PATTERNS_H_
+#define NONBLOCKING_PATTERNS_H_
+
+#include "datatypes_bench.h"
+#include "dictionary/keyvalue_store.h"
+
+/* the patterns of comm_patterns.h with nonblocking communication (MPI_Isend/MPI_Irecv,
+ * MPI_Ibcast, MPI_Iallgather), test types datatype and pack;
+ * in overlap mode (conf.compute_factor > 0), a compute kernel is run between the start and
+ * the completion of each operation; the times with and without the kernel and of the kernel
+ * alone are reported, from which the achieved overlap is derived */
+int ipingpongpattern(pattern_config_t conf, dictionary_t *dict);
+int ibcastpattern(pattern_config_t conf, dictionary_t *dict);
+int iallgatherpattern(pattern_config_t conf, dictionary_t *dict);
+
+int ipingpongpattern_dynamictype(pattern_config_t conf, dictionary_t *dict);
+int ibcastpattern_dynamictype(pattern_config_t conf, dictionary_t *dict);
+int iallgatherpattern_dynamictype(pattern_config_t conf, dictionary_t *dict);
+
+/* persistent versions (MPI_Send_init/MPI_Recv_init, MPI_Bcast_init, MPI_Allgather_init): the
+ * creation and freeing of the requests (init_time, request_free_time) is measured separately from
+ * their start and completion (runtime, overlap mode as above); the collectives require MPI-4
+ * (or the MPIX extension of Open MPI) */
+int pingpong_initpattern(pattern_config_t conf, dictionary_t *dict);
+int bcast_initpattern(pattern_config_t conf, dictionary_t *dict);
+int allgather_initpattern(pattern_config_t conf, dictionary_t *dict);
+
+int pingpong_initpattern_dynamictype(pattern_config_t conf, dictionary_t *dict);
+int bcast_initpattern_dynamictype(pattern_config_t conf, dictionary_t *dict);
+int allgather_initpattern_dynamictype(pattern_config_t conf, dictionary_t *dict);
+
+/* streaming: rank 0 keeps a window of nonblocking sends (window parameter, default 64) in flight to
+ * rank 1, which receives each message into its own buffer and acknowledges the window with an empty
+ * message; the window and its bytes are reported besides the run-time of a window */
+int streampattern(pattern_config_t conf, dictionary_t *dict);
+int streampattern_dynamictype(pattern_config_t conf, dictionary_t *dict);
+
+#endif /* NONBLOCKING_PATTERNS_H_ */
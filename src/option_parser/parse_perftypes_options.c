@@ -139,13 +139,52 @@ void print_help(void) {
     printf("%-40s %-40s\n", "--params=root:<process_id>", "");
     printf("%-40s %-40s\n", "--params=b:<mpi_base_datatype>",
         "Possible values: MPI_INT, MPI_CHAR, MPI_FLOAT, MPI_DOUBLE");
-    printf("%-40s %-40s\n", "--params=test_type:<type>", "Possible values: datatype, pack");
-    printf("%-40s %-40s\n", "--params=pattern:<test_pattern>", "Possible values: pingpong, bcast, allgather");
+    printf("%-40s %-40s\n", "--params=test_type:<type>", "Possible values: datatype, pack, manual, specialized, simd, threaded, pipelined");
+    printf("%-40s %-40s\n", "--params=pattern:<test_pattern>", "Possible values: pingpong, bcast, allgather, gather, scatter, alltoall, alltoallw, ipingpong, ibcast, iallgather, pingpong_init, bcast_init, allgather_init, halo, put, get, accumulate, multi_pingpong, ring, stream, construct");
     printf("%-40s %-40s\n", "--params=layout:<test_layout>",
         "Possible values: tiled, block, bucket, alternating, etc.");
+    printf("%-40s %-40s\n", "--params=expr:<expression>",
+        "datatype of the expr layout, e.g. vector(n/8,2,5,b) (see README)");
+    printf("%-40s %-40s\n", "--params=typemap_file:<path>",
+        "binary typemap file of the from_file layout");
     printf("%-40s %-40s\n", "--params=nbytes_list:<list>", "List of integer values separated by \"/\"");
     printf("\n");
 
+    printf("\nOptional parameters:\n");
+    printf("%-40s %-40s\n", "--params=normalize:on",
+        "also measure the normalized form of the datatype (contiguous, vector, indexed_block or hindexed)");
+    printf("%-40s %-40s\n", "--params=simd_isa:<isa>",
+        "instruction set of the simd test type; possible values: avx512 (default), avx2, scalar");
+    printf("%-40s %-40s\n", "--params=pack_threads:<nthreads>",
+        "number of threads of the threaded test type (default: online cores / processes on the node)");
+    printf("%-40s %-40s\n", "--params=segment_size:<nbytes>",
+        "segment size of the pipelined test type (default: 65536)");
+    printf("%-40s %-40s\n", "--params=peer_layouts:<list>",
+        "alltoallw pattern: further layouts (\"/\"-separated) used for the pairs of processes");
+    printf("%-40s %-40s\n", "--params=dims:<2|3>",
+        "halo pattern: dimensions of the process grid and of the local grid");
+    printf("%-40s %-40s\n", "--params=W:<width>",
+        "halo pattern: width of the halo");
+    printf("%-40s %-40s\n", "--params=overlap:on",
+        "nonblocking patterns: compute between start and wait and report the achieved overlap");
+    printf("%-40s %-40s\n", "--params=compute_factor:<factor>",
+        "compute time of the overlap mode relative to the communication time (default: 1)");
+    printf("%-40s %-40s\n", "--params=window:<nmessages>",
+        "stream pattern: messages in flight per acknowledgement (default: 64)");
+    printf("%-40s %-40s\n", "--params=pairing:<mode>",
+        "multi_pingpong pattern: pairs of processes; possible values: neighbor (default), half_shift, random");
+    printf("%-40s %-40s\n", "--params=pairing_seed:<seed>",
+        "seed of the random pairing (default: 1)");
+    printf("%-40s %-40s\n", "--params=rma_sync:<mode>",
+        "synchronization of the one-sided patterns; possible values: fence (default), pscw, lock");
+    printf("%-40s %-40s\n", "--params=type_cache:<mode>",
+        "cache committed dynamic datatypes; possible values: off (default), on, prebuild");
+    printf("%-40s %-40s\n", "--params=typemap_export:<prefix>",
+        "write the flattened datatypes to typemap files <prefix>.<nbytes> (see layout from_file)");
+    printf("%-40s %-40s\n", "--params=skip_measured:<path>",
+        "skip sizes whose typemap fingerprint is recorded in (and record new ones to) the file <path>");
+    printf("\n");
+
     printf("\nSpecific options for ReproMPI:\n");
     printf("%-40s %-40s\n", "--nrep=<nrep>",
             "set number of experiment repetitions");
@@ -0,0 +1,65 @@
+/*  MPI-Datatybe - MPI Datatype Benchmark
+ *  
+ *  Copyright 2017 Alexandra Carpen-Amarie, Sascha Hunold, Jesper Larsson Träff
+ *      Research Group for Parallel Computing
+ *      Faculty of Informatics
+ *      Vienna University of Technology, Austria
+ *  
+ *  <license>
+ *      This program is free software: you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation, either version 2 of the License, or
+ *      (at your option) any later version.
+ *  
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *  
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *  </license>
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <mpi.h>
+
+#include "manual_pack.h"
+
+
+int manual_pack_init(pack_handle_t *handle, MPI_Datatype type, int count) {
+    handle->state = NULL;
+    return MPI_SUCCESS;
+}
+
+
+void manual_pack(const pack_handle_t *handle, const void *inbuf, void *packbuf) {
+    const typemap_t *map = &handle->map;
+    const char *in = (const char*)inbuf;
+    char *out = (char*)packbuf;
+    size_t i;
+
+    for (i = 0; i < map->nblocks; i++) {
+        memcpy(out, in + map->offsets[i], map->lengths[i]);
+        out += map->lengths[i];
+    }
+}
+
+
+void manual_unpack(const pack_handle_t *handle, const void *packbuf, void *outbuf) {
+    const typemap_t *map = &handle->map;
+    const char *in = (const char*)packbuf;
+    char *out = (char*)outbuf;
+    size_t i;
+
+    for (i = 0; i < map->nblocks; i++) {
+        memcpy(out + map->offsets[i], in, map->lengths[i]);
+        in += map->lengths[i];
+    }
+}
+
+
+void manual_pack_cleanup(pack_handle_t *handle) {
+}
@@ -0,0 +1,36 @@
+/*  MPI-Datatybe - MPI Datatype Benchmark
+ *  
+ *  Copyright 2017 Alexandra Carpen-Amarie, Sascha Hunold, Jesper Larsson Träff
+ *      Research Group for Parallel Computing
+ *      Faculty of Informatics
+ *      Vienna University of Technology, Austria
+ *  
+ *  <license>
+ *      This program is free software: you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation, either version 2 of the License, or
+ *      (at your option) any later version.
+ *  
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *  
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *  </license>
+ */
+
+
+#ifndef MANUAL_PACK_H_
+#define MANUAL_PACK_H_
+
+#include "pack_engine.h"
+
+// one memcpy per block of the flattened (offset, length) list
+int manual_pack_init(pack_handle_t *handle, MPI_Datatype type, int count);
+void manual_pack(const pack_handle_t *handle, const void *inbuf, void *packbuf);
+void manual_unpack(const pack_handle_t *handle, const void *packbuf, void *outbuf);
+void manual_pack_cleanup(pack_handle_t *handle);
+
+#endif /* MANUAL_PACK_H_ */
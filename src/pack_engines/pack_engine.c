@@ -0,0 +1,149 @@
+/*  MPI-Datatybe - MPI Datatype Benchmark
+ *  
+ *  Copyright 2017 Alexandra Carpen-Amarie, Sascha Hunold, Jesper Larsson Träff
+ *      Research Group for Parallel Computing
+ *      Faculty of Informatics
+ *      Vienna University of Technology, Austria
+ *  
+ *  <license>
+ *      This program is free software: you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation, either version 2 of the License, or
+ *      (at your option) any later version.
+ *  
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *  
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *  </license>
+ */
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <mpi.h>
+
+#include "pack_engine.h"
+#include "manual_pack.h"
+#include "specialized_pack.h"
+#include "simd_pack.h"
+#include "threaded_pack.h"
+
+static const pack_engine_t pack_engine_list[] = {
+    { "memcpy", manual_pack_init, manual_pack, manual_unpack, manual_pack_cleanup },
+    { "specialized", specialized_pack_init, specialized_pack, specialized_unpack, specialized_pack_cleanup },
+    { "simd", simd_pack_init, simd_pack, simd_unpack, simd_pack_cleanup },
+    { "simd_avx2", simd_avx2_pack_init, simd_pack, simd_unpack, simd_pack_cleanup },
+    { "simd_scalar", simd_scalar_pack_init, simd_pack, simd_unpack, simd_pack_cleanup },
+    { "threaded", threaded_pack_init, threaded_pack, threaded_unpack, threaded_pack_cleanup }
+};
+
+static const int N_PACK_ENGINES = sizeof(pack_engine_list) / sizeof(pack_engine_list[0]);
+
+
+int init_pack_handle(const char* engine_name, MPI_Datatype type, int count, pack_handle_t *handle) {
+    int i;
+
+    handle->engine = NULL;
+    for (i = 0; i < N_PACK_ENGINES; i++) {
+        if (strcmp(engine_name, pack_engine_list[i].name) == 0) {
+            handle->engine = &pack_engine_list[i];
+            break;
+        }
+    }
+    if (handle->engine == NULL) {
+        printf("Error: unknown pack engine: %s\n", engine_name);
+        exit(1);
+    }
+
+    flatten_datatype(type, count, &handle->map);
+    handle->packsize = handle->map.size;
+
+    return handle->engine->init(handle, type, count);
+}
+
+
+void cleanup_pack_handle(pack_handle_t *handle) {
+    handle->engine->cleanup(handle);
+    cleanup_typemap(&handle->map);
+}
+
+
+void pack_with_engine(const pack_handle_t *handle, const void *inbuf, void *packbuf) {
+    handle->engine->pack(handle, inbuf, packbuf);
+}
+
+
+void unpack_with_engine(const pack_handle_t *handle, const void *packbuf, void *outbuf) {
+    handle->engine->unpack(handle, packbuf, outbuf);
+}
+
+
+int split_pack_handle(const pack_handle_t *handle, size_t range_size, pack_range_t **ranges) {
+    const typemap_t *map = &handle->map;
+    size_t block = 0;
+    size_t block_start = 0;    // packed position of the current block
+    size_t offset;
+    int n, r;
+
+    n = (handle->packsize > 0) ? (int)((handle->packsize + range_size - 1) / range_size) : 1;
+    *ranges = (pack_range_t*)malloc(n * sizeof(pack_range_t));
+    if (*ranges == NULL) {
+        printf("Error: cannot allocate %d pack ranges\n", n);
+        exit(1);
+    }
+
+    for (r = 0; r < n; r++) {
+        offset = (size_t)r * range_size;
+        while (block < map->nblocks && block_start + map->lengths[block] <= offset) {
+            block_start += map->lengths[block];
+            block++;
+        }
+        (*ranges)[r].first_block = block;
+        (*ranges)[r].first_skip = offset - block_start;
+        (*ranges)[r].pack_offset = offset;
+        (*ranges)[r].nbytes = (r < n - 1) ? range_size : handle->packsize - offset;
+    }
+    return n;
+}
+
+
+static void copy_range(const pack_handle_t *handle, const pack_range_t *range, int pack,
+        const char *inbuf, char *outbuf) {
+    const typemap_t *map = &handle->map;
+    size_t i = range->first_block;
+    MPI_Aint skip = range->first_skip;
+    size_t remaining = range->nbytes;
+    size_t rangepos = 0;
+
+    while (remaining > 0) {
+        size_t len = map->lengths[i] - skip;
+
+        if (len > remaining) {
+            len = remaining;
+        }
+        if (pack) {
+            memcpy(outbuf + rangepos, inbuf + map->offsets[i] + skip, len);
+        } else {
+            memcpy(outbuf + map->offsets[i] + skip, inbuf + rangepos, len);
+        }
+        rangepos += len;
+        remaining -= len;
+        skip = 0;
+        i++;
+    }
+}
+
+
+void pack_range(const pack_handle_t *handle, const pack_range_t *range, const void *inbuf, void *rangebuf) {
+    copy_range(handle, range, 1, (const char*)inbuf, (char*)rangebuf);
+}
+
+
+void unpack_range(const pack_handle_t *handle, const pack_range_t *range, const void *rangebuf, void *outbuf) {
+    copy_range(handle, range, 0, (const char*)rangebuf, (char*)outbuf);
+}
@@ -0,0 +1,80 @@
+/*  MPI-Datatybe - MPI Datatype Benchmark
+ *  
+ *  Copyright 2017 Alexandra Carpen-Amarie, Sascha Hunold, Jesper Larsson Träff
+ *      Research Group for Parallel Computing
+ *      Faculty of Informatics
+ *      Vienna University of Technology, Austria
+ *  
+ *  <license>
+ *      This program is free software: you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation, either version 2 of the License, or
+ *      (at your option) any later version.
+ *  
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *  
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *  </license>
+ */
+
+
+#ifndef PACK_ENGINE_H_
+#define PACK_ENGINE_H_
+
+#include <mpi.h>
+#include "typemap/typemap.h"
+
+/* hand-written pack engines working on the flattened layout,
+ * used as a reference for the MPI_Pack/MPI_Unpack implementation of the library */
+
+struct pack_engine;
+
+typedef struct pack_handle {
+    const struct pack_engine *engine;
+    typemap_t map;          // flattened layout of count instances of the datatype
+    size_t packsize;        // number of bytes in the packed buffer
+    void *state;            // engine-specific data
+} pack_handle_t;
+
+typedef int (*pack_engine_init_t)(pack_handle_t *handle, MPI_Datatype type, int count);
+typedef void (*pack_engine_copy_t)(const pack_handle_t *handle, const void *inbuf, void *outbuf);
+typedef void (*pack_engine_cleanup_t)(pack_handle_t *handle);
+
+typedef struct pack_engine {
+    char* name;
+    pack_engine_init_t init;
+    pack_engine_copy_t pack;
+    pack_engine_copy_t unpack;
+    pack_engine_cleanup_t cleanup;
+} pack_engine_t;
+
+
+// flattens count instances of type (not to measure) and prepares the selected engine
+int init_pack_handle(const char* engine_name, MPI_Datatype type, int count, pack_handle_t *handle);
+void cleanup_pack_handle(pack_handle_t *handle);
+
+// packs the layout from inbuf into the contiguous packbuf (handle->packsize bytes)
+void pack_with_engine(const pack_handle_t *handle, const void *inbuf, void *packbuf);
+// unpacks the contiguous packbuf into the layout in outbuf
+void unpack_with_engine(const pack_handle_t *handle, const void *packbuf, void *outbuf);
+
+// bytes [pack_offset, pack_offset + nbytes) of the packed buffer of a handle
+typedef struct pack_range {
+    size_t first_block;
+    MPI_Aint first_skip;    // bytes of first_block that belong to the previous range
+    size_t pack_offset;
+    size_t nbytes;
+} pack_range_t;
+
+/* splits the packed buffer of the handle into ranges of range_size bytes (the last one may be
+ * shorter), independent of the blocks and instances of the layout; *ranges is allocated */
+int split_pack_handle(const pack_handle_t *handle, size_t range_size, pack_range_t **ranges);
+// copies one range with memcpy between the layout in buf and the range in rangebuf (its first byte)
+void pack_range(const pack_handle_t *handle, const pack_range_t *range, const void *inbuf, void *rangebuf);
+void unpack_range(const pack_handle_t *handle, const pack_range_t *range, const void *rangebuf, void *outbuf);
+
+#endif /* PACK_ENGINE_H_ */
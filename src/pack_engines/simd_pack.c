@@ -0,0 +1,415 @@
+/*  MPI-Datatybe - MPI Datatype Benchmark
+ *  
+ *  Copyright 2017 Alexandra Carpen-Amarie, Sascha Hunold, Jesper Larsson Träff
+ *      Research Group for Parallel Computing
+ *      Faculty of Informatics
+ *      Vienna University of Technology, Austria
+ *  
+ *  <license>
+ *      This program is free software: you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation, either version 2 of the License, or
+ *      (at your option) any later version.
+ *  
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *  
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *  </license>
+ */
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <assert.h>
+#include <mpi.h>
+
+#include "simd_pack.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define HAVE_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+// shorter runs are not worth a vector kernel
+static const size_t MIN_VECTOR_RUN = 16;
+// lanes of the widest gather, used to bound the 32-bit gather indices
+static const MPI_Aint MAX_VECTOR_LANES = 16;
+
+typedef enum SimdLevels {
+    simd_scalar,
+    simd_avx2,
+    simd_avx512
+} simd_level_t;
+
+typedef void (*strided_kernel_t)(const char *in, char *out, size_t n, MPI_Aint stride);
+
+// n blocks of blocklen bytes, the first at offset, the others shifted by stride bytes
+typedef struct strided_run {
+    size_t first_block;
+    size_t nblocks;
+    MPI_Aint offset;
+    MPI_Aint stride;
+    MPI_Aint blocklen;
+    strided_kernel_t gather;    // NULL: blocks are copied with memcpy
+    strided_kernel_t scatter;
+} strided_run_t;
+
+typedef struct simd_state {
+    simd_level_t level;
+    strided_run_t *runs;
+    size_t nruns;
+} simd_state_t;
+
+
+/***************************************************************/
+/* scalar kernels */
+/***************************************************************/
+
+#define DEFINE_SCALAR_KERNELS(L)                                                        \
+static void gather_scalar_##L(const char *in, char *out, size_t n, MPI_Aint stride) {   \
+    size_t i;                                                                           \
+    for (i = 0; i < n; i++) {                                                           \
+        memcpy(out + i * L, in + i * stride, L);                                        \
+    }                                                                                   \
+}                                                                                       \
+static void scatter_scalar_##L(const char *in, char *out, size_t n, MPI_Aint stride) {  \
+    size_t i;                                                                           \
+    for (i = 0; i < n; i++) {                                                           \
+        memcpy(out + i * stride, in + i * L, L);                                        \
+    }                                                                                   \
+}
+
+DEFINE_SCALAR_KERNELS(4)
+DEFINE_SCALAR_KERNELS(8)
+DEFINE_SCALAR_KERNELS(16)
+
+
+#ifdef HAVE_X86_SIMD
+/***************************************************************/
+/* AVX2 kernels: gathers for 4- and 8-byte blocks,
+ * wide loads and lane stores for the scatter (AVX2 has no scatter) */
+/***************************************************************/
+
+__attribute__((target("avx2")))
+static void gather_avx2_4(const char *in, char *out, size_t n, MPI_Aint stride) {
+    const __m256i vidx = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+            _mm256_set1_epi32((int)stride));
+    size_t i;
+
+    for (i = 0; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_i32gather_epi32((const int*)(in + i * stride), vidx, 1);
+        _mm256_storeu_si256((__m256i*)(out + i * 4), v);
+    }
+    gather_scalar_4(in + i * stride, out + i * 4, n - i, stride);
+}
+
+__attribute__((target("avx2")))
+static void gather_avx2_8(const char *in, char *out, size_t n, MPI_Aint stride) {
+    const __m128i vidx = _mm_mullo_epi32(_mm_setr_epi32(0, 1, 2, 3), _mm_set1_epi32((int)stride));
+    size_t i;
+
+    for (i = 0; i + 4 <= n; i += 4) {
+        __m256i v = _mm256_i32gather_epi64((const long long*)(in + i * stride), vidx, 1);
+        _mm256_storeu_si256((__m256i*)(out + i * 8), v);
+    }
+    gather_scalar_8(in + i * stride, out + i * 8, n - i, stride);
+}
+
+// two 16-byte blocks are combined into one 32-byte store
+__attribute__((target("avx2")))
+static void gather_avx2_16(const char *in, char *out, size_t n, MPI_Aint stride) {
+    size_t i;
+
+    for (i = 0; i + 2 <= n; i += 2) {
+        __m128i lo = _mm_loadu_si128((const __m128i*)(in + i * stride));
+        __m128i hi = _mm_loadu_si128((const __m128i*)(in + (i + 1) * stride));
+        _mm256_storeu_si256((__m256i*)(out + i * 16), _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1));
+    }
+    gather_scalar_16(in + i * stride, out + i * 16, n - i, stride);
+}
+
+#define STORE_LANE32(v, k) do { int x_ = _mm256_extract_epi32(v, k); memcpy(out + (i + k) * stride, &x_, 4); } while (0)
+#define STORE_LANE64(v, k) do { long long x_ = _mm256_extract_epi64(v, k); memcpy(out + (i + k) * stride, &x_, 8); } while (0)
+
+__attribute__((target("avx2")))
+static void scatter_avx2_4(const char *in, char *out, size_t n, MPI_Aint stride) {
+    size_t i;
+
+    for (i = 0; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(in + i * 4));
+        STORE_LANE32(v, 0); STORE_LANE32(v, 1); STORE_LANE32(v, 2); STORE_LANE32(v, 3);
+        STORE_LANE32(v, 4); STORE_LANE32(v, 5); STORE_LANE32(v, 6); STORE_LANE32(v, 7);
+    }
+    scatter_scalar_4(in + i * 4, out + i * stride, n - i, stride);
+}
+
+__attribute__((target("avx2")))
+static void scatter_avx2_8(const char *in, char *out, size_t n, MPI_Aint stride) {
+    size_t i;
+
+    for (i = 0; i + 4 <= n; i += 4) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(in + i * 8));
+        STORE_LANE64(v, 0); STORE_LANE64(v, 1); STORE_LANE64(v, 2); STORE_LANE64(v, 3);
+    }
+    scatter_scalar_8(in + i * 8, out + i * stride, n - i, stride);
+}
+
+__attribute__((target("avx2")))
+static void scatter_avx2_16(const char *in, char *out, size_t n, MPI_Aint stride) {
+    size_t i;
+
+    for (i = 0; i + 2 <= n; i += 2) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(in + i * 16));
+        _mm_storeu_si128((__m128i*)(out + i * stride), _mm256_castsi256_si128(v));
+        _mm_storeu_si128((__m128i*)(out + (i + 1) * stride), _mm256_extracti128_si256(v, 1));
+    }
+    scatter_scalar_16(in + i * 16, out + i * stride, n - i, stride);
+}
+
+
+/***************************************************************/
+/* AVX-512 kernels: gathers and scatters for 4- and 8-byte blocks */
+/***************************************************************/
+
+__attribute__((target("avx512f")))
+static void gather_avx512_4(const char *in, char *out, size_t n, MPI_Aint stride) {
+    const __m512i vidx = _mm512_mullo_epi32(
+            _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+            _mm512_set1_epi32((int)stride));
+    size_t i;
+
+    for (i = 0; i + 16 <= n; i += 16) {
+        __m512i v = _mm512_i32gather_epi32(vidx, (const void*)(in + i * stride), 1);
+        _mm512_storeu_si512((void*)(out + i * 4), v);
+    }
+    gather_scalar_4(in + i * stride, out + i * 4, n - i, stride);
+}
+
+__attribute__((target("avx512f")))
+static void gather_avx512_8(const char *in, char *out, size_t n, MPI_Aint stride) {
+    const __m256i vidx = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+            _mm256_set1_epi32((int)stride));
+    size_t i;
+
+    for (i = 0; i + 8 <= n; i += 8) {
+        __m512i v = _mm512_i32gather_epi64(vidx, (const void*)(in + i * stride), 1);
+        _mm512_storeu_si512((void*)(out + i * 8), v);
+    }
+    gather_scalar_8(in + i * stride, out + i * 8, n - i, stride);
+}
+
+__attribute__((target("avx512f")))
+static void scatter_avx512_4(const char *in, char *out, size_t n, MPI_Aint stride) {
+    const __m512i vidx = _mm512_mullo_epi32(
+            _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+            _mm512_set1_epi32((int)stride));
+    size_t i;
+
+    for (i = 0; i + 16 <= n; i += 16) {
+        __m512i v = _mm512_loadu_si512((const void*)(in + i * 4));
+        _mm512_i32scatter_epi32((void*)(out + i * stride), vidx, v, 1);
+    }
+    scatter_scalar_4(in + i * 4, out + i * stride, n - i, stride);
+}
+
+__attribute__((target("avx512f")))
+static void scatter_avx512_8(const char *in, char *out, size_t n, MPI_Aint stride) {
+    const __m256i vidx = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+            _mm256_set1_epi32((int)stride));
+    size_t i;
+
+    for (i = 0; i + 8 <= n; i += 8) {
+        __m512i v = _mm512_loadu_si512((const void*)(in + i * 8));
+        _mm512_i32scatter_epi64((void*)(out + i * stride), vidx, v, 1);
+    }
+    scatter_scalar_8(in + i * 8, out + i * stride, n - i, stride);
+}
+#endif /* HAVE_X86_SIMD */
+
+
+/* kernel tables indexed by [simd level][4-, 8-, 16-byte blocks] */
+#ifdef HAVE_X86_SIMD
+static const strided_kernel_t gather_kernels[3][3] = {
+    [simd_scalar] = { gather_scalar_4, gather_scalar_8, gather_scalar_16 },
+    [simd_avx2] = { gather_avx2_4, gather_avx2_8, gather_avx2_16 },
+    [simd_avx512] = { gather_avx512_4, gather_avx512_8, gather_avx2_16 }
+};
+static const strided_kernel_t scatter_kernels[3][3] = {
+    [simd_scalar] = { scatter_scalar_4, scatter_scalar_8, scatter_scalar_16 },
+    [simd_avx2] = { scatter_avx2_4, scatter_avx2_8, scatter_avx2_16 },
+    [simd_avx512] = { scatter_avx512_4, scatter_avx512_8, scatter_avx2_16 }
+};
+#else
+static const strided_kernel_t gather_kernels[1][3] = {
+    [simd_scalar] = { gather_scalar_4, gather_scalar_8, gather_scalar_16 }
+};
+static const strided_kernel_t scatter_kernels[1][3] = {
+    [simd_scalar] = { scatter_scalar_4, scatter_scalar_8, scatter_scalar_16 }
+};
+#endif
+
+
+static simd_level_t detect_simd_level(simd_level_t max_level) {
+    simd_level_t level = simd_scalar;
+
+#ifdef HAVE_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        level = simd_avx2;
+    }
+    if (__builtin_cpu_supports("avx512f")) {
+        level = simd_avx512;
+    }
+#endif
+    return (level < max_level) ? level : max_level;
+}
+
+
+static int blocklen_index(MPI_Aint blocklen) {
+    switch (blocklen) {
+    case 4: return 0;
+    case 8: return 1;
+    case 16: return 2;
+    }
+    return -1;
+}
+
+
+static void add_run(simd_state_t *s, size_t *max_runs, const typemap_t *map, size_t first, size_t n) {
+    strided_run_t *run;
+    int idx;
+
+    // consecutive memcpy runs are merged
+    if (s->nruns > 0 && s->runs[s->nruns - 1].gather == NULL && n < MIN_VECTOR_RUN) {
+        s->runs[s->nruns - 1].nblocks += n;
+        return;
+    }
+
+    if (s->nruns == *max_runs) {
+        *max_runs *= 2;
+        s->runs = (strided_run_t*)realloc(s->runs, *max_runs * sizeof(strided_run_t));
+        assert(s->runs != NULL);
+    }
+    run = &s->runs[s->nruns++];
+    run->first_block = first;
+    run->nblocks = n;
+    run->offset = map->offsets[first];
+    run->blocklen = map->lengths[first];
+    run->stride = (n > 1) ? map->offsets[first + 1] - map->offsets[first] : 0;
+    run->gather = NULL;
+    run->scatter = NULL;
+
+    idx = blocklen_index(run->blocklen);
+    if (n >= MIN_VECTOR_RUN && idx >= 0 &&
+        run->stride < INT_MAX / MAX_VECTOR_LANES && run->stride > -INT_MAX / MAX_VECTOR_LANES) {
+        run->gather = gather_kernels[s->level][idx];
+        run->scatter = scatter_kernels[s->level][idx];
+    }
+}
+
+
+// splits the flattened layout into maximal runs of equally sized blocks with a constant stride
+static int init_simd_state(pack_handle_t *handle, simd_level_t max_level) {
+    const typemap_t *map = &handle->map;
+    simd_state_t *s;
+    size_t max_runs = 16;
+    size_t i, j;
+
+    s = (simd_state_t*)malloc(sizeof(simd_state_t));
+    assert(s != NULL);
+    s->level = detect_simd_level(max_level);
+    s->nruns = 0;
+    s->runs = (strided_run_t*)malloc(max_runs * sizeof(strided_run_t));
+    assert(s->runs != NULL);
+
+    i = 0;
+    while (i < map->nblocks) {
+        j = i + 1;
+        if (j < map->nblocks && map->lengths[j] == map->lengths[i]) {
+            MPI_Aint stride = map->offsets[j] - map->offsets[i];
+            while (j < map->nblocks && map->lengths[j] == map->lengths[i] &&
+                   map->offsets[j] - map->offsets[j - 1] == stride) {
+                j++;
+            }
+        }
+        add_run(s, &max_runs, map, i, j - i);
+        i = j;
+    }
+
+    handle->state = s;
+    return MPI_SUCCESS;
+}
+
+
+int simd_pack_init(pack_handle_t *handle, MPI_Datatype type, int count) {
+    return init_simd_state(handle, simd_avx512);
+}
+
+int simd_avx2_pack_init(pack_handle_t *handle, MPI_Datatype type, int count) {
+    return init_simd_state(handle, simd_avx2);
+}
+
+int simd_scalar_pack_init(pack_handle_t *handle, MPI_Datatype type, int count) {
+    return init_simd_state(handle, simd_scalar);
+}
+
+
+void simd_pack(const pack_handle_t *handle, const void *inbuf, void *packbuf) {
+    const simd_state_t *s = (const simd_state_t*)handle->state;
+    const typemap_t *map = &handle->map;
+    const char *in = (const char*)inbuf;
+    char *out = (char*)packbuf;
+    size_t r, i;
+
+    for (r = 0; r < s->nruns; r++) {
+        const strided_run_t *run = &s->runs[r];
+
+        if (run->gather != NULL) {
+            run->gather(in + run->offset, out, run->nblocks, run->stride);
+            out += run->nblocks * run->blocklen;
+        } else {
+            for (i = run->first_block; i < run->first_block + run->nblocks; i++) {
+                memcpy(out, in + map->offsets[i], map->lengths[i]);
+                out += map->lengths[i];
+            }
+        }
+    }
+}
+
+
+void simd_unpack(const pack_handle_t *handle, const void *packbuf, void *outbuf) {
+    const simd_state_t *s = (const simd_state_t*)handle->state;
+    const typemap_t *map = &handle->map;
+    const char *in = (const char*)packbuf;
+    char *out = (char*)outbuf;
+    size_t r, i;
+
+    for (r = 0; r < s->nruns; r++) {
+        const strided_run_t *run = &s->runs[r];
+
+        if (run->scatter != NULL) {
+            run->scatter(in, out + run->offset, run->nblocks, run->stride);
+            in += run->nblocks * run->blocklen;
+        } else {
+            for (i = run->first_block; i < run->first_block + run->nblocks; i++) {
+                memcpy(out + map->offsets[i], in, map->lengths[i]);
+                in += map->lengths[i];
+            }
+        }
+    }
+}
+
+
+void simd_pack_cleanup(pack_handle_t *handle) {
+    simd_state_t *s = (simd_state_t*)handle->state;
+
+    free(s->runs);
+    free(s);
+    handle->state = NULL;
+}
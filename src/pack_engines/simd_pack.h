@@ -0,0 +1,42 @@
+/*  MPI-Datatybe - MPI Datatype Benchmark
+ *  
+ *  Copyright 2017 Alexandra Carpen-Amarie, Sascha Hunold, Jesper Larsson Träff
+ *      Research Group for Parallel Computing
+ *      Faculty of Informatics
+ *      Vienna University of Technology, Austria
+ *  
+ *  <license>
+ *      This program is free software: you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation, either version 2 of the License, or
+ *      (at your option) any later version.
+ *  
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *  
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *  </license>
+ */
+
+
+#ifndef SIMD_PACK_H_
+#define SIMD_PACK_H_
+
+#include "pack_engine.h"
+
+/* gather/scatter kernels for runs of equally sized small blocks (4, 8 or 16 bytes)
+ * with a constant stride, e.g., tiled with A=1 or A=2, or the column part of rowcol layouts;
+ * all other blocks are copied with memcpy.
+ * simd selects AVX-512 or AVX2 at run-time (depending on the CPU),
+ * simd_avx2 and simd_scalar restrict the instruction set for comparison */
+int simd_pack_init(pack_handle_t *handle, MPI_Datatype type, int count);
+int simd_avx2_pack_init(pack_handle_t *handle, MPI_Datatype type, int count);
+int simd_scalar_pack_init(pack_handle_t *handle, MPI_Datatype type, int count);
+void simd_pack(const pack_handle_t *handle, const void *inbuf, void *packbuf);
+void simd_unpack(const pack_handle_t *handle, const void *packbuf, void *outbuf);
+void simd_pack_cleanup(pack_handle_t *handle);
+
+#endif /* SIMD_PACK_H_ */
@@ -0,0 +1,342 @@
+/*  MPI-Datatybe - MPI Datatype Benchmark
+ *  
+ *  Copyright 2017 Alexandra Carpen-Amarie, Sascha Hunold, Jesper Larsson Träff
+ *      Research Group for Parallel Computing
+ *      Faculty of Informatics
+ *      Vienna University of Technology, Austria
+ *  
+ *  <license>
+ *      This program is free software: you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation, either version 2 of the License, or
+ *      (at your option) any later version.
+ *  
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *  
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *  </license>
+ */
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+#include <mpi.h>
+
+#include "specialized_pack.h"
+#include "manual_pack.h"
+
+#define MAX_SPECIALIZED_BLOCKLEN 4
+
+struct periodic_shape;
+typedef void (*spec_kernel_t)(const char *in, char *out, const struct periodic_shape *s);
+
+/* layout made of nperiods repetitions (shifted by period bytes) of
+ * one block (len1 bytes at first) or two blocks (len1 bytes at first, len2 bytes at first+delta) */
+typedef struct periodic_shape {
+    int periodic;
+    int blocks_per_period;
+    MPI_Aint first;
+    MPI_Aint delta;
+    MPI_Aint period;
+    MPI_Aint len1, len2;
+    size_t nperiods;
+    size_t tail;            // index of the first block not covered by the periodic part
+    spec_kernel_t pack;
+    spec_kernel_t unpack;
+} periodic_shape_t;
+
+
+/* kernels with compile-time element type T and block lengths A, A1, A2 */
+#define DEFINE_SINGLE_KERNELS(T, A)                                                  \
+static void pack1_##T##_##A(const char *in, char *out, const periodic_shape_t *s) { \
+    const char *src = in + s->first;                                                 \
+    T *dst = (T*)out;                                                                \
+    size_t p;                                                                        \
+    int k;                                                                           \
+    for (p = 0; p < s->nperiods; p++) {                                              \
+        const T *b = (const T*)(src + p * s->period);                                \
+        for (k = 0; k < A; k++) dst[k] = b[k];                                       \
+        dst += A;                                                                    \
+    }                                                                                \
+}                                                                                    \
+static void unpack1_##T##_##A(const char *in, char *out, const periodic_shape_t *s) { \
+    const T *src = (const T*)in;                                                     \
+    char *dst = out + s->first;                                                      \
+    size_t p;                                                                        \
+    int k;                                                                           \
+    for (p = 0; p < s->nperiods; p++) {                                              \
+        T *b = (T*)(dst + p * s->period);                                            \
+        for (k = 0; k < A; k++) b[k] = src[k];                                       \
+        src += A;                                                                    \
+    }                                                                                \
+}
+
+#define DEFINE_PAIR_KERNELS(T, A1, A2)                                                       \
+static void pack2_##T##_##A1##_##A2(const char *in, char *out, const periodic_shape_t *s) { \
+    const char *src = in + s->first;                                                         \
+    T *dst = (T*)out;                                                                        \
+    size_t p;                                                                                \
+    int k;                                                                                   \
+    for (p = 0; p < s->nperiods; p++) {                                                      \
+        const T *b1 = (const T*)(src + p * s->period);                                       \
+        const T *b2 = (const T*)(src + p * s->period + s->delta);                            \
+        for (k = 0; k < A1; k++) dst[k] = b1[k];                                             \
+        for (k = 0; k < A2; k++) dst[A1 + k] = b2[k];                                        \
+        dst += A1 + A2;                                                                      \
+    }                                                                                        \
+}                                                                                            \
+static void unpack2_##T##_##A1##_##A2(const char *in, char *out, const periodic_shape_t *s) { \
+    const T *src = (const T*)in;                                                             \
+    char *dst = out + s->first;                                                              \
+    size_t p;                                                                                \
+    int k;                                                                                   \
+    for (p = 0; p < s->nperiods; p++) {                                                      \
+        T *b1 = (T*)(dst + p * s->period);                                                   \
+        T *b2 = (T*)(dst + p * s->period + s->delta);                                        \
+        for (k = 0; k < A1; k++) b1[k] = src[k];                                             \
+        for (k = 0; k < A2; k++) b2[k] = src[A1 + k];                                        \
+        src += A1 + A2;                                                                      \
+    }                                                                                        \
+}
+
+#define FOR_EACH_BLOCKLEN(X, T) X(T, 1) X(T, 2) X(T, 3) X(T, 4)
+#define FOR_EACH_PAIR_A2(X, T, A1) X(T, A1, 1) X(T, A1, 2) X(T, A1, 3) X(T, A1, 4)
+#define FOR_EACH_PAIR(X, T) \
+    FOR_EACH_PAIR_A2(X, T, 1) FOR_EACH_PAIR_A2(X, T, 2) FOR_EACH_PAIR_A2(X, T, 3) FOR_EACH_PAIR_A2(X, T, 4)
+#define FOR_EACH_ELEMTYPE(X, ARG) X(ARG, uint8_t) X(ARG, uint16_t) X(ARG, uint32_t) X(ARG, uint64_t)
+
+FOR_EACH_BLOCKLEN(DEFINE_SINGLE_KERNELS, uint8_t)
+FOR_EACH_BLOCKLEN(DEFINE_SINGLE_KERNELS, uint16_t)
+FOR_EACH_BLOCKLEN(DEFINE_SINGLE_KERNELS, uint32_t)
+FOR_EACH_BLOCKLEN(DEFINE_SINGLE_KERNELS, uint64_t)
+FOR_EACH_PAIR(DEFINE_PAIR_KERNELS, uint8_t)
+FOR_EACH_PAIR(DEFINE_PAIR_KERNELS, uint16_t)
+FOR_EACH_PAIR(DEFINE_PAIR_KERNELS, uint32_t)
+FOR_EACH_PAIR(DEFINE_PAIR_KERNELS, uint64_t)
+
+/* kernel tables indexed by [log2(element size)][A-1] and [log2(element size)][A1-1][A2-1] */
+#define SINGLE_ROW(P, T) { P##1_##T##_1, P##1_##T##_2, P##1_##T##_3, P##1_##T##_4 },
+#define PAIR_ROW(P, T, A1) { P##2_##T##_##A1##_1, P##2_##T##_##A1##_2, P##2_##T##_##A1##_3, P##2_##T##_##A1##_4 }
+#define PAIR_TABLE(P, T) { PAIR_ROW(P, T, 1), PAIR_ROW(P, T, 2), PAIR_ROW(P, T, 3), PAIR_ROW(P, T, 4) },
+
+static const spec_kernel_t single_pack_kernels[4][MAX_SPECIALIZED_BLOCKLEN] = {
+    FOR_EACH_ELEMTYPE(SINGLE_ROW, pack)
+};
+static const spec_kernel_t single_unpack_kernels[4][MAX_SPECIALIZED_BLOCKLEN] = {
+    FOR_EACH_ELEMTYPE(SINGLE_ROW, unpack)
+};
+static const spec_kernel_t pair_pack_kernels[4][MAX_SPECIALIZED_BLOCKLEN][MAX_SPECIALIZED_BLOCKLEN] = {
+    FOR_EACH_ELEMTYPE(PAIR_TABLE, pack)
+};
+static const spec_kernel_t pair_unpack_kernels[4][MAX_SPECIALIZED_BLOCKLEN][MAX_SPECIALIZED_BLOCKLEN] = {
+    FOR_EACH_ELEMTYPE(PAIR_TABLE, unpack)
+};
+
+
+/* generic kernels for periodic layouts with arbitrary block lengths or unaligned blocks */
+static void pack1_generic(const char *in, char *out, const periodic_shape_t *s) {
+    const char *src = in + s->first;
+    size_t p;
+
+    for (p = 0; p < s->nperiods; p++) {
+        memcpy(out, src + p * s->period, s->len1);
+        out += s->len1;
+    }
+}
+
+static void unpack1_generic(const char *in, char *out, const periodic_shape_t *s) {
+    char *dst = out + s->first;
+    size_t p;
+
+    for (p = 0; p < s->nperiods; p++) {
+        memcpy(dst + p * s->period, in, s->len1);
+        in += s->len1;
+    }
+}
+
+static void pack2_generic(const char *in, char *out, const periodic_shape_t *s) {
+    const char *src = in + s->first;
+    size_t p;
+
+    for (p = 0; p < s->nperiods; p++) {
+        memcpy(out, src + p * s->period, s->len1);
+        memcpy(out + s->len1, src + p * s->period + s->delta, s->len2);
+        out += s->len1 + s->len2;
+    }
+}
+
+static void unpack2_generic(const char *in, char *out, const periodic_shape_t *s) {
+    char *dst = out + s->first;
+    size_t p;
+
+    for (p = 0; p < s->nperiods; p++) {
+        memcpy(dst + p * s->period, in, s->len1);
+        memcpy(dst + p * s->period + s->delta, in + s->len1, s->len2);
+        in += s->len1 + s->len2;
+    }
+}
+
+
+// finds a period of one or two blocks in the flattened layout
+static int detect_periodic_shape(const typemap_t *map, periodic_shape_t *s) {
+    size_t n = map->nblocks;
+    size_t i;
+    int ok;
+
+    s->periodic = 0;
+    if (n == 0) {
+        return 0;
+    }
+
+    // one block per period: constant block length and stride
+    ok = 1;
+    for (i = 1; i < n && ok; i++) {
+        ok = (map->lengths[i] == map->lengths[0]) &&
+             (map->offsets[i] - map->offsets[i - 1] == map->offsets[1] - map->offsets[0]);
+    }
+    if (ok) {
+        s->periodic = 1;
+        s->blocks_per_period = 1;
+        s->first = map->offsets[0];
+        s->period = (n > 1) ? map->offsets[1] - map->offsets[0] : 0;
+        s->delta = 0;
+        s->len1 = map->lengths[0];
+        s->len2 = 0;
+        s->nperiods = n;
+        s->tail = n;
+        return 1;
+    }
+
+    // two alternating blocks per period, a last incomplete period is copied separately
+    if (n < 3) {
+        return 0;
+    }
+    s->first = map->offsets[0];
+    s->delta = map->offsets[1] - map->offsets[0];
+    s->period = map->offsets[2] - map->offsets[0];
+    s->len1 = map->lengths[0];
+    s->len2 = map->lengths[1];
+    s->nperiods = n / 2;
+    for (i = 0; i < s->nperiods; i++) {
+        if (map->lengths[2 * i] != s->len1 || map->lengths[2 * i + 1] != s->len2 ||
+            map->offsets[2 * i] != s->first + (MPI_Aint)i * s->period ||
+            map->offsets[2 * i + 1] != map->offsets[2 * i] + s->delta) {
+            return 0;
+        }
+    }
+    s->periodic = 1;
+    s->blocks_per_period = 2;
+    s->tail = 2 * s->nperiods;
+    return 1;
+}
+
+
+static int elemsize_index(int esize) {
+    switch (esize) {
+    case 1: return 0;
+    case 2: return 1;
+    case 4: return 2;
+    case 8: return 3;
+    }
+    return -1;
+}
+
+
+int specialized_pack_init(pack_handle_t *handle, MPI_Datatype type, int count) {
+    periodic_shape_t *s;
+    MPI_Datatype elem;
+    int esize, idx;
+    MPI_Aint a1, a2;
+
+    s = (periodic_shape_t*)malloc(sizeof(periodic_shape_t));
+    assert(s != NULL);
+    handle->state = s;
+
+    if (!detect_periodic_shape(&handle->map, s)) {
+        fprintf(stderr, "WARNING: layout is not periodic, specialized pack engine uses memcpy\n");
+        return MPI_SUCCESS;
+    }
+
+    elem = (handle->map.basetype == MPI_DATATYPE_NULL) ? MPI_BYTE : handle->map.basetype;
+    MPI_Type_size(elem, &esize);
+    idx = elemsize_index(esize);
+
+    if (s->blocks_per_period == 1) {
+        s->pack = pack1_generic;
+        s->unpack = unpack1_generic;
+    } else {
+        s->pack = pack2_generic;
+        s->unpack = unpack2_generic;
+    }
+
+    // typed kernels need element-aligned blocks
+    if (idx < 0 || s->first % esize != 0 || s->delta % esize != 0 || s->period % esize != 0 ||
+        s->len1 % esize != 0 || s->len2 % esize != 0) {
+        return MPI_SUCCESS;
+    }
+    a1 = s->len1 / esize;
+    a2 = s->len2 / esize;
+
+    if (s->blocks_per_period == 1 && a1 <= MAX_SPECIALIZED_BLOCKLEN) {
+        s->pack = single_pack_kernels[idx][a1 - 1];
+        s->unpack = single_unpack_kernels[idx][a1 - 1];
+    } else if (s->blocks_per_period == 2 && a1 <= MAX_SPECIALIZED_BLOCKLEN && a2 <= MAX_SPECIALIZED_BLOCKLEN) {
+        s->pack = pair_pack_kernels[idx][a1 - 1][a2 - 1];
+        s->unpack = pair_unpack_kernels[idx][a1 - 1][a2 - 1];
+    }
+
+    return MPI_SUCCESS;
+}
+
+
+void specialized_pack(const pack_handle_t *handle, const void *inbuf, void *packbuf) {
+    const periodic_shape_t *s = (const periodic_shape_t*)handle->state;
+    const char *in = (const char*)inbuf;
+    char *out = (char*)packbuf;
+    size_t i;
+
+    if (!s->periodic) {
+        manual_pack(handle, inbuf, packbuf);
+        return;
+    }
+
+    s->pack(in, out, s);
+    out += s->nperiods * (s->len1 + s->len2);
+    for (i = s->tail; i < handle->map.nblocks; i++) {
+        memcpy(out, in + handle->map.offsets[i], handle->map.lengths[i]);
+        out += handle->map.lengths[i];
+    }
+}
+
+
+void specialized_unpack(const pack_handle_t *handle, const void *packbuf, void *outbuf) {
+    const periodic_shape_t *s = (const periodic_shape_t*)handle->state;
+    const char *in = (const char*)packbuf;
+    char *out = (char*)outbuf;
+    size_t i;
+
+    if (!s->periodic) {
+        manual_unpack(handle, packbuf, outbuf);
+        return;
+    }
+
+    s->unpack(in, out, s);
+    in += s->nperiods * (s->len1 + s->len2);
+    for (i = s->tail; i < handle->map.nblocks; i++) {
+        memcpy(out + handle->map.offsets[i], in, handle->map.lengths[i]);
+        in += handle->map.lengths[i];
+    }
+}
+
+
+void specialized_pack_cleanup(pack_handle_t *handle) {
+    free(handle->state);
+    handle->state = NULL;
+}
@@ -0,0 +1,251 @@
+/*  MPI-Datatybe - MPI Datatype Benchmark
+ *  
+ *  Copyright 2017 Alexandra Carpen-Amarie, Sascha Hunold, Jesper Larsson Träff
+ *      Research Group for Parallel Computing
+ *      Faculty of Informatics
+ *      Vienna University of Technology, Austria
+ *  
+ *  <license>
+ *      This program is free software: you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation, either version 2 of the License, or
+ *      (at your option) any later version.
+ *  
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *  
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *  </license>
+ */
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <mpi.h>
+
+#include "threaded_pack.h"
+
+// smallest byte range worth handing to a separate thread
+#define MIN_CHUNK_BYTES 4096
+
+typedef enum ThreadOps {
+    op_pack,
+    op_unpack,
+    op_exit
+} thread_op_t;
+
+// bytes [pack_offset, pack_offset + nbytes) of the packed buffer
+typedef struct chunk {
+    size_t first_block;
+    MPI_Aint first_skip;    // bytes of first_block packed by the previous chunk
+    size_t pack_offset;
+    size_t nbytes;
+} chunk_t;
+
+typedef struct thread_pool thread_pool_t;
+
+typedef struct worker {
+    thread_pool_t *pool;
+    int id;
+} worker_t;
+
+struct thread_pool {
+    const typemap_t *map;
+    int nthreads;
+    chunk_t *chunks;
+    pthread_t *threads;
+    worker_t *workers;
+    pthread_barrier_t start;
+    pthread_barrier_t done;
+
+    // arguments of the current operation
+    thread_op_t op;
+    const char *inbuf;
+    char *outbuf;
+};
+
+static int pack_threads = 0;
+static int default_pack_threads = 1;
+
+
+void set_pack_threads(int nthreads) {
+    pack_threads = nthreads;
+}
+
+
+void init_default_pack_threads(MPI_Comm comm) {
+    MPI_Comm node_comm;
+    long ncores;
+    int nlocal;
+
+    MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &node_comm);
+    MPI_Comm_size(node_comm, &nlocal);
+    MPI_Comm_free(&node_comm);
+
+    ncores = sysconf(_SC_NPROCESSORS_ONLN);
+    default_pack_threads = (ncores > nlocal) ? (int)(ncores / nlocal) : 1;
+}
+
+
+int get_pack_threads(void) {
+    if (pack_threads > 0) {
+        return pack_threads;
+    }
+    return default_pack_threads;
+}
+
+
+static void copy_chunk(const typemap_t *map, const chunk_t *chunk, thread_op_t op,
+        const char *inbuf, char *outbuf) {
+    size_t i = chunk->first_block;
+    MPI_Aint skip = chunk->first_skip;
+    size_t remaining = chunk->nbytes;
+    size_t packpos = chunk->pack_offset;
+
+    while (remaining > 0) {
+        size_t len = map->lengths[i] - skip;
+
+        if (len > remaining) {
+            len = remaining;
+        }
+        if (op == op_pack) {
+            memcpy(outbuf + packpos, inbuf + map->offsets[i] + skip, len);
+        } else {
+            memcpy(outbuf + map->offsets[i] + skip, inbuf + packpos, len);
+        }
+        packpos += len;
+        remaining -= len;
+        skip = 0;
+        i++;
+    }
+}
+
+
+static void* worker_loop(void *arg) {
+    worker_t *w = (worker_t*)arg;
+    thread_pool_t *pool = w->pool;
+
+    while (1) {
+        pthread_barrier_wait(&pool->start);
+        if (pool->op == op_exit) {
+            break;
+        }
+        copy_chunk(pool->map, &pool->chunks[w->id], pool->op, pool->inbuf, pool->outbuf);
+        pthread_barrier_wait(&pool->done);
+    }
+    return NULL;
+}
+
+
+// each thread gets packsize/nthreads bytes, regardless of how many blocks they span
+static void partition_typemap(thread_pool_t *pool) {
+    const typemap_t *map = pool->map;
+    size_t total = (size_t)map->size;
+    size_t block = 0;
+    size_t block_start = 0;    // packed position of the current block
+    int t;
+
+    for (t = 0; t < pool->nthreads; t++) {
+        size_t begin = total * t / pool->nthreads;
+        size_t end = total * (t + 1) / pool->nthreads;
+
+        while (block < map->nblocks && block_start + map->lengths[block] <= begin) {
+            block_start += map->lengths[block];
+            block++;
+        }
+        pool->chunks[t].first_block = block;
+        pool->chunks[t].first_skip = begin - block_start;
+        pool->chunks[t].pack_offset = begin;
+        pool->chunks[t].nbytes = end - begin;
+    }
+}
+
+
+int threaded_pack_init(pack_handle_t *handle, MPI_Datatype type, int count) {
+    thread_pool_t *pool;
+    int nthreads = get_pack_threads();
+    int t, ret;
+
+    // chunks below MIN_CHUNK_BYTES only add synchronization
+    if ((size_t)nthreads > (size_t)handle->map.size / MIN_CHUNK_BYTES) {
+        nthreads = (int)((size_t)handle->map.size / MIN_CHUNK_BYTES);
+    }
+    if (nthreads < 1) {
+        nthreads = 1;
+    }
+
+    pool = (thread_pool_t*)malloc(sizeof(thread_pool_t));
+    assert(pool != NULL);
+    pool->map = &handle->map;
+    pool->nthreads = nthreads;
+    pool->chunks = (chunk_t*)malloc(nthreads * sizeof(chunk_t));
+    pool->threads = (pthread_t*)malloc(nthreads * sizeof(pthread_t));
+    pool->workers = (worker_t*)malloc(nthreads * sizeof(worker_t));
+    assert(pool->chunks != NULL && pool->threads != NULL && pool->workers != NULL);
+    partition_typemap(pool);
+
+    pthread_barrier_init(&pool->start, NULL, nthreads);
+    pthread_barrier_init(&pool->done, NULL, nthreads);
+
+    // thread 0 is the calling thread
+    for (t = 1; t < nthreads; t++) {
+        pool->workers[t].pool = pool;
+        pool->workers[t].id = t;
+        ret = pthread_create(&pool->threads[t], NULL, worker_loop, &pool->workers[t]);
+        if (ret != 0) {
+            printf("Error: cannot create pack thread %d\n", t);
+            exit(1);
+        }
+    }
+
+    handle->state = pool;
+    return MPI_SUCCESS;
+}
+
+
+static void run_pool(thread_pool_t *pool, thread_op_t op, const void *inbuf, void *outbuf) {
+    pool->op = op;
+    pool->inbuf = (const char*)inbuf;
+    pool->outbuf = (char*)outbuf;
+
+    pthread_barrier_wait(&pool->start);
+    copy_chunk(pool->map, &pool->chunks[0], op, pool->inbuf, pool->outbuf);
+    pthread_barrier_wait(&pool->done);
+}
+
+
+void threaded_pack(const pack_handle_t *handle, const void *inbuf, void *packbuf) {
+    run_pool((thread_pool_t*)handle->state, op_pack, inbuf, packbuf);
+}
+
+
+void threaded_unpack(const pack_handle_t *handle, const void *packbuf, void *outbuf) {
+    run_pool((thread_pool_t*)handle->state, op_unpack, packbuf, outbuf);
+}
+
+
+void threaded_pack_cleanup(pack_handle_t *handle) {
+    thread_pool_t *pool = (thread_pool_t*)handle->state;
+    int t;
+
+    pool->op = op_exit;
+    pthread_barrier_wait(&pool->start);
+    for (t = 1; t < pool->nthreads; t++) {
+        pthread_join(pool->threads[t], NULL);
+    }
+
+    pthread_barrier_destroy(&pool->start);
+    pthread_barrier_destroy(&pool->done);
+    free(pool->chunks);
+    free(pool->threads);
+    free(pool->workers);
+    free(pool);
+    handle->state = NULL;
+}
@@ -0,0 +1,46 @@
+/*  MPI-Datatybe - MPI Datatype Benchmark
+ *  
+ *  Copyright 2017 Alexandra Carpen-Amarie, Sascha Hunold, Jesper Larsson Träff
+ *      Research Group for Parallel Computing
+ *      Faculty of Informatics
+ *      Vienna University of Technology, Austria
+ *  
+ *  <license>
+ *      This program is free software: you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation, either version 2 of the License, or
+ *      (at your option) any later version.
+ *  
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *  
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *  </license>
+ */
+
+
+#ifndef THREADED_PACK_H_
+#define THREADED_PACK_H_
+
+#include "pack_engine.h"
+
+/* splits the flattened layout into byte-balanced chunks (blocks may be split
+ * between threads) packed and unpacked in parallel by a pool of threads;
+ * the pool is created in the (not measured) initialization and reused for every call */
+int threaded_pack_init(pack_handle_t *handle, MPI_Datatype type, int count);
+void threaded_pack(const pack_handle_t *handle, const void *inbuf, void *packbuf);
+void threaded_unpack(const pack_handle_t *handle, const void *packbuf, void *outbuf);
+void threaded_pack_cleanup(pack_handle_t *handle);
+
+// number of threads (including the calling one) used by the handles initialized afterwards
+void set_pack_threads(int nthreads);
+int get_pack_threads(void);
+
+/* default number of threads: the online cores divided by the processes of comm on the same node
+ * (at least 1; 1 if this is not called); collective over comm */
+void init_default_pack_threads(MPI_Comm comm);
+
+#endif /* THREADED_PACK_H_ */
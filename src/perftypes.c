@@ -26,10 +26,16 @@
 #include <stdio.h>
 #include <string.h>
 #include <assert.h>
+#include <limits.h>
+#include <math.h>
 #include <mpi.h>
 
 #include "perftypes.h"
 #include "util.h"
+#include "dictionary/dictionary_helpers.h"
+#include "large_count.h"
+#include "layout_expr/layout_expr.h"
+#include "typemap/typemap.h"
 
 /* type constructors for investigating guidelines and performance */
 /* types are not committed and not freed; all intermediate types are freed */
@@ -307,7 +313,7 @@ int bl_tiled_struct(dictionary_t *dict, MPI_Datatype *t, int* flags)
 // take a basic layout with one sub-type T1 and create a longer type T2 consisting of n/A (n/typesize) many T1s
 int dl_contig_type(dictionary_t *dict, MPI_Datatype *t, int* flags) {
   MPI_Datatype t1, b;
-  int n;
+  long long n;
   int typesize;
   char *sub;
   MPI_Aint lb, eb;
@@ -315,7 +321,7 @@ int dl_contig_type(dictionary_t *dict, MPI_Datatype *t, int* flags) {
 
   *flags = 0;
 
-  n = get_int_value_from_dict("n", dict);
+  n = get_long_value_from_dict("n", dict);
   b = get_basetype_value_from_dict("b", dict);
   ret = get_value_from_dict(dict, "subtype", &sub);
   if (ret !=0 || sub == NULL) {
@@ -341,7 +347,7 @@ int dl_contig_type(dictionary_t *dict, MPI_Datatype *t, int* flags) {
   }
 
   MPI_Type_size(t1, &typesize);
-  MPI_Type_contiguous(n*eb / typesize, t1, t);
+  large_type_contiguous(n*eb / typesize, t1, t);
   MPI_Type_commit(t);
 
   free(sub);
@@ -353,6 +359,76 @@ int dl_contig_type(dictionary_t *dict, MPI_Datatype *t, int* flags) {
 /* dynamic layouts */
 /*******************************************************/
 
+/* indexed constructors for displacements (in elements of b) computed as MPI_Aint:
+ * the int-based constructors are used as long as the count and all displacements fit into an int,
+ * otherwise the hindexed variants with byte displacements (see large_count.h for counts beyond INT_MAX) */
+static int displacements_fit_int(MPI_Count count, const MPI_Aint *displs) {
+    MPI_Count i;
+
+    if (count > INT_MAX) {
+        return 0;
+    }
+
+    for (i=0; i<count; i++) {
+        if (displs[i] > INT_MAX || displs[i] < INT_MIN) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void create_indexed_block_aint(MPI_Count count, int blocklength, const MPI_Aint *displs,
+    MPI_Datatype b, MPI_Datatype *t)
+{
+    MPI_Aint lb, eb;
+    MPI_Aint *bytes;
+    int *index;
+    MPI_Count i;
+
+    if (displacements_fit_int(count, displs)) {
+        index = (int*)malloc(count * sizeof(int));
+        for (i=0; i<count; i++) {
+            index[i] = (int)displs[i];
+        }
+        MPI_Type_create_indexed_block((int)count, blocklength, index, b, t);
+        free(index);
+    } else {
+        MPI_Type_get_extent(b, &lb, &eb);
+        bytes = (MPI_Aint*)malloc(count * sizeof(MPI_Aint));
+        for (i=0; i<count; i++) {
+            bytes[i] = displs[i] * eb;
+        }
+        large_type_create_hindexed_block(count, blocklength, bytes, b, t);
+        free(bytes);
+    }
+}
+
+static void create_indexed_aint(MPI_Count count, const int *blocklengths, const MPI_Aint *displs,
+    MPI_Datatype b, MPI_Datatype *t)
+{
+    MPI_Aint lb, eb;
+    MPI_Aint *bytes;
+    int *index;
+    MPI_Count i;
+
+    if (displacements_fit_int(count, displs)) {
+        index = (int*)malloc(count * sizeof(int));
+        for (i=0; i<count; i++) {
+            index[i] = (int)displs[i];
+        }
+        MPI_Type_indexed((int)count, blocklengths, index, b, t);
+        free(index);
+    } else {
+        MPI_Type_get_extent(b, &lb, &eb);
+        bytes = (MPI_Aint*)malloc(count * sizeof(MPI_Aint));
+        for (i=0; i<count; i++) {
+            bytes[i] = displs[i] * eb;
+        }
+        large_type_create_hindexed(count, blocklengths, bytes, b, t);
+        free(bytes);
+    }
+}
+
 
 // elements (n/(A1+A2))*(A1+A2), extent (n/(A1+A2))*(B+A2)
 int dl_alternating_repeated(dictionary_t *dict, MPI_Datatype *t, int* flags)
@@ -361,7 +437,7 @@ int dl_alternating_repeated(dictionary_t *dict, MPI_Datatype *t, int* flags)
     MPI_Datatype t1;
     int block[2], displ[2];
 
-    int n;
+    long long n;
     int A1, A2, B;
     MPI_Datatype b;
 
@@ -371,7 +447,7 @@ int dl_alternating_repeated(dictionary_t *dict, MPI_Datatype *t, int* flags)
     A2 = get_int_value_from_dict("A2", dict);
     B = get_int_value_from_dict("B", dict);
     b = get_basetype_value_from_dict("b", dict);
-    n = get_int_value_from_dict("n", dict);
+    n = get_long_value_from_dict("n", dict);
 
     assert(A1>0);
     assert(A2>0); // we allow degenerate case with A1==A2
@@ -385,7 +461,7 @@ int dl_alternating_repeated(dictionary_t *dict, MPI_Datatype *t, int* flags)
 
     MPI_Type_get_extent(b,&lb,&eb); // get extent of basetype
     MPI_Type_indexed(2,block,displ,b,&t1);
-    MPI_Type_contiguous(n/(A1+A2),t1,t); // question: will this be normalized?
+    large_type_contiguous(n/(A1+A2),t1,t); // question: will this be normalized?
     // hypothesis: it will not, countercheck with manually created normalform
     MPI_Type_free(&t1);
 
@@ -404,7 +480,7 @@ int dl_alternating_struct(dictionary_t *dict, MPI_Datatype *t, int* flags)
     MPI_Datatype dtype[3], t1;
     MPI_Aint newlb, newextent;
 
-    int n;
+    long long n;
     int A1, A2, B;
     MPI_Datatype b;
 
@@ -414,7 +490,7 @@ int dl_alternating_struct(dictionary_t *dict, MPI_Datatype *t, int* flags)
     A2 = get_int_value_from_dict("A2", dict);
     B = get_int_value_from_dict("B", dict);
     b = get_basetype_value_from_dict("b", dict);
-    n = get_int_value_from_dict("n", dict);
+    n = get_long_value_from_dict("n", dict);
 
     assert(A1>0);
     assert(A2>0); // we allow degenerate case with A1==A2
@@ -429,7 +505,7 @@ int dl_alternating_struct(dictionary_t *dict, MPI_Datatype *t, int* flags)
 
     block[1] = 1;
     displ[1] = B*eb;
-    MPI_Type_vector(n/(A2+A1)-1,(A2+A1),A2+B,b,&dtype[1]);
+    large_type_vector(n/(A2+A1)-1,(A2+A1),A2+B,b,&dtype[1]);
 
     block[2] = A2;
     displ[2] = (((n/(A1+A2)-1)*(B+A2))+B)*eb;
@@ -458,7 +534,7 @@ int dl_tiled_vector(dictionary_t *dict, MPI_Datatype *t, int* flags)
     MPI_Datatype t1;
     MPI_Aint lb, eb;
 
-    int n;
+    long long n;
     int A, B;
     MPI_Datatype b;
 
@@ -467,7 +543,7 @@ int dl_tiled_vector(dictionary_t *dict, MPI_Datatype *t, int* flags)
     A = get_int_value_from_dict("A", dict);
     B = get_int_value_from_dict("B", dict);
     b = get_basetype_value_from_dict("b", dict);
-    n = get_int_value_from_dict("n", dict);
+    n = get_long_value_from_dict("n", dict);
 
     assert(n>0);
     assert(A>0);
@@ -477,7 +553,7 @@ int dl_tiled_vector(dictionary_t *dict, MPI_Datatype *t, int* flags)
 
     MPI_Type_get_extent(b,&lb,&eb); // get extent of basetype
 
-    MPI_Type_vector(n/A,A,B,b,&t1);
+    large_type_vector(n/A,A,B,b,&t1);
     MPI_Type_create_resized(t1,0,(n/A)*B*eb,t);
     MPI_Type_free(&t1); // make sure intermediate type is eventually freed
 
@@ -494,12 +570,13 @@ int dl_vector_tiled(dictionary_t *dict, MPI_Datatype *t, int* flags)
   MPI_Datatype v;
   int bs;
 
-  int n, A, B, S;
+  long long n;
+  int A, B, S;
   MPI_Datatype b;
 
   *flags = 0;
 
-  n = get_int_value_from_dict("n", dict);
+  n = get_long_value_from_dict("n", dict);
   A = get_int_value_from_dict("A", dict);
   B = get_int_value_from_dict("B", dict);
   S = get_int_value_from_dict("S", dict);
@@ -511,33 +588,118 @@ int dl_vector_tiled(dictionary_t *dict, MPI_Datatype *t, int* flags)
 
   MPI_Type_size(b,&bs);
   MPI_Type_vector(S,A,B,b,&v);
-  MPI_Type_create_hvector(n/(S*A),1,S*B*bs,v,t);
+  large_type_create_hvector(n/(S*A),1,(MPI_Aint)S*B*bs,v,t);
   MPI_Type_free(&v);
 
   return MPI_SUCCESS;
 }
 
 
+// tiled layout (as tiled_vector) wrapped in k levels of constructors with count 1
+// (wrap: contig, vector, struct, resized or mixed, which cycles through the four);
+// every level keeps the typemap, lb and extent of the wrapped type
+int dl_nested_depth(dictionary_t *dict, MPI_Datatype *t, int* flags)
+{
+  MPI_Datatype t1, t2;
+  MPI_Aint lb, eb, extent;
+  MPI_Aint displ;
+  int one;
+  int i, kind;
+  char *wrap;
+  int ret;
+
+  long long n;
+  int A, B, k;
+  MPI_Datatype b;
+
+  *flags = 0;
+
+  n = get_long_value_from_dict("n", dict);
+  A = get_int_value_from_dict("A", dict);
+  B = get_int_value_from_dict("B", dict);
+  k = get_int_value_from_dict("k", dict);
+  b = get_basetype_value_from_dict("b", dict);
+
+  assert(n>=A);
+  assert(A>0);
+  assert(A<=B);
+  assert(k>=0);
+
+  ret = get_value_from_dict(dict, "wrap", &wrap);
+  if (ret != 0 || wrap == NULL) {
+    printf("\nError: required parameter \"%s\" is not specified. \n", "wrap");
+    exit(1);
+  }
+  if (strcmp(wrap, "contig") == 0) {
+    kind = 0;
+  } else if (strcmp(wrap, "vector") == 0) {
+    kind = 1;
+  } else if (strcmp(wrap, "struct") == 0) {
+    kind = 2;
+  } else if (strcmp(wrap, "resized") == 0) {
+    kind = 3;
+  } else if (strcmp(wrap, "mixed") == 0) {
+    kind = -1;
+  } else {
+    printf("Error: wrap has to be contig, vector, struct, resized or mixed\n");
+    exit(1);
+  }
+  free(wrap);
+
+  MPI_Type_get_extent(b,&lb,&eb); // get extent of basetype
+  extent = (MPI_Aint)(n/A)*B*eb;
+
+  large_type_vector(n/A,A,B,b,&t2);
+  MPI_Type_create_resized(t2,0,extent,&t1);
+  MPI_Type_free(&t2);
+
+  one = 1;
+  displ = 0;
+  for (i=0; i<k; i++) {
+    switch ((kind < 0) ? i % 4 : kind) {
+    case 0:
+      MPI_Type_contiguous(1,t1,&t2);
+      break;
+    case 1:
+      MPI_Type_vector(1,1,1,t1,&t2);
+      break;
+    case 2:
+      MPI_Type_create_struct(1,&one,&displ,&t1,&t2);
+      break;
+    default:
+      MPI_Type_create_resized(t1,0,extent,&t2);
+      break;
+    }
+    MPI_Type_free(&t1);
+    t1 = t2;
+  }
+
+  *t = t1;
+  return MPI_SUCCESS;
+}
+
+
 // explicit description of block layout (paper)
 int dl_block_indexed(dictionary_t *dict, MPI_Datatype *t, int* flags)
 {
   //int index[n/A];
-  int *index;
-  int i;
+  MPI_Aint *index;
+  long long i;
   int s;
 
-  int n, A, B1, B2;
+  long long n;
+  int A, B1, B2;
   MPI_Datatype b;
 
   *flags = 0;
 
-  n = get_int_value_from_dict("n", dict);
+  n = get_long_value_from_dict("n", dict);
   A = get_int_value_from_dict("A", dict);
   B1 = get_int_value_from_dict("B1", dict);
   B2 = get_int_value_from_dict("B2", dict);
   b = get_basetype_value_from_dict("b", dict);
 
-  index = (int*)calloc(n/A, sizeof(int));
+  index = (MPI_Aint*)calloc(n/A, sizeof(MPI_Aint));
 
   assert(A>0);
   assert(B1>=A);
@@ -548,7 +710,7 @@ int dl_block_indexed(dictionary_t *dict, MPI_Datatype *t, int* flags)
     s = (i%2==1) ? B1 : B2;
     index[i] = index[i-1]+s;
   }
-  MPI_Type_create_indexed_block(n/A,A,index,b,t);
+  create_indexed_block_aint(n/A,A,index,b,t);
 
   free(index);
 
@@ -562,15 +724,16 @@ int dl_alternating_indexed(dictionary_t *dict, MPI_Datatype *t, int* flags)
   //int block[n];
   //int index[n];
   int *block;
-  int *index;
-  int i, j;
+  MPI_Aint *index;
+  long long i, j;
 
-  int n, A1, A2, B1, B2;
+  long long n;
+  int A1, A2, B1, B2;
   MPI_Datatype b;
 
   *flags = 0;
 
-  n = get_int_value_from_dict("n", dict);
+  n = get_long_value_from_dict("n", dict);
   A1 = get_int_value_from_dict("A1", dict);
   A2 = get_int_value_from_dict("A2", dict);
   B1 = get_int_value_from_dict("B1", dict);
@@ -583,7 +746,7 @@ int dl_alternating_indexed(dictionary_t *dict, MPI_Datatype *t, int* flags)
   assert(B2>=A2);
 
   block = (int*)calloc(n, sizeof(int));
-  index = (int*)calloc(n, sizeof(int));
+  index = (MPI_Aint*)calloc(n, sizeof(MPI_Aint));
 
   block[0] = A1;
   index[0] = 0;
@@ -601,9 +764,190 @@ int dl_alternating_indexed(dictionary_t *dict, MPI_Datatype *t, int* flags)
     j++;
   }
   if (i>n) j--;
-  MPI_Type_indexed(j,block,index,b,t);
+  create_indexed_aint(j,block,index,b,t);
+
+  free(block);
+  free(index);
+
+  return MPI_SUCCESS;
+}
+
+
+/* random irregular layouts */
+
+typedef enum RandomDistributions {
+  DIST_UNIFORM,
+  DIST_GEOMETRIC,
+  DIST_POWERLAW,
+  DIST_BIMODAL
+} random_dist_t;
+
+// xorshift64* generator: the same sequence for a given seed on all processes and platforms
+static unsigned long long next_random(unsigned long long *state) {
+  *state ^= *state >> 12;
+  *state ^= *state << 25;
+  *state ^= *state >> 27;
+  return *state * 0x2545F4914F6CDD1DULL;
+}
+
+// uniform in [0,1)
+static double next_uniform(unsigned long long *state) {
+  return (next_random(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// draws an integer in [lo,hi]
+// uniform: all values equally likely
+// geometric: P(lo+k) ~ (1-shape)^k, shape in (0,1]
+// powerlaw: P(lo+k) ~ (k+1)^-shape, shape > 0
+// bimodal: lo with probability shape, hi otherwise
+static long long draw_random_length(random_dist_t dist, double shape, long long lo, long long hi,
+    unsigned long long *state) {
+  double u, x;
+  long long m, k;
+
+  m = hi - lo + 1;
+  u = next_uniform(state);
+  switch (dist) {
+  case DIST_GEOMETRIC:
+    if (shape >= 1.0) {
+      k = 0;
+    } else {
+      k = (long long)floor(log(1.0 - u * (1.0 - pow(1.0 - shape, (double)m))) / log(1.0 - shape));
+    }
+    break;
+  case DIST_POWERLAW:
+    // continuous inverse transform on [1,m+1), rounded down
+    if (fabs(shape - 1.0) < 1e-9) {
+      x = exp(u * log((double)(m + 1)));
+    } else {
+      x = pow(1.0 + u * (pow((double)(m + 1), 1.0 - shape) - 1.0), 1.0 / (1.0 - shape));
+    }
+    k = (long long)floor(x) - 1;
+    break;
+  case DIST_BIMODAL:
+    k = (u < shape) ? 0 : m - 1;
+    break;
+  default:
+    k = (long long)(u * m);
+    break;
+  }
+  if (k < 0) {
+    k = 0;
+  }
+  if (k > m - 1) {
+    k = m - 1;
+  }
+  return lo + k;
+}
+
+// parses <distribution>[/<shape>]
+static void get_random_distribution(const dictionary_t *dict, random_dist_t *dist, double *shape) {
+  string_array_t* spec;
+  int i;
+
+  spec = get_string_array_from_dict("dist", dict);
+  if (spec->n_elems < 1) {
+    printf("\nError: required parameter \"%s\" is not specified. \n", "dist");
+    exit(1);
+  }
+
+  *shape = 0;
+  if (strcmp(spec->elements[0], "uniform") == 0) {
+    *dist = DIST_UNIFORM;
+  } else if (strcmp(spec->elements[0], "geometric") == 0) {
+    *dist = DIST_GEOMETRIC;
+  } else if (strcmp(spec->elements[0], "powerlaw") == 0) {
+    *dist = DIST_POWERLAW;
+  } else if (strcmp(spec->elements[0], "bimodal") == 0) {
+    *dist = DIST_BIMODAL;
+  } else {
+    printf("Error: unknown distribution %s\n", spec->elements[0]);
+    exit(1);
+  }
+
+  if (*dist != DIST_UNIFORM) {
+    if (spec->n_elems < 2) {
+      printf("Error: distribution %s requires a parameter (e.g., %s/0.5)\n", spec->elements[0], spec->elements[0]);
+      exit(1);
+    }
+    *shape = to_double(spec->elements[1]);
+    if ((*dist == DIST_POWERLAW && *shape <= 0) ||
+        (*dist != DIST_POWERLAW && (*shape <= 0 || *shape > 1))) {
+      printf("Error: invalid parameter %s of distribution %s\n", spec->elements[1], spec->elements[0]);
+      exit(1);
+    }
+  }
+
+  for (i=0; i<spec->n_elems; i++) {
+    free(spec->elements[i]);
+  }
+  free(spec->elements);
+  free(spec);
+}
+
+
+// n elements in blocks of random length in [A1,A2] separated by random gaps in [G1,G2],
+// both drawn from the distribution dist (uniform, geometric/p, powerlaw/alpha or bimodal/p);
+// the last block is shortened to get exactly n elements
+int dl_random_indexed(dictionary_t *dict, MPI_Datatype *t, int* flags)
+{
+  int *block;
+  MPI_Aint *index;
+  long long i, len;
+  long long j, max_blocks;
+  MPI_Aint pos;
+  unsigned long long state;
+
+  long long n, seed;
+  int A1, A2, G1, G2;
+  random_dist_t dist;
+  double shape;
+  MPI_Datatype b;
+
+  *flags = 0;
+
+  n = get_long_value_from_dict("n", dict);
+  A1 = get_int_value_from_dict("A1", dict);
+  A2 = get_int_value_from_dict("A2", dict);
+  G1 = get_int_value_from_dict("G1", dict);
+  G2 = get_int_value_from_dict("G2", dict);
+  seed = get_long_value_from_dict("seed", dict);
+  get_random_distribution(dict, &dist, &shape);
+  b = get_basetype_value_from_dict("b", dict);
+
+  assert(A1>0);
+  assert(A2>=A1);
+  assert(G1>=0);
+  assert(G2>=G1);
+
+  // the state of the generator must not be 0
+  state = (unsigned long long)seed * 0x9E3779B97F4A7C15ULL + 1;
+
+  max_blocks = 1024;
+  block = (int*)malloc(max_blocks * sizeof(int));
+  index = (MPI_Aint*)malloc(max_blocks * sizeof(MPI_Aint));
+
+  i = 0; j = 0; pos = 0;
+  while (i<n) {
+    if (j == max_blocks) {
+      max_blocks *= 2;
+      block = (int*)realloc(block, max_blocks * sizeof(int));
+      index = (MPI_Aint*)realloc(index, max_blocks * sizeof(MPI_Aint));
+    }
+    len = draw_random_length(dist, shape, A1, A2, &state);
+    if (len > n - i) {
+      len = n - i;
+    }
+    block[j] = len;
+    index[j] = pos;
+    pos += len + draw_random_length(dist, shape, G1, G2, &state);
+    i += len;
+    j++;
+  }
+  create_indexed_aint(j,block,index,b,t);
 
   free(block);
+  free(index);
 
   return MPI_SUCCESS;
 }
@@ -616,19 +960,19 @@ int dl_alternating_indexed(dictionary_t *dict, MPI_Datatype *t, int* flags)
 // number of elements is n (>=A), extent n*A elements
 int dl_rowcol_full_indexed(dictionary_t *dict, MPI_Datatype *t, int* flags)
 {
-    int i;
-    int n;
+    long long i;
+    long long n;
     int A;
     MPI_Datatype b;
-    int *displ;
+    MPI_Aint *displ;
 
     *flags = 0;
 
     A = get_int_value_from_dict("A", dict);
     b = get_basetype_value_from_dict("b", dict);
-    n = get_int_value_from_dict("n", dict);
+    n = get_long_value_from_dict("n", dict);
 
-    displ = (int*)calloc(n, sizeof(int));
+    displ = (MPI_Aint*)calloc(n, sizeof(MPI_Aint));
 
     assert(A>0);
     assert(n>=A);
@@ -640,7 +984,7 @@ int dl_rowcol_full_indexed(dictionary_t *dict, MPI_Datatype *t, int* flags)
     for (i=A+1; i<n; i++) {
         displ[i] = displ[i-1]+A;
     }
-    MPI_Type_create_indexed_block(n,1,displ,b,t);
+    create_indexed_block_aint(n,1,displ,b,t);
 
     free(displ);
 
@@ -650,21 +994,21 @@ int dl_rowcol_full_indexed(dictionary_t *dict, MPI_Datatype *t, int* flags)
 
 int dl_rowcol_contiguous_and_indexed(dictionary_t *dict, MPI_Datatype *t, int* flags)
 {
-    int i;
-    int n;
+    long long i;
+    long long n;
     int A;
     MPI_Datatype b;
     int *block;
-    int *displ;
+    MPI_Aint *displ;
 
     *flags = 0;
 
     A = get_int_value_from_dict("A", dict);
     b = get_basetype_value_from_dict("b", dict);
-    n = get_int_value_from_dict("n", dict);
+    n = get_long_value_from_dict("n", dict);
 
     block = (int*)calloc(n, sizeof(int));
-    displ = (int*)calloc(n, sizeof(int));
+    displ = (MPI_Aint*)calloc(n, sizeof(MPI_Aint));
 
     assert(A>0);
     assert(n>=A);
@@ -677,7 +1021,7 @@ int dl_rowcol_contiguous_and_indexed(dictionary_t *dict, MPI_Datatype *t, int* f
         block[i] = 1;
         displ[i] = displ[i-1]+A;
     }
-    MPI_Type_indexed(n-A+1,block,displ,b,t);
+    create_indexed_aint(n-A+1,block,displ,b,t);
 
     free(block);
     free(displ);
@@ -693,7 +1037,7 @@ int dl_rowcol_struct(dictionary_t *dict, MPI_Datatype *t, int* flags)
     MPI_Aint displ[2];
     MPI_Datatype dtype[2];
 
-    int n;
+    long long n;
     int A;
     MPI_Datatype b;
 
@@ -701,7 +1045,7 @@ int dl_rowcol_struct(dictionary_t *dict, MPI_Datatype *t, int* flags)
 
     A = get_int_value_from_dict("A", dict);
     b = get_basetype_value_from_dict("b", dict);
-    n = get_int_value_from_dict("n", dict);
+    n = get_long_value_from_dict("n", dict);
 
     assert(A>0);
     assert(n>=A);
@@ -714,7 +1058,7 @@ int dl_rowcol_struct(dictionary_t *dict, MPI_Datatype *t, int* flags)
 
     block[1] = 1;
     displ[1] = A*eb;
-    MPI_Type_vector(n-A,1,A,b,&dtype[1]);
+    large_type_vector(n-A,1,A,b,&dtype[1]);
 
     MPI_Type_create_struct(2,block,displ,dtype,t);
     MPI_Type_free(&dtype[1]);
@@ -727,7 +1071,8 @@ int dl_rowcol_struct(dictionary_t *dict, MPI_Datatype *t, int* flags)
 // number of elements is n/(A*(l/A))*(A*(l/A)), block stride B*(l/A)
 int dl_blocks(dictionary_t *dict, MPI_Datatype *t, int* flags)
 {
-    int n, l;
+    long long n;
+    int l;
     int A, B;
     MPI_Datatype b;
 
@@ -736,13 +1081,13 @@ int dl_blocks(dictionary_t *dict, MPI_Datatype *t, int* flags)
     A = get_int_value_from_dict("A", dict);
     B = get_int_value_from_dict("B", dict);
     b = get_basetype_value_from_dict("b", dict);
-    n = get_int_value_from_dict("n", dict);
+    n = get_long_value_from_dict("n", dict);
     l = get_int_value_from_dict("l", dict);
 
     assert(B>A);
     assert(l>=A);
 
-    MPI_Type_vector(n/(A*(l/A)),(A*(l/A)),B*(l/A),b,t);
+    large_type_vector(n/(A*(l/A)),(A*(l/A)),(long long)B*(l/A),b,t);
 
     return MPI_SUCCESS;
 }
@@ -756,19 +1101,20 @@ int dl_blocks(dictionary_t *dict, MPI_Datatype *t, int* flags)
 int dl_tiled_struct_indexed_all(dictionary_t *dict, MPI_Datatype *t, int* flags)
 {
     MPI_Aint lb, eb;
-    MPI_Datatype t1;
+    MPI_Datatype t1, t1_struct;
     int block[3];
     MPI_Aint displ[3];
     MPI_Datatype dtype[3];
     int *tmp_block;
-    int *tmp_index;
-    int i,j;
-    int tmp_nelems, tmp_nblocks;
+    MPI_Aint *tmp_index;
+    long long i, j;
+    long long tmp_nelems;
+    long long tmp_nblocks;
     MPI_Datatype tmp_type;
     MPI_Aint tmp_extent;
     int outer_block;
 
-    int n;
+    long long n;
     int A, B;
     MPI_Datatype b;
 
@@ -777,7 +1123,7 @@ int dl_tiled_struct_indexed_all(dictionary_t *dict, MPI_Datatype *t, int* flags)
     A = get_int_value_from_dict("A", dict);
     B = get_int_value_from_dict("B", dict);
     b = get_basetype_value_from_dict("b", dict);
-    n = get_int_value_from_dict("n", dict);
+    n = get_long_value_from_dict("n", dict);
 
     assert(A>=1);
     assert(B>=A);
@@ -788,9 +1134,10 @@ int dl_tiled_struct_indexed_all(dictionary_t *dict, MPI_Datatype *t, int* flags)
     outer_block = A - A/2;
     // create inner indexed datatype
     tmp_nelems = n - 2 * outer_block;
-    tmp_nblocks = 2 + (tmp_nelems - 2 * (A - outer_block))/A;
+    // the inner loop may add one partial block, which is removed again below
+    tmp_nblocks = 3 + (tmp_nelems - 2 * (A - outer_block))/A;
     tmp_block = (int*)calloc(tmp_nblocks, sizeof(int));
-    tmp_index = (int*)calloc(tmp_nblocks, sizeof(int));
+    tmp_index = (MPI_Aint*)calloc(tmp_nblocks, sizeof(MPI_Aint));
 
     // first block in the indexed type has A-A/2 elements
     tmp_block[0] = A - outer_block;
@@ -829,7 +1176,7 @@ int dl_tiled_struct_indexed_all(dictionary_t *dict, MPI_Datatype *t, int* flags)
         j--;
     }
 
-    MPI_Type_indexed(j,tmp_block,tmp_index,b,&t1);
+    create_indexed_aint(j,tmp_block,tmp_index,b,&t1);
     MPI_Type_create_resized(t1, 0, (tmp_index[j-1] + tmp_block[j-1]) * eb, &tmp_type);
     MPI_Type_get_extent(tmp_type, &lb, &tmp_extent);
     free(tmp_block);
@@ -850,9 +1197,12 @@ int dl_tiled_struct_indexed_all(dictionary_t *dict, MPI_Datatype *t, int* flags)
 
     //printf("j=%d tmp_nelems=%d index_extent=%d displ=%d i=%d\n", j,tmp_nelems ,tmp_extent,  displ[2], i);
 
-    MPI_Type_create_struct(3,block,displ,dtype,t);
+    // the explicit lower bound of tmp_type would otherwise become the lower bound of the struct
+    MPI_Type_create_struct(3,block,displ,dtype,&t1_struct);
+    MPI_Type_create_resized(t1_struct, 0, displ[2] + outer_block * eb, t);
 
     MPI_Type_free(&t1);
+    MPI_Type_free(&t1_struct);
     MPI_Type_free(&tmp_type);
 
     return MPI_SUCCESS;
@@ -940,14 +1290,14 @@ int bl_alternating_indexed_fixed(dictionary_t *dict, MPI_Datatype *t, int* flags
 int dl_contig_alternating_indexed_fixed(dictionary_t *dict, MPI_Datatype *t, int* flags)
 {
     MPI_Datatype t1, t2, b;
-    int n;
+    long long n;
     int typesize;
     MPI_Aint lb, eb, newlb, newextent;
     int A2;
 
     *flags = 0;
 
-    n = get_int_value_from_dict("n", dict);
+    n = get_long_value_from_dict("n", dict);
     b = get_basetype_value_from_dict("b", dict);
     MPI_Type_get_extent(b, &lb, &eb);
 
@@ -959,7 +1309,7 @@ int dl_contig_alternating_indexed_fixed(dictionary_t *dict, MPI_Datatype *t, int
     MPI_Type_size(t1, &typesize);
 
     // create contiguous type with a total of n basetype elements
-    MPI_Type_contiguous(n*eb / typesize, t1, &t2);
+    large_type_contiguous(n*eb / typesize, t1, &t2);
     MPI_Type_get_extent(t2, &lb, &newextent);
 
     // adjust bounds
@@ -974,31 +1324,25 @@ int dl_contig_alternating_indexed_fixed(dictionary_t *dict, MPI_Datatype *t, int
 
 
 
-void instantiate_dynamic_datatype(const pattern_config_t conf,
-    const dictionary_t *dict, const size_t nbytes, MPI_Datatype* t,
-    int* needed_count, int* flags) {
+void init_dynamic_type_dict(const pattern_config_t conf,
+    const dictionary_t *dict, const size_t nbytes, dictionary_t* typedict) {
 
-  dictionary_t typedict;
   //char* layout;
   MPI_Datatype base;
   int i;
   size_t n;
-  int typesize;
   int basesize;
   char *n_str;
 
-  *flags = 0;
-
   base = get_basetype_value_from_dict("b", dict);
   MPI_Type_size(base, &basesize);
 
   n = nbytes / basesize;
-  n_str = my_int_to_string(n);
+  n_str = my_count_to_string(n);
 
-  init_dictionary(&typedict);
-  add_element_to_dict("n", n_str, &typedict);
-  copy_dict_entry("b", dict, &typedict);
-  *needed_count = 1;
+  init_dictionary(typedict);
+  add_element_to_dict("n", n_str, typedict);
+  copy_dict_entry("b", dict, typedict);
 
   /* these params are different for each type
    * thus, copy them into separate dict and then call create_datatype
@@ -1006,7 +1350,16 @@ void instantiate_dynamic_datatype(const pattern_config_t conf,
   if( conf.dt_parameters != NULL ) {
     for(i=0; i<conf.nb_params; i++) {
       //printf("copy params %s\n", conf.dt_parameters[i]);
-      copy_dict_entry(conf.dt_parameters[i], dict, &typedict);
+      copy_dict_entry(conf.dt_parameters[i], dict, typedict);
+    }
+
+    // the variables of a layout expression are parameters as well
+    if (conf.create_datatype == dl_expr) {
+      char *expr;
+
+      get_value_from_dict(dict, "expr", &expr);
+      copy_layout_expr_variables(expr, dict, typedict);
+      free(expr);
     }
   } else {
     // this should only be for contiguous type
@@ -1015,7 +1368,7 @@ void instantiate_dynamic_datatype(const pattern_config_t conf,
     int ret;
 
     // subtype needed later, keep it
-    copy_dict_entry("subtype", dict, &typedict);
+    copy_dict_entry("subtype", dict, typedict);
 
     // now check the subtype and copy the right parameters
     ret = get_value_from_dict(dict, "subtype", &subtype);
@@ -1030,7 +1383,7 @@ void instantiate_dynamic_datatype(const pattern_config_t conf,
         int j;
         // copy the params of that specific subtype
         for(j=0; j<layout_list[i].nb_params; j++) {
-          copy_dict_entry(layout_list[i].dt_params[j], dict, &typedict);
+          copy_dict_entry(layout_list[i].dt_params[j], dict, typedict);
         }
         found = 1;
         break;
@@ -1046,19 +1399,33 @@ void instantiate_dynamic_datatype(const pattern_config_t conf,
     free(subtype);
   }
 
+  free(n_str);
+}
+
+
+void instantiate_dynamic_datatype(const pattern_config_t conf,
+    const dictionary_t *dict, const size_t nbytes, MPI_Datatype* t,
+    int* needed_count, int* flags) {
+
+  dictionary_t typedict;
+  MPI_Count typesize;
+
+  *flags = 0;
+  *needed_count = 1;
+
+  init_dynamic_type_dict(conf, dict, nbytes, &typedict);
 
   conf.create_datatype(&typedict, t, flags);
   MPI_Type_commit(t);
 
   // check whether t is larger than nbytes
   // if so, set needed_count to 0
-  MPI_Type_size(*t, &typesize);
+  typesize = get_type_size(*t);
   if( typesize > nbytes ) {
-    fprintf(stderr, "WARNING: type is larger than nbytes (%d > %ld)\n", typesize, nbytes);
+    fprintf(stderr, "WARNING: type is larger than nbytes (%lld > %ld)\n", (long long)typesize, nbytes);
     *needed_count = 0;
   }
 
-  free(n_str);
   cleanup_dictionary(&typedict);
 }
 
@@ -1072,7 +1439,8 @@ void instantiate_dynamic_datatype(const pattern_config_t conf,
 int dl_tiled_struct_indexed_Sblocks(dictionary_t *dict, MPI_Datatype *t, int* flags) {
   MPI_Datatype TiledStructIndex;
   MPI_Datatype it, aatiled;
-  int A, B, S, N;
+  int A, B, S;
+  long long N;
   MPI_Aint lb, eb;
   MPI_Datatype BASETYPE, b;
   int *bbl, i;
@@ -1083,7 +1451,7 @@ int dl_tiled_struct_indexed_Sblocks(dictionary_t *dict, MPI_Datatype *t, int* fl
   int n;
 
   *flags = 0;
-  N = get_int_value_from_dict("n", dict);
+  N = get_long_value_from_dict("n", dict);
   BASETYPE = get_basetype_value_from_dict("b", dict);
   MPI_Type_get_extent(BASETYPE, &lb, &eb);
 
@@ -1122,10 +1490,10 @@ int dl_tiled_struct_indexed_Sblocks(dictionary_t *dict, MPI_Datatype *t, int* fl
   tsidi[1] = 1 * eb;
   tsidt[1] = it;
   tsibl[2] = A - 1;
-  tsidi[2] = (B * S * (n - 1) + 1) * eb;
+  tsidi[2] = ((MPI_Aint)B * S * (n - 1) + 1) * eb;
   tsidt[2] = BASETYPE;
   tsibl[3] = S - 1;
-  tsidi[3] = (B * S * (n - 1) + B) * eb;
+  tsidi[3] = ((MPI_Aint)B * S * (n - 1) + B) * eb;
   tsidt[3] = aatiled;
 
   MPI_Type_create_struct(4, tsibl, tsidi, tsidt, &b);
@@ -1138,3 +1506,355 @@ int dl_tiled_struct_indexed_Sblocks(dictionary_t *dict, MPI_Datatype *t, int* fl
   return MPI_SUCCESS;
 }
 
+
+
+/* record layouts */
+
+// fields of a C struct (parameter fields, one basetype per field) with offsetof-style offsets:
+// each field is aligned to its size and the record is padded to the largest alignment;
+// sel contains the (sorted, distinct) indices of the selected fields (parameter select)
+static void get_record_fields(dictionary_t *dict, int *nfields, MPI_Datatype **types,
+    MPI_Aint **offsets, MPI_Aint *recsize, int *nsel, int **sel) {
+  string_array_t* fields;
+  int_array_t* select;
+  MPI_Aint align, maxalign;
+  int i, size;
+
+  fields = get_string_array_from_dict("fields", dict);
+  select = get_int_array_from_dict("select", dict);
+  if (fields->n_elems < 1 || select->n_elems < 1) {
+    printf("Error: fields and select must not be empty\n");
+    exit(1);
+  }
+
+  *nfields = fields->n_elems;
+  *types = (MPI_Datatype*)malloc(*nfields * sizeof(MPI_Datatype));
+  *offsets = (MPI_Aint*)malloc(*nfields * sizeof(MPI_Aint));
+
+  *recsize = 0;
+  maxalign = 1;
+  for (i=0; i<*nfields; i++) {
+    (*types)[i] = to_basetype(fields->elements[i]);
+    MPI_Type_size((*types)[i], &size);
+    align = size;
+    if (align > maxalign) maxalign = align;
+    (*offsets)[i] = (*recsize + align - 1) / align * align;
+    *recsize = (*offsets)[i] + size;
+    free(fields->elements[i]);
+  }
+  *recsize = (*recsize + maxalign - 1) / maxalign * maxalign;
+  free(fields->elements);
+  free(fields);
+
+  *nsel = select->n_elems;
+  *sel = select->elements;
+  for (i=0; i<*nsel; i++) {
+    if ((*sel)[i] < 0 || (*sel)[i] >= *nfields || (i > 0 && (*sel)[i] <= (*sel)[i-1])) {
+      printf("Error: select has to be an increasing list of field indices in [0,%d]\n", *nfields-1);
+      exit(1);
+    }
+  }
+  free(select);
+}
+
+// number of records such that the selected fields of all records have (at most) n elements of b
+static long long get_record_count(dictionary_t *dict, const MPI_Datatype *types, int nsel, const int *sel) {
+  long long n;
+  int i, size, selsize;
+
+  n = get_long_value_from_dict("n", dict);
+  MPI_Type_size(get_basetype_value_from_dict("b", dict), &size);
+
+  selsize = 0;
+  for (i=0; i<nsel; i++) {
+    int fsize;
+    MPI_Type_size(types[sel[i]], &fsize);
+    selsize += fsize;
+  }
+  return n * size / selsize;
+}
+
+// array of n' records (C structs with the given fields and padding), of which
+// the selected fields are sent; n' is chosen such that n' records hold n elements of b
+// in the selected fields, extent n' times the padded record size
+int dl_aos_struct(dictionary_t *dict, MPI_Datatype *t, int* flags)
+{
+  MPI_Datatype *types, *seltypes;
+  MPI_Aint *offsets, *seldispl;
+  MPI_Aint recsize;
+  MPI_Datatype t1, t2;
+  int *sel, *blocks;
+  int nfields, nsel, i;
+  long long nrec;
+
+  *flags = 0;
+
+  get_record_fields(dict, &nfields, &types, &offsets, &recsize, &nsel, &sel);
+  nrec = get_record_count(dict, types, nsel, sel);
+  assert(nrec>0);
+
+  blocks = (int*)malloc(nsel * sizeof(int));
+  seldispl = (MPI_Aint*)malloc(nsel * sizeof(MPI_Aint));
+  seltypes = (MPI_Datatype*)malloc(nsel * sizeof(MPI_Datatype));
+  for (i=0; i<nsel; i++) {
+    blocks[i] = 1;
+    seldispl[i] = offsets[sel[i]];
+    seltypes[i] = types[sel[i]];
+  }
+
+  MPI_Type_create_struct(nsel, blocks, seldispl, seltypes, &t1);
+  MPI_Type_create_resized(t1, 0, recsize, &t2);
+  large_type_contiguous(nrec, t2, t);
+  MPI_Type_free(&t1);
+  MPI_Type_free(&t2);
+
+  free(types);
+  free(offsets);
+  free(sel);
+  free(blocks);
+  free(seldispl);
+  free(seltypes);
+  return MPI_SUCCESS;
+}
+
+// structure-of-arrays counterpart of aos_struct: one array of n' elements per field
+// (each array aligned to its basetype), of which the arrays of the selected fields are sent
+// same number of elements as aos_struct, extent is the total size of all arrays
+int dl_soa_struct(dictionary_t *dict, MPI_Datatype *t, int* flags)
+{
+  MPI_Datatype *types, *seltypes;
+  MPI_Aint *offsets, *seldispl;
+  MPI_Aint recsize, arroffset, extent, maxalign;
+  MPI_Datatype t1;
+  int *sel, *blocks;
+  int nfields, nsel, i, j, size;
+  long long nrec;
+
+  *flags = 0;
+
+  get_record_fields(dict, &nfields, &types, &offsets, &recsize, &nsel, &sel);
+  nrec = get_record_count(dict, types, nsel, sel);
+  assert(nrec>0);
+  if (nrec > INT_MAX) {       // the arrays are single blocks of the struct
+    printf("Error: soa_struct with more than %d records\n", INT_MAX);
+    exit(1);
+  }
+
+  blocks = (int*)malloc(nsel * sizeof(int));
+  seldispl = (MPI_Aint*)malloc(nsel * sizeof(MPI_Aint));
+  seltypes = (MPI_Datatype*)malloc(nsel * sizeof(MPI_Datatype));
+
+  arroffset = 0;
+  maxalign = 1;
+  for (i=0, j=0; i<nfields; i++) {
+    MPI_Type_size(types[i], &size);
+    if (size > maxalign) maxalign = size;
+    arroffset = (arroffset + size - 1) / size * size;
+    if (j < nsel && sel[j] == i) {
+      blocks[j] = nrec;
+      seldispl[j] = arroffset;
+      seltypes[j] = types[i];
+      j++;
+    }
+    arroffset += nrec * size;
+  }
+  extent = (arroffset + maxalign - 1) / maxalign * maxalign;
+
+  MPI_Type_create_struct(nsel, blocks, seldispl, seltypes, &t1);
+  MPI_Type_create_resized(t1, 0, extent, t);
+  MPI_Type_free(&t1);
+
+  free(types);
+  free(offsets);
+  free(sel);
+  free(blocks);
+  free(seldispl);
+  free(seltypes);
+  return MPI_SUCCESS;
+}
+
+
+
+/* multi-dimensional layouts */
+
+// number of dimensions (2 or 3) and storage order (C or F) of the grid
+static void get_grid_params(dictionary_t *dict, int *ndims, int *order) {
+  char *value;
+  int ret;
+
+  *ndims = get_int_value_from_dict("dims", dict);
+  if (*ndims != 2 && *ndims != 3) {
+    printf("Error: dims has to be 2 or 3\n");
+    exit(1);
+  }
+
+  ret = get_value_from_dict(dict, "order", &value);
+  if (ret != 0 || value == NULL) {
+    printf("\nError: required parameter \"%s\" is not specified. \n", "order");
+    exit(1);
+  }
+  if (strcmp(value, "C") == 0) {
+    *order = MPI_ORDER_C;
+  } else if (strcmp(value, "F") == 0) {
+    *order = MPI_ORDER_FORTRAN;
+  } else {
+    printf("Error: order has to be C or F\n");
+    exit(1);
+  }
+  free(value);
+}
+
+// largest L with L^d <= n
+static long long int_root(long long n, int d) {
+  long long r, p;
+  int i;
+
+  r = (long long)pow((double)n, 1.0 / d);
+  while (1) {           // correct rounding errors of pow
+    for (i=0, p=1; i<d; i++) p *= r + 1;
+    if (p > n) break;
+    r++;
+  }
+  while (r > 0) {
+    for (i=0, p=1; i<d; i++) p *= r;
+    if (p <= n) break;
+    r--;
+  }
+  return r;
+}
+
+
+// halo face of width W of a 2D/3D grid (face x, y or z is the low boundary of the 1st, 2nd or 3rd array dimension)
+// the grid has D points along the face normal, the other dimensions are L = n/W (2D) or L = sqrt(n/W) (3D)
+// number of elements W*L^(dims-1) <= n, extent D*L^(dims-1)
+int dl_subarray_face(dictionary_t *dict, MPI_Datatype *t, int* flags)
+{
+  int sizes[3], subsizes[3], starts[3];
+  int ndims, order, face, i;
+  char *value;
+  long long L;
+
+  long long n;
+  int W, D;
+  MPI_Datatype b;
+
+  *flags = 0;
+
+  n = get_long_value_from_dict("n", dict);
+  W = get_int_value_from_dict("W", dict);
+  D = get_int_value_from_dict("D", dict);
+  b = get_basetype_value_from_dict("b", dict);
+  get_grid_params(dict, &ndims, &order);
+
+  get_value_from_dict(dict, "face", &value);
+  if (value == NULL || strlen(value) != 1 || value[0] < 'x' || value[0] >= 'x' + ndims) {
+    printf("Error: face has to be x or y (2D), or x, y or z (3D)\n");
+    exit(1);
+  }
+  face = value[0] - 'x';
+  free(value);
+
+  assert(W>0);
+  assert(D>=W);
+
+  L = int_root(n / W, ndims - 1);
+  assert(L>0);
+  if (L > INT_MAX) {
+    printf("Error: grid dimension %lld too large\n", L);
+    exit(1);
+  }
+
+  for (i=0; i<ndims; i++) {
+    sizes[i] = (i == face) ? D : (int)L;
+    subsizes[i] = (i == face) ? W : (int)L;
+    starts[i] = 0;
+  }
+  MPI_Type_create_subarray(ndims, sizes, subsizes, starts, order, b, t);
+
+  return MPI_SUCCESS;
+}
+
+
+// local block of a 2D/3D grid distributed block-wise over a (virtual) grid of P processes,
+// as seen by the calling process (rank modulo P); local blocks of L^dims elements, L^dims <= n
+int dl_darray_block(dictionary_t *dict, MPI_Datatype *t, int* flags)
+{
+  int gsizes[3], distribs[3], dargs[3], psizes[3];
+  int ndims, order, rank, i;
+  long long L;
+
+  long long n;
+  int P;
+  MPI_Datatype b;
+
+  *flags = 0;
+
+  n = get_long_value_from_dict("n", dict);
+  P = get_int_value_from_dict("P", dict);
+  b = get_basetype_value_from_dict("b", dict);
+  get_grid_params(dict, &ndims, &order);
+
+  assert(P>0);
+
+  L = int_root(n, ndims);
+  assert(L>0);
+
+  for (i=0; i<ndims; i++) {
+    psizes[i] = 0;
+  }
+  MPI_Dims_create(P, ndims, psizes);
+  for (i=0; i<ndims; i++) {
+    if (L * psizes[i] > INT_MAX) {
+      printf("Error: global grid dimension %lld too large\n", L * psizes[i]);
+      exit(1);
+    }
+    gsizes[i] = (int)(L * psizes[i]);
+    distribs[i] = MPI_DISTRIBUTE_BLOCK;
+    dargs[i] = MPI_DISTRIBUTE_DFLT_DARG;
+  }
+
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Type_create_darray(P, rank % P, ndims, gsizes, distribs, dargs, psizes, order, b, t);
+
+  return MPI_SUCCESS;
+}
+
+
+// layout given as a textual expression (see layout_expr/layout_expr.h)
+int dl_expr(dictionary_t *dict, MPI_Datatype *t, int* flags) {
+  char *expr;
+  int ret;
+
+  *flags = 0;
+
+  ret = get_value_from_dict(dict, "expr", &expr);
+  if (ret != 0 || expr == NULL) {
+    printf("\nError: required parameter \"%s\" is not specified. \n", "expr");
+    exit(1);
+  }
+
+  create_layout_expr_datatype(expr, dict, t);
+
+  free(expr);
+  return MPI_SUCCESS;
+}
+
+
+// layout read from a binary typemap file (see typemap/typemap.h)
+int bl_from_file(dictionary_t *dict, MPI_Datatype *t, int* flags) {
+  char *path;
+  int ret;
+
+  *flags = 0;
+
+  ret = get_value_from_dict(dict, "typemap_file", &path);
+  if (ret != 0 || path == NULL) {
+    printf("\nError: required parameter \"%s\" is not specified. \n", "typemap_file");
+    exit(1);
+  }
+
+  create_datatype_from_typemap_file(path, t);
+
+  free(path);
+  return MPI_SUCCESS;
+}
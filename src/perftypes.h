@@ -62,6 +62,9 @@ int bl_tiled_heterogeneous(dictionary_t *dict, MPI_Datatype *t, int* flags);
 // a fixed number S of blocks of alternating types in the index
 int bl_alternating_indexed_fixed(dictionary_t *dict, MPI_Datatype *t, int* flags);
 
+// layout read from the binary typemap file given in parameter typemap_file
+int bl_from_file(dictionary_t *dict, MPI_Datatype *t, int* flags);
+
 /***************************************************************/
 /* dynamic layouts */
 /***************************************************************/
@@ -93,12 +96,21 @@ int bl_tiled_struct(dictionary_t *dict, MPI_Datatype *t, int* flags);
 // Condition: stride of outer vector multiple of stride of inner vector
 int dl_vector_tiled(dictionary_t *dict, MPI_Datatype *t, int* flags);
 
+// tiled layout (number of elements (n/A)*A, extent n/A*B) wrapped in k levels of
+// contiguous, vector, struct or resized constructors (wrap: contig, vector, struct, resized, mixed)
+// that do not change the typemap; isolates the per-level cost of nested types
+int dl_nested_depth(dictionary_t *dict, MPI_Datatype *t, int* flags);
+
 // explicit description of irregular/alternating layout (paper)
 int dl_alternating_indexed(dictionary_t *dict, MPI_Datatype *t, int* flags);
 
 // explicit description of block layout (paper)
 int dl_block_indexed(dictionary_t *dict, MPI_Datatype *t, int* flags);
 
+// n elements in blocks of random length in [A1,A2] separated by random gaps in [G1,G2],
+// drawn from distribution dist (uniform, geometric/<p>, powerlaw/<alpha>, bimodal/<p>) with the given seed
+int dl_random_indexed(dictionary_t *dict, MPI_Datatype *t, int* flags);
+
 /* row column layouts:
    something like a row of B elements, followed by a column of width B
    with the remainder n-B elements*/
@@ -132,6 +144,33 @@ int bl_alternating_aligned(dictionary_t *dict, MPI_Datatype *t, int* flags);
 // where n = total number of blocks of size S * A
 int dl_tiled_struct_indexed_Sblocks(dictionary_t *dict, MPI_Datatype *t, int* flags);
 
+/* record layouts: fields (list of "/"-separated basetypes of a C struct, aligned as by the compiler),
+   select ("/"-separated indices of the fields that are sent) */
+
+// array of n' structs, of which the selected fields are sent;
+// the selected fields of the n' records have n elements of b
+int dl_aos_struct(dictionary_t *dict, MPI_Datatype *t, int* flags);
+
+// one array of n' elements per field, of which the arrays of the selected fields are sent
+int dl_soa_struct(dictionary_t *dict, MPI_Datatype *t, int* flags);
+
+/* multi-dimensional layouts: dims (2 or 3), order (C or F) */
+
+// halo face of width W (face x, y or z: low boundary of the 1st, 2nd or 3rd array dimension) of a grid
+// with D points along the face normal and L = n/W (2D) or L = sqrt(n/W) (3D) points along the other dimensions
+int dl_subarray_face(dictionary_t *dict, MPI_Datatype *t, int* flags);
+
+// local block (L^dims <= n elements) of a grid distributed block-wise over a virtual grid of P processes
+int dl_darray_block(dictionary_t *dict, MPI_Datatype *t, int* flags);
+
+// layout described by the expression in parameter expr, e.g. vector(n/8, 2, 5, b)
+// (n and other parameters can be used as variables, see layout_expr/layout_expr.h)
+int dl_expr(dictionary_t *dict, MPI_Datatype *t, int* flags);
+
+/* builds the parameter dictionary of a dl_* datatype (n = nbytes / size of the basetype) */
+void init_dynamic_type_dict(const pattern_config_t conf,
+    const dictionary_t *dict, const size_t nbytes, dictionary_t* typedict);
+
 /* instantiates each dl_* datatype */
 void instantiate_dynamic_datatype(const pattern_config_t conf,
     const dictionary_t *dict, const size_t nbytes, MPI_Datatype* t,
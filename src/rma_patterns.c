@@ -0,0 +1,297 @@
+/*  MPI-Datatybe - MPI Datatype Benchmark
+ *  
+ *  Copyright 2017 Alexandra Carpen-Amarie, Sascha Hunold, Jesper Larsson Träff
+ *      Research Group for Parallel Computing
+ *      Faculty of Informatics
+ *      Vienna University of Technology, Austria
+ *  
+ *  <license>
+ *      This program is free software: you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation, either version 2 of the License, or
+ *      (at your option) any later version.
+ *  
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *  
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *  </license>
+ */
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <mpi.h>
+
+#include "rma_patterns.h"
+#include "comm_patterns.h"
+#include "typemap/typemap.h"
+//@ add_includes
+
+//@ declare_variables
+
+
+static const int PROC1 = 0;     // origin
+static const int PROC2 = 1;     // target
+
+typedef enum RmaOps {
+    rma_put,
+    rma_get,
+    rma_accumulate
+} rma_op_t;
+
+static const char* RMA_OP_NAMES[] = { "put", "get", "accumulate" };
+
+
+// the operation of one epoch, issued by the origin (acc_op: reduction operation of accumulate)
+static void rma_transfer(rma_op_t op, MPI_Op acc_op, void* sendbuf, void* recvbuf, int c, MPI_Datatype type,
+        MPI_Win win) {
+    switch (op) {
+    case rma_put:
+        MPI_Put(sendbuf, c, type, PROC2, 0, c, type, win);
+        break;
+    case rma_get:
+        MPI_Get(recvbuf, c, type, PROC2, 0, c, type, win);
+        break;
+    case rma_accumulate:
+        MPI_Accumulate(sendbuf, c, type, PROC2, 0, c, type, acc_op, win);
+        break;
+    }
+}
+
+
+static void rma_fence(rma_op_t op, MPI_Op acc_op, int rank, void* sendbuf, void* recvbuf, int c, MPI_Datatype type,
+        MPI_Win win) {
+
+    //@ set test_type="datatype"
+    //@ set rma_sync="fence"
+
+    //@ initialize_timestamps t1
+    //@ initialize_timestamps t2
+
+    //@ start_measurement_loop
+
+    //@ start_sync
+    //@ measure_timestamp t1
+    MPI_Win_fence(MPI_MODE_NOPRECEDE, win);
+    if (rank == PROC1) {
+        rma_transfer(op, acc_op, sendbuf, recvbuf, c, type, win);
+    }
+    MPI_Win_fence(MPI_MODE_NOSUCCEED, win);
+    //@ measure_timestamp t2
+    //@ stop_sync
+    //@stop_measurement_loop
+
+    //@ print_runtime_array name=runtime end_time=t2 start_time=t1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+
+    //@cleanup_variables
+}
+
+
+static void rma_pscw(rma_op_t op, MPI_Op acc_op, int rank, void* sendbuf, void* recvbuf, int c, MPI_Datatype type,
+        MPI_Comm comm, MPI_Win win) {
+    MPI_Group group, origin_group, target_group;
+
+    // not to measure
+    MPI_Comm_group(comm, &group);
+    MPI_Group_incl(group, 1, &PROC1, &origin_group);
+    MPI_Group_incl(group, 1, &PROC2, &target_group);
+
+    //@ set test_type="datatype"
+    //@ set rma_sync="pscw"
+
+    //@ initialize_timestamps t1
+    //@ initialize_timestamps t2
+
+    //@ start_measurement_loop
+
+    //@ start_sync
+    if (rank == PROC1) {
+        //@ measure_timestamp t1
+        MPI_Win_start(target_group, 0, win);
+        rma_transfer(op, acc_op, sendbuf, recvbuf, c, type, win);
+        MPI_Win_complete(win);
+        //@ measure_timestamp t2
+
+    } else if (rank == PROC2) {
+
+        //@ measure_timestamp t1
+        MPI_Win_post(origin_group, 0, win);
+        MPI_Win_wait(win);
+        //@ measure_timestamp t2
+    }
+    //@ stop_sync
+    //@stop_measurement_loop
+
+    //@ print_runtime_array name=runtime end_time=t2 start_time=t1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+
+    //@cleanup_variables
+    MPI_Group_free(&origin_group);
+    MPI_Group_free(&target_group);
+    MPI_Group_free(&group);
+}
+
+
+// passive target: only the origin takes part in the epoch
+static void rma_lock(rma_op_t op, MPI_Op acc_op, int rank, void* sendbuf, void* recvbuf, int c, MPI_Datatype type,
+        MPI_Win win) {
+
+    //@ set test_type="datatype"
+    //@ set rma_sync="lock"
+
+    //@ initialize_timestamps t1
+    //@ initialize_timestamps t2
+
+    //@ start_measurement_loop
+
+    //@ start_sync
+    if (rank == PROC1) {
+        //@ measure_timestamp t1
+        MPI_Win_lock(MPI_LOCK_EXCLUSIVE, PROC2, 0, win);
+        rma_transfer(op, acc_op, sendbuf, recvbuf, c, type, win);
+        MPI_Win_unlock(PROC2, win);
+        //@ measure_timestamp t2
+    }
+    //@ stop_sync
+    //@stop_measurement_loop
+
+    //@ print_runtime_array name=runtime end_time=t2 start_time=t1 type=reduce op=max nbytes=nbytes_str typeextent=derivedtype_extent typesize=derivedtype_size realsize=real_size count=c
+
+    //@cleanup_variables
+}
+
+
+// MPI_Accumulate needs a datatype built from a single predefined type: MPI_SUM for the
+// numeric basetypes, MPI_REPLACE for MPI_CHAR (MPI_SUM is not defined for characters);
+// returns 0 for heterogeneous (MPI_BYTE in the typemap), MPI_BYTE and empty layouts
+static int get_accumulate_op(MPI_Datatype type, MPI_Op *acc_op) {
+    typemap_t map;
+    MPI_Datatype basetype;
+
+    init_typemap(&map);
+    flatten_datatype(type, 1, &map);
+    basetype = map.basetype;
+    cleanup_typemap(&map);
+
+    if (basetype == MPI_BYTE || basetype == MPI_DATATYPE_NULL) {
+        return 0;
+    }
+    *acc_op = (basetype == MPI_CHAR) ? MPI_REPLACE : MPI_SUM;
+    return 1;
+}
+
+
+static void run_rma(rma_op_t op, pattern_config_t conf, int rank, void* sendbuf, void* recvbuf, int c,
+        MPI_Datatype type) {
+    MPI_Aint lb, extent, winsize;
+    MPI_Win win;
+    void *winbuf;
+    MPI_Op acc_op = MPI_SUM;
+    const char *acc_op_name;
+
+    if (conf.test_type != test_datatype) {
+        printf("Error: the %s pattern only supports the test type datatype\n", RMA_OP_NAMES[op]);
+        exit(1);
+    }
+
+    if (op == rma_accumulate) {
+        if (!get_accumulate_op(type, &acc_op)) {
+            if (rank == PROC1) {
+                fprintf(stderr, "WARNING: accumulate needs a layout of a single basetype other than MPI_BYTE...skipping case\n");
+            }
+            return;
+        }
+        acc_op_name = (acc_op == MPI_SUM) ? "sum" : "replace";
+        //@ set accumulate_op=acc_op_name
+    }
+
+    // not to measure: the window holds the c instances at the target (zeroed, as the origin data for accumulate)
+    MPI_Type_get_extent(type, &lb, &extent);
+    winsize = (rank == PROC2) ? (MPI_Aint)c * extent : 0;
+    MPI_Win_allocate(winsize, 1, MPI_INFO_NULL, conf.comm, &winbuf, &win);
+    memset(winbuf, 0, winsize);
+    memset(sendbuf, 0, (size_t)c * extent);
+    MPI_Barrier(conf.comm);
+
+    //@ set rma_op=RMA_OP_NAMES[op]
+
+    switch (conf.rma_sync) {
+    case rma_sync_fence:
+        rma_fence(op, acc_op, rank, sendbuf, recvbuf, c, type, win);
+        break;
+    case rma_sync_pscw:
+        rma_pscw(op, acc_op, rank, sendbuf, recvbuf, c, type, conf.comm, win);
+        break;
+    case rma_sync_lock:
+        rma_lock(op, acc_op, rank, sendbuf, recvbuf, c, type, win);
+        break;
+    }
+
+    MPI_Win_free(&win);
+}
+
+static void run_put(pattern_config_t conf, int rank, void* sendbuf, void* recvbuf, int c, MPI_Datatype type) {
+    run_rma(rma_put, conf, rank, sendbuf, recvbuf, c, type);
+}
+
+static void run_get(pattern_config_t conf, int rank, void* sendbuf, void* recvbuf, int c, MPI_Datatype type) {
+    run_rma(rma_get, conf, rank, sendbuf, recvbuf, c, type);
+}
+
+static void run_accumulate(pattern_config_t conf, int rank, void* sendbuf, void* recvbuf, int c, MPI_Datatype type) {
+    run_rma(rma_accumulate, conf, rank, sendbuf, recvbuf, c, type);
+}
+
+
+static void check_two_processes(const pattern_config_t conf, rma_op_t op) {
+    int size;
+
+    MPI_Comm_size(conf.comm, &size);
+    if (size < 2) {
+        printf("Error: the %s pattern requires at least 2 processes\n", RMA_OP_NAMES[op]);
+        exit(1);
+    }
+}
+
+
+int putpattern(pattern_config_t conf, dictionary_t *dict)
+{
+    check_two_processes(conf, rma_put);
+    return measure_basic_pattern(conf, dict, run_put, 1, 0);
+}
+
+int getpattern(pattern_config_t conf, dictionary_t *dict)
+{
+    check_two_processes(conf, rma_get);
+    return measure_basic_pattern(conf, dict, run_get, 1, 1);
+}
+
+int accumulatepattern(pattern_config_t conf, dictionary_t *dict)
+{
+    check_two_processes(conf, rma_accumulate);
+    return measure_basic_pattern(conf, dict, run_accumulate, 1, 0);
+}
+
+
+int putpattern_dynamictype(pattern_config_t conf, dictionary_t *dict)
+{
+    check_two_processes(conf, rma_put);
+    return measure_dynamic_pattern(conf, dict, run_put, 1, 0);
+}
+
+int getpattern_dynamictype(pattern_config_t conf, dictionary_t *dict)
+{
+    check_two_processes(conf, rma_get);
+    return measure_dynamic_pattern(conf, dict, run_get, 1, 1);
+}
+
+int accumulatepattern_dynamictype(pattern_config_t conf, dictionary_t *dict)
+{
+    check_two_processes(conf, rma_accumulate);
+    return measure_dynamic_pattern(conf, dict, run_accumulate, 1, 0);
+}
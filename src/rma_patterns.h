@@ -0,0 +1,44 @@
+/*  MPI-Datatybe - MPI Datatype Benchmark
+ *  
+ *  Copyright 2017 Alexandra Carpen-Amarie, Sascha Hunold, Jesper Larsson Träff
+ *      Research Group for Parallel Computing
+ *      Faculty of Informatics
+ *      Vienna University of Technology, Austria
+ *  
+ *  <license>
+ *      This program is free software: you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation, either version 2 of the License, or
+ *      (at your option) any later version.
+ *  
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *  
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *  </license>
+ */
+
+
+#ifndef RMA_PATTERNS_H_
+#define RMA_PATTERNS_H_
+
+#include "datatypes_bench.h"
+#include "dictionary/keyvalue_store.h"
+
+/* one-sided communication between rank 0 (origin) and rank 1 (target, window allocated with
+ * MPI_Win_allocate): MPI_Put, MPI_Get and MPI_Accumulate (MPI_SUM) of c instances of the layout,
+ * which is both the origin and the target datatype; one access epoch is measured with the
+ * synchronization of conf.rma_sync (fence, post-start-complete-wait or passive target lock);
+ * test type datatype only */
+int putpattern(pattern_config_t conf, dictionary_t *dict);
+int getpattern(pattern_config_t conf, dictionary_t *dict);
+int accumulatepattern(pattern_config_t conf, dictionary_t *dict);
+
+int putpattern_dynamictype(pattern_config_t conf, dictionary_t *dict);
+int getpattern_dynamictype(pattern_config_t conf, dictionary_t *dict);
+int accumulatepattern_dynamictype(pattern_config_t conf, dictionary_t *dict);
+
+#endif /* RMA_PATTERNS_H_ */
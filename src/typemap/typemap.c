@@ -0,0 +1,645 @@
+/*  MPI-Datatybe - MPI Datatype Benchmark
+ *  
+ *  Copyright 2017 Alexandra Carpen-Amarie, Sascha Hunold, Jesper Larsson Träff
+ *      Research Group for Parallel Computing
+ *      Faculty of Informatics
+ *      Vienna University of Technology, Austria
+ *  
+ *  <license>
+ *      This program is free software: you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation, either version 2 of the License, or
+ *      (at your option) any later version.
+ *  
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *  
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *  </license>
+ */
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <mpi.h>
+
+#include "typemap.h"
+
+static const size_t TYPEMAP_BATCH = 64;
+
+const char* normal_form_names[] = {
+    [NORMAL_CONTIGUOUS] = "contiguous",
+    [NORMAL_VECTOR] = "vector",
+    [NORMAL_INDEXED_BLOCK] = "indexed_block",
+    [NORMAL_HINDEXED] = "hindexed"
+};
+
+
+void init_typemap(typemap_t *map) {
+    map->nblocks = 0;
+    map->max_blocks = TYPEMAP_BATCH;
+    map->offsets = (MPI_Aint*)malloc(map->max_blocks * sizeof(MPI_Aint));
+    map->lengths = (MPI_Aint*)malloc(map->max_blocks * sizeof(MPI_Aint));
+    assert(map->offsets != NULL && map->lengths != NULL);
+    map->size = 0;
+    map->basetype = MPI_DATATYPE_NULL;
+}
+
+
+void cleanup_typemap(typemap_t *map) {
+    free(map->offsets);
+    free(map->lengths);
+    map->offsets = NULL;
+    map->lengths = NULL;
+    map->nblocks = 0;
+    map->max_blocks = 0;
+    map->size = 0;
+}
+
+
+void append_block_to_typemap(typemap_t *map, MPI_Aint off, MPI_Aint len) {
+    size_t last;
+
+    if (len <= 0) {
+        return;
+    }
+    map->size += len;
+
+    if (map->nblocks > 0) {
+        last = map->nblocks - 1;
+        if (map->offsets[last] + map->lengths[last] == off) { // coalesce adjacent runs
+            map->lengths[last] += len;
+            return;
+        }
+    }
+
+    if (map->nblocks == map->max_blocks) {
+        map->max_blocks *= 2;
+        map->offsets = (MPI_Aint*)realloc(map->offsets, map->max_blocks * sizeof(MPI_Aint));
+        map->lengths = (MPI_Aint*)realloc(map->lengths, map->max_blocks * sizeof(MPI_Aint));
+        assert(map->offsets != NULL && map->lengths != NULL);
+    }
+    map->offsets[map->nblocks] = off;
+    map->lengths[map->nblocks] = len;
+    map->nblocks++;
+}
+
+
+// the typemap stays homogeneous as long as all blocks come from the same predefined type,
+// otherwise it is described in bytes
+static void merge_basetype(typemap_t *map, MPI_Datatype basetype) {
+    if (basetype == MPI_DATATYPE_NULL) {
+        return;
+    }
+    if (map->basetype == MPI_DATATYPE_NULL) {
+        map->basetype = basetype;
+    } else if (map->basetype != basetype) {
+        map->basetype = MPI_BYTE;
+    }
+}
+
+
+// appends repeat copies of sub, the first one at disp, the others shifted by stride bytes
+static void append_shifted_typemap(typemap_t *map, const typemap_t *sub, MPI_Aint disp,
+        MPI_Aint repeat, MPI_Aint stride) {
+    MPI_Aint r;
+    size_t i;
+
+    for (r = 0; r < repeat; r++) {
+        for (i = 0; i < sub->nblocks; i++) {
+            append_block_to_typemap(map, disp + r * stride + sub->offsets[i], sub->lengths[i]);
+        }
+    }
+    if (repeat > 0) {
+        merge_basetype(map, sub->basetype);
+    }
+}
+
+
+static int is_predefined(MPI_Datatype type) {
+    int ni, na, nt, combiner;
+
+    MPI_Type_get_envelope(type, &ni, &na, &nt, &combiner);
+    return (combiner == MPI_COMBINER_NAMED);
+}
+
+
+static void free_contents_types(MPI_Datatype *types, int nt) {
+    int i;
+
+    for (i = 0; i < nt; i++) {
+        if (!is_predefined(types[i])) {
+            MPI_Type_free(&types[i]);
+        }
+    }
+}
+
+
+// fallback for constructors we do not decode (subarray, darray, ...):
+// unpack a buffer of marker bytes into the layout and collect the touched bytes
+// (the typemap order is lost, blocks are listed in increasing offset order)
+static int flatten_by_probing(MPI_Datatype type, typemap_t *map) {
+    MPI_Aint tlb, textent, i, start;
+    int size, position = 0;
+    unsigned char *buf, *packed;
+
+    MPI_Type_get_true_extent(type, &tlb, &textent);
+    MPI_Type_size(type, &size);
+
+    buf = (unsigned char*)calloc(textent > 0 ? textent : 1, sizeof(unsigned char));
+    packed = (unsigned char*)malloc(size > 0 ? size : 1);
+    assert(buf != NULL && packed != NULL);
+    memset(packed, 0xFF, size);
+
+    MPI_Unpack(packed, size, &position, buf - tlb, 1, type, MPI_COMM_SELF);
+
+    i = 0;
+    while (i < textent) {
+        if (buf[i] == 0) {
+            i++;
+            continue;
+        }
+        start = i;
+        while (i < textent && buf[i] != 0) {
+            i++;
+        }
+        append_block_to_typemap(map, tlb + start, i - start);
+    }
+    merge_basetype(map, MPI_BYTE);
+
+    free(buf);
+    free(packed);
+    return MPI_SUCCESS;
+}
+
+
+// flattens one instance of type, offsets relative to the start of the buffer
+static int flatten_type_rec(MPI_Datatype type, typemap_t *map) {
+    int ni, na, nt, combiner;
+    int *ints;
+    MPI_Aint *addrs;
+    MPI_Datatype *types;
+    MPI_Aint lb, extent;
+    typemap_t sub;
+    int i, count;
+    int ret = MPI_SUCCESS;
+
+    MPI_Type_get_envelope(type, &ni, &na, &nt, &combiner);
+
+    if (combiner == MPI_COMBINER_NAMED) {
+        int size;
+        MPI_Type_size(type, &size);
+        append_block_to_typemap(map, 0, size);
+        merge_basetype(map, type);
+        return MPI_SUCCESS;
+    }
+
+    if (combiner == MPI_COMBINER_SUBARRAY || combiner == MPI_COMBINER_DARRAY) {
+        return flatten_by_probing(type, map);
+    }
+
+    ints = (int*)malloc((ni + 1) * sizeof(int));
+    addrs = (MPI_Aint*)malloc((na + 1) * sizeof(MPI_Aint));
+    types = (MPI_Datatype*)malloc((nt + 1) * sizeof(MPI_Datatype));
+    MPI_Type_get_contents(type, ni, na, nt, ints, addrs, types);
+
+    // all constructors except struct have a single old type
+    if (combiner != MPI_COMBINER_STRUCT) {
+        init_typemap(&sub);
+        flatten_type_rec(types[0], &sub);
+        MPI_Type_get_extent(types[0], &lb, &extent);
+    }
+
+    switch (combiner) {
+    case MPI_COMBINER_DUP:
+    case MPI_COMBINER_RESIZED:  // bounds only matter for the enclosing constructor
+        append_shifted_typemap(map, &sub, 0, 1, 0);
+        break;
+    case MPI_COMBINER_CONTIGUOUS:
+        append_shifted_typemap(map, &sub, 0, ints[0], extent);
+        break;
+    case MPI_COMBINER_VECTOR:
+        for (i = 0; i < ints[0]; i++) {
+            append_shifted_typemap(map, &sub, (MPI_Aint)i * ints[2] * extent, ints[1], extent);
+        }
+        break;
+    case MPI_COMBINER_HVECTOR:
+        for (i = 0; i < ints[0]; i++) {
+            append_shifted_typemap(map, &sub, i * addrs[0], ints[1], extent);
+        }
+        break;
+    case MPI_COMBINER_INDEXED:
+        count = ints[0];
+        for (i = 0; i < count; i++) {
+            append_shifted_typemap(map, &sub, (MPI_Aint)ints[1 + count + i] * extent, ints[1 + i], extent);
+        }
+        break;
+    case MPI_COMBINER_HINDEXED:
+        count = ints[0];
+        for (i = 0; i < count; i++) {
+            append_shifted_typemap(map, &sub, addrs[i], ints[1 + i], extent);
+        }
+        break;
+    case MPI_COMBINER_INDEXED_BLOCK:
+        count = ints[0];
+        for (i = 0; i < count; i++) {
+            append_shifted_typemap(map, &sub, (MPI_Aint)ints[2 + i] * extent, ints[1], extent);
+        }
+        break;
+    case MPI_COMBINER_HINDEXED_BLOCK:
+        count = ints[0];
+        for (i = 0; i < count; i++) {
+            append_shifted_typemap(map, &sub, addrs[i], ints[1], extent);
+        }
+        break;
+    case MPI_COMBINER_STRUCT:
+        count = ints[0];
+        for (i = 0; i < count; i++) {
+            init_typemap(&sub);
+            flatten_type_rec(types[i], &sub);
+            MPI_Type_get_extent(types[i], &lb, &extent);
+            append_shifted_typemap(map, &sub, addrs[i], ints[1 + i], extent);
+            cleanup_typemap(&sub);
+        }
+        break;
+    default:
+        ret = flatten_by_probing(type, map);
+        break;
+    }
+
+    if (combiner != MPI_COMBINER_STRUCT) {
+        cleanup_typemap(&sub);
+    }
+    free_contents_types(types, nt);
+    free(ints);
+    free(addrs);
+    free(types);
+
+    return ret;
+}
+
+
+int flatten_datatype(MPI_Datatype type, int count, typemap_t *map) {
+    typemap_t single;
+    MPI_Aint lb, extent;
+    int ret;
+
+    init_typemap(map);
+    init_typemap(&single);
+
+    ret = flatten_type_rec(type, &single);
+    MPI_Type_get_extent(type, &lb, &extent);
+    append_shifted_typemap(map, &single, 0, count, extent);
+
+    cleanup_typemap(&single);
+    return ret;
+}
+
+
+MPI_Count get_typemap_nblocks(MPI_Datatype type, int count) {
+    typemap_t single;
+    MPI_Aint lb, extent;
+    MPI_Count nblocks;
+    size_t last;
+
+    init_typemap(&single);
+    flatten_type_rec(type, &single);
+    MPI_Type_get_extent(type, &lb, &extent);
+
+    nblocks = 0;
+    if (count > 0 && single.nblocks > 0) {
+        nblocks = (MPI_Count)count * single.nblocks;
+        last = single.nblocks - 1;
+        if (single.offsets[last] + single.lengths[last] == single.offsets[0] + extent) {
+            nblocks -= count - 1;
+        }
+    }
+
+    cleanup_typemap(&single);
+    return nblocks;
+}
+
+
+static const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+static const uint64_t FNV_PRIME = 1099511628211ULL;
+
+static uint64_t hash_bytes(uint64_t h, const unsigned char *data, size_t len) {
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        h ^= data[i];
+        h *= FNV_PRIME;
+    }
+    return h;
+}
+
+// hashes the value in little-endian byte order, independent of the platform
+static uint64_t hash_int64(uint64_t h, int64_t value) {
+    unsigned char bytes[8];
+    uint64_t v = (uint64_t)value;
+    int i;
+
+    for (i = 0; i < 8; i++) {
+        bytes[i] = (unsigned char)(v >> (8 * i));
+    }
+    return hash_bytes(h, bytes, 8);
+}
+
+
+uint64_t get_typemap_fingerprint(MPI_Datatype type, int count) {
+    typemap_t single;
+    MPI_Aint lb, extent, off, len, pending_off, pending_len;
+    char name[MPI_MAX_OBJECT_NAME];
+    int namelen, k;
+    uint64_t h;
+    size_t i;
+
+    init_typemap(&single);
+    flatten_type_rec(type, &single);
+    MPI_Type_get_extent(type, &lb, &extent);
+
+    if (single.basetype == MPI_DATATYPE_NULL) { // empty type
+        name[0] = '\0';
+    } else {
+        MPI_Type_get_name(single.basetype, name, &namelen);
+    }
+    h = hash_bytes(FNV_OFFSET_BASIS, (const unsigned char*)name, strlen(name));
+
+    // blocks of the count instances, coalesced as in flatten_datatype (without storing them)
+    pending_off = 0;
+    pending_len = 0;
+    for (k = 0; k < count; k++) {
+        for (i = 0; i < single.nblocks; i++) {
+            off = single.offsets[i] + k * extent;
+            len = single.lengths[i];
+            if (pending_len > 0 && pending_off + pending_len == off) {
+                pending_len += len;
+            } else {
+                if (pending_len > 0) {
+                    h = hash_int64(hash_int64(h, pending_off), pending_len);
+                }
+                pending_off = off;
+                pending_len = len;
+            }
+        }
+    }
+    if (pending_len > 0) {
+        h = hash_int64(hash_int64(h, pending_off), pending_len);
+    }
+
+    cleanup_typemap(&single);
+    return h;
+}
+
+
+int create_normalized_datatype(MPI_Datatype type, MPI_Datatype *normtype, normal_form_t *form) {
+    typemap_t map;
+    MPI_Datatype elem, t1;
+    MPI_Aint lb, extent, newlb, newextent;
+    MPI_Aint stride = 0;
+    int esize;
+    int same_length = 1, same_stride = 1;
+    size_t i;
+    int n;
+
+    flatten_datatype(type, 1, &map);
+
+    if (map.nblocks > INT_MAX) {
+        fprintf(stderr, "Error: cannot normalize datatype with %zu blocks\n", map.nblocks);
+        cleanup_typemap(&map);
+        return MPI_ERR_TYPE;
+    }
+    n = (int)map.nblocks;
+
+    elem = (map.basetype == MPI_DATATYPE_NULL) ? MPI_BYTE : map.basetype;
+    MPI_Type_size(elem, &esize);
+
+    if (n > 1) {
+        stride = map.offsets[1] - map.offsets[0];
+    }
+    for (i = 1; i < map.nblocks; i++) {
+        if (map.lengths[i] != map.lengths[0]) {
+            same_length = 0;
+        }
+        if (map.offsets[i] - map.offsets[i - 1] != stride) {
+            same_stride = 0;
+        }
+    }
+
+    if (n == 0) {
+        *form = NORMAL_CONTIGUOUS;
+        MPI_Type_contiguous(0, elem, &t1);
+    } else if (n == 1 && map.offsets[0] == 0) {
+        *form = NORMAL_CONTIGUOUS;
+        MPI_Type_contiguous(map.lengths[0] / esize, elem, &t1);
+    } else if (same_length && same_stride && map.offsets[0] == 0) {
+        *form = NORMAL_VECTOR;
+        if (stride % esize == 0) {
+            MPI_Type_vector(n, map.lengths[0] / esize, stride / esize, elem, &t1);
+        } else {
+            MPI_Type_create_hvector(n, map.lengths[0] / esize, stride, elem, &t1);
+        }
+    } else if (same_length) {
+        *form = NORMAL_INDEXED_BLOCK;
+        MPI_Type_create_hindexed_block(n, map.lengths[0] / esize, map.offsets, elem, &t1);
+    } else {
+        int *blocks;
+
+        *form = NORMAL_HINDEXED;
+        blocks = (int*)malloc(n * sizeof(int));
+        for (i = 0; i < map.nblocks; i++) {
+            blocks[i] = map.lengths[i] / esize;
+        }
+        MPI_Type_create_hindexed(n, blocks, map.offsets, elem, &t1);
+        free(blocks);
+    }
+
+    // keep the bounds of the original type, such that it can be used with the same count and buffers
+    MPI_Type_get_extent(type, &lb, &extent);
+    MPI_Type_get_extent(t1, &newlb, &newextent);
+    if (lb != newlb || extent != newextent) {
+        MPI_Type_create_resized(t1, lb, extent, normtype);
+        MPI_Type_free(&t1);
+    } else {
+        *normtype = t1;
+    }
+    MPI_Type_commit(normtype);
+
+    cleanup_typemap(&map);
+    return MPI_SUCCESS;
+}
+
+
+// basetypes of typemap files, referenced by their index (MPI_BYTE for heterogeneous types)
+static MPI_Datatype file_basetype(int index) {
+    switch (index) {
+    case 1: return MPI_CHAR;
+    case 2: return MPI_SHORT;
+    case 3: return MPI_INT;
+    case 4: return MPI_FLOAT;
+    case 5: return MPI_DOUBLE;
+    default: return MPI_BYTE;
+    }
+}
+
+static int file_basetype_index(MPI_Datatype type) {
+    int i;
+
+    for (i = 1; i <= 5; i++) {
+        if (type == file_basetype(i)) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+
+int write_typemap_file(MPI_Datatype type, const char *path) {
+    typemap_t map;
+    typemap_file_header_t header;
+    MPI_Aint lb, extent, off, len, chunk;
+    MPI_Datatype elem;
+    int64_t *offsets;
+    int32_t *lengths;
+    size_t i, n, max;
+    int esize;
+    FILE *f;
+
+    flatten_datatype(type, 1, &map);
+    MPI_Type_get_extent(type, &lb, &extent);
+
+    memset(&header, 0, sizeof(header));
+    strcpy(header.magic, TYPEMAP_FILE_MAGIC);
+    header.basetype = file_basetype_index(map.basetype);
+    elem = file_basetype(header.basetype);
+    MPI_Type_size(elem, &esize);
+    header.basetype_size = esize;
+    header.lb = lb;
+    header.extent = extent;
+
+    // blocks longer than INT_MAX elements are split
+    max = map.nblocks;
+    for (i = 0; i < map.nblocks; i++) {
+        max += map.lengths[i] / esize / INT_MAX;
+    }
+    offsets = (int64_t*)malloc((max + 1) * sizeof(int64_t));
+    lengths = (int32_t*)malloc((max + 1) * sizeof(int32_t));
+    assert(offsets != NULL && lengths != NULL);
+
+    n = 0;
+    for (i = 0; i < map.nblocks; i++) {
+        off = map.offsets[i];
+        len = map.lengths[i] / esize;
+        while (len > 0) {
+            chunk = (len > INT_MAX) ? INT_MAX : len;
+            offsets[n] = off;
+            lengths[n] = (int32_t)chunk;
+            off += chunk * esize;
+            len -= chunk;
+            n++;
+        }
+    }
+    header.nblocks = n;
+
+    f = fopen(path, "wb");
+    if (f == NULL) {
+        printf("Error: cannot open typemap file %s for writing\n", path);
+        exit(1);
+    }
+    if (fwrite(&header, sizeof(header), 1, f) != 1 ||
+            fwrite(offsets, sizeof(int64_t), n, f) != n ||
+            fwrite(lengths, sizeof(int32_t), n, f) != n) {
+        printf("Error: cannot write typemap file %s\n", path);
+        exit(1);
+    }
+    fclose(f);
+
+    free(offsets);
+    free(lengths);
+    cleanup_typemap(&map);
+    return MPI_SUCCESS;
+}
+
+
+int create_datatype_from_typemap_file(const char *path, MPI_Datatype *t) {
+    const typemap_file_header_t *header;
+    const MPI_Aint *offsets;
+    const int *lengths;
+    MPI_Datatype elem, t1;
+    MPI_Aint newlb, newextent;
+    struct stat st;
+    void *data;
+    int64_t i;
+    int same_length = 1;
+    int esize;
+    int fd;
+
+    if (sizeof(MPI_Aint) != sizeof(int64_t)) {
+        printf("Error: typemap files require a 64-bit MPI_Aint\n");
+        exit(1);
+    }
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        printf("Error: cannot open typemap file %s\n", path);
+        exit(1);
+    }
+    if ((size_t)st.st_size < sizeof(typemap_file_header_t)) {
+        printf("Error: %s is not a typemap file\n", path);
+        exit(1);
+    }
+    data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+        printf("Error: cannot map typemap file %s\n", path);
+        exit(1);
+    }
+
+    header = (const typemap_file_header_t*)data;
+    elem = file_basetype(header->basetype);
+    MPI_Type_size(elem, &esize);
+    if (strncmp(header->magic, TYPEMAP_FILE_MAGIC, sizeof(header->magic)) != 0 ||
+            header->basetype_size != esize || header->nblocks < 0 || header->nblocks > INT_MAX ||
+            (size_t)st.st_size != sizeof(typemap_file_header_t) +
+            header->nblocks * (sizeof(int64_t) + sizeof(int32_t))) {
+        printf("Error: %s is not a typemap file or was written on a different architecture\n", path);
+        exit(1);
+    }
+    offsets = (const MPI_Aint*)(header + 1);
+    lengths = (const int*)(offsets + header->nblocks);
+
+    for (i = 1; i < header->nblocks; i++) {
+        if (lengths[i] != lengths[0]) {
+            same_length = 0;
+            break;
+        }
+    }
+    if (header->nblocks == 0) {
+        MPI_Type_contiguous(0, elem, &t1);
+    } else if (same_length) {
+        MPI_Type_create_hindexed_block((int)header->nblocks, lengths[0], offsets, elem, &t1);
+    } else {
+        MPI_Type_create_hindexed((int)header->nblocks, lengths, offsets, elem, &t1);
+    }
+
+    MPI_Type_get_extent(t1, &newlb, &newextent);
+    if (newlb != header->lb || newextent != header->extent) {
+        MPI_Type_create_resized(t1, header->lb, header->extent, t);
+        MPI_Type_free(&t1);
+    } else {
+        *t = t1;
+    }
+
+    munmap(data, st.st_size);
+    close(fd);
+    return MPI_SUCCESS;
+}
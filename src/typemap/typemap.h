@@ -0,0 +1,96 @@
+/*  MPI-Datatybe - MPI Datatype Benchmark
+ *  
+ *  Copyright 2017 Alexandra Carpen-Amarie, Sascha Hunold, Jesper Larsson Träff
+ *      Research Group for Parallel Computing
+ *      Faculty of Informatics
+ *      Vienna University of Technology, Austria
+ *  
+ *  <license>
+ *      This program is free software: you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation, either version 2 of the License, or
+ *      (at your option) any later version.
+ *  
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *  
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *  </license>
+ */
+
+
+#ifndef TYPEMAP_H_
+#define TYPEMAP_H_
+
+#include <stdint.h>
+#include <mpi.h>
+
+/* flattened representation of a datatype:
+ * list of (offset, length) byte blocks in typemap order,
+ * adjacent blocks are coalesced */
+typedef struct typemap {
+    MPI_Aint *offsets;
+    MPI_Aint *lengths;
+    size_t nblocks;
+    size_t max_blocks;
+    MPI_Aint size;              // total number of bytes described by the blocks
+    MPI_Datatype basetype;      // the only predefined type used; MPI_BYTE if heterogeneous (or decoded
+                                // from the bytes the type touches), MPI_DATATYPE_NULL if empty
+} typemap_t;
+
+typedef enum NormalForms {
+    NORMAL_CONTIGUOUS = 0,
+    NORMAL_VECTOR,
+    NORMAL_INDEXED_BLOCK,
+    NORMAL_HINDEXED
+} normal_form_t;
+
+extern const char* normal_form_names[];
+
+
+void init_typemap(typemap_t *map);
+void cleanup_typemap(typemap_t *map);
+
+// appends a block of len bytes at offset off (merged with the last block if adjacent)
+void append_block_to_typemap(typemap_t *map, MPI_Aint off, MPI_Aint len);
+
+// flattens count consecutive instances of type (each shifted by the extent of type)
+int flatten_datatype(MPI_Datatype type, int count, typemap_t *map);
+
+// number of blocks of count consecutive instances of type (as flatten_datatype would
+// produce them, coalescing the last block of an instance with the first of the next one)
+MPI_Count get_typemap_nblocks(MPI_Datatype type, int count);
+
+// stable 64-bit hash (FNV-1a) of the name of the basetype (MPI_BYTE if heterogeneous) and the
+// flattened blocks of count instances of type: equal for all descriptions of the same typemap
+uint64_t get_typemap_fingerprint(MPI_Datatype type, int count);
+
+// builds the cheapest constructor describing the flattened typemap;
+// the new type is committed and keeps the lower bound and extent of the original type
+int create_normalized_datatype(MPI_Datatype type, MPI_Datatype *normtype, normal_form_t *form);
+
+/* binary typemap files (native byte order): a header followed by the
+ * flattened blocks as nblocks 64-bit offsets (bytes) and nblocks 32-bit
+ * lengths (elements of the basetype), such that a memory-mapped file can be
+ * passed to the hindexed constructors without copying */
+typedef struct typemap_file_header {
+    char magic[8];              // TYPEMAP_FILE_MAGIC
+    int32_t basetype;           // index into the predefined types of typemap.c
+    int32_t basetype_size;
+    int64_t nblocks;
+    int64_t lb;                 // bounds of the flattened datatype
+    int64_t extent;
+} typemap_file_header_t;
+
+#define TYPEMAP_FILE_MAGIC "DTTMAP1"
+
+// flattens one instance of type and writes it to path
+int write_typemap_file(MPI_Datatype type, const char *path);
+
+// memory-maps a typemap file and builds an hindexed (or hindexed_block) type with its bounds
+int create_datatype_from_typemap_file(const char *path, MPI_Datatype *t);
+
+#endif /* TYPEMAP_H_ */
@@ -24,6 +24,8 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <unistd.h>
+#include <time.h>
 
 #include "util.h"
 
@@ -37,3 +39,86 @@ char* my_int_to_string(const int n) {
 }
 
 
+char* my_count_to_string(const long long n) {
+    char *s;
+    int SIZE=30;
+    s = (char*)malloc(SIZE * sizeof(char));
+    sprintf(s, "%lld", n);
+    return s;
+}
+
+
+char* my_double_to_string(const double x) {
+    char *s;
+    int SIZE=30;
+    s = (char*)malloc(SIZE * sizeof(char));
+    sprintf(s, "%.9f", x);
+    return s;
+}
+
+
+// resident set size of the process in bytes, read from /proc/self/statm (0 if not available)
+long get_resident_set_size(void) {
+    FILE *f;
+    long size, resident;
+
+    f = fopen("/proc/self/statm", "r");
+    if (f == NULL) {
+        return 0;
+    }
+    if (fscanf(f, "%ld %ld", &size, &resident) != 2) {
+        resident = 0;
+    }
+    fclose(f);
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+
+static volatile double compute_kernel_result;
+static double compute_iterations_per_sec = 0;
+
+static double get_monotonic_time(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+
+void run_compute_kernel(const long iterations) {
+    double x = compute_kernel_result;
+    long i;
+
+    for (i = 0; i < iterations; i++) {
+        x = x * 0.999999 + 1e-6;
+    }
+    compute_kernel_result = x;
+}
+
+
+long get_compute_iterations(const double seconds) {
+    long iterations = 1024;
+    double t, best;
+    int r;
+
+    if (compute_iterations_per_sec == 0) {
+        // grow the loop until it takes 10 ms, then take the fastest of 3 runs
+        do {
+            iterations *= 2;
+            t = get_monotonic_time();
+            run_compute_kernel(iterations);
+            t = get_monotonic_time() - t;
+        } while (t < 0.01);
+        best = t;
+        for (r = 0; r < 3; r++) {
+            t = get_monotonic_time();
+            run_compute_kernel(iterations);
+            t = get_monotonic_time() - t;
+            if (t < best) {
+                best = t;
+            }
+        }
+        compute_iterations_per_sec = iterations / best;
+    }
+    return (seconds > 0) ? (long)(seconds * compute_iterations_per_sec) : 0;
+}
@@ -26,5 +26,13 @@
 #define UTIL_H_
 
 char* my_int_to_string(const int n);
+char* my_count_to_string(const long long n);
+char* my_double_to_string(const double x);
+long get_resident_set_size(void);
+
+// busy loop of dependent floating-point operations (no memory traffic)
+void run_compute_kernel(const long iterations);
+// number of iterations of run_compute_kernel that take the given time in seconds (calibrated on the first call)
+long get_compute_iterations(const double seconds);
 
 #endif /* UTIL_H_ */
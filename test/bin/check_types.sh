@@ -3,7 +3,7 @@
 
 if [ $# != 1 ];
 then
-echo "testall.sh <path to bin dir>"
+echo "check_types.sh <path to bin dir>"
 exit 1;
 fi
 
@@ -17,7 +17,7 @@ nbytes_values=( 10240 2621440 )
 basetype="MPI_INT"
 
 echo "##########################################################################"
-echo " Comparing Tiled types against the reference TiledIndexed"
+echo " Comparing TiledStructIndexed types against the reference TiledVector"
 echo "##########################################################################"
 
 
@@ -29,7 +29,7 @@ do
         do
             for S in ${S_values[@]};
             do
-            ${TYPEPERF_BIN_DIR}/datatype_check --params=layout1:tiled_struct_indexed --params=layout2:ref_TiledStructIndex --params=nbytes_list:${nbytes} --params=b:${basetype} --params=B:${B} --params=S:${S} --params=A:${A}
+            ${TYPEPERF_BIN_DIR}/datatype_check --params=layout1:tiled_struct_indexed_Sblocks --params=layout2:tiled_vector --params=nbytes_list:${nbytes} --params=b:${basetype} --params=B:${B} --params=S:${S} --params=A:${A}
             done
         done
     done
@@ -39,7 +39,7 @@ done
 echo
 echo
 echo "##########################################################################"
-echo " Comparing Alternating types against the reference AlternatingIndexed"
+echo " Comparing AlternatingIndexed types against the reference contiguous Alternating"
 echo "##########################################################################"
 
 
@@ -53,7 +53,7 @@ do
             do
             A1=$A
             A2=$(( $A * 3 ))
-            ${TYPEPERF_BIN_DIR}/datatype_check --params=layout1:alternating_indexed --params=layout2:ref_AlternatingIndexed --params=nbytes_list:${nbytes} --params=b:${basetype} --params=A1:${A1}  --params=A2:${A2} --params=B1:${B} --params=B2:${A2}
+            ${TYPEPERF_BIN_DIR}/datatype_check --params=layout1:alternating_indexed --params=layout2:contig_type --params=subtype:alternating --params=nbytes_list:${nbytes} --params=b:${basetype} --params=A1:${A1}  --params=A2:${A2} --params=B1:${B} --params=B2:${A2}
             done
         done
     done
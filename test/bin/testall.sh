@@ -22,7 +22,7 @@ echo " basic types "
 
 for pattern in bcast allgather pingpong;
 do
-  for ttype in datatype pack;
+  for ttype in datatype pack manual specialized simd threaded;
   do
   mpirun -np 2 ${DTBENCH_GEN_DIR}/reprompibench --params=b:MPI_INT --params=root:0 --params=nbytes_list:950 --params=test_type:${ttype} --params=pattern:${pattern} --params=A:100 --params=layout:tiled --params=B:103 --nrep=2
 
@@ -95,6 +95,256 @@ done
 
 
 
+echo "################################################################"
+echo "################################################################"
+echo " normalized types "
+
+for pattern in bcast allgather pingpong;
+do
+  for ttype in datatype pack;
+  do
+  mpirun -np 2 ${DTBENCH_GEN_DIR}/reprompibench --params=b:MPI_INT --params=root:0 --params=nbytes_list:950 --params=test_type:${ttype} --params=pattern:${pattern} --params=layout:tiled_struct --params=A:10 --params=B:12 --params=S1:2 --params=S2:3 --params=normalize:on --nrep=2
+
+  mpirun -np 2 ${DTBENCH_GEN_DIR}/reprompibench --params=b:MPI_INT --params=root:0 --params=nbytes_list:950 --params=test_type:${ttype} --params=pattern:${pattern} --params=layout:vector_tiled --params=A:100 --params=B:102 --params=S:2 --params=normalize:on --nrep=2
+  done
+done
+
+
+echo "################################################################"
+echo "################################################################"
+echo " pipelined pack and send "
+
+for layout in tiled bucket;
+do
+mpirun -np 2 ${DTBENCH_GEN_DIR}/reprompibench --params=b:MPI_INT --params=root:0 --params=nbytes_list:950/95000 --params=test_type:pipelined --params=segment_size:4096 --params=pattern:pingpong --params=layout:${layout} --params=A:100 --params=A1:100 --params=A2:101 --params=B:103 --nrep=2
+done
+
+
+echo "################################################################"
+echo "################################################################"
+echo " gather, scatter and alltoall "
+
+for pattern in gather scatter alltoall alltoallw;
+do
+  for ttype in datatype pack;
+  do
+  mpirun -np 2 ${DTBENCH_GEN_DIR}/reprompibench --params=b:MPI_INT --params=root:1 --params=nbytes_list:950/95000 --params=test_type:${ttype} --params=pattern:${pattern} --params=layout:tiled --params=A:100 --params=B:103 --nrep=2
+
+  mpirun -np 2 ${DTBENCH_GEN_DIR}/reprompibench --params=b:MPI_INT --params=root:0 --params=nbytes_list:950/95000 --params=test_type:${ttype} --params=pattern:${pattern} --params=layout:tiled_vector --params=A:100 --params=B:103 --nrep=2
+  done
+done
+
+for ttype in datatype pack;
+do
+mpirun -np 2 ${DTBENCH_GEN_DIR}/reprompibench --params=b:MPI_INT --params=root:0 --params=nbytes_list:950/95000 --params=test_type:${ttype} --params=pattern:alltoallw --params=layout:tiled --params=peer_layouts:bucket/tiled_vector --params=A:100 --params=A1:100 --params=A2:101 --params=B:103 --nrep=2
+done
+
+
+echo "################################################################"
+echo "################################################################"
+echo " halo exchange "
+
+for dims in 2 3;
+do
+  for ttype in datatype pack;
+  do
+  mpirun -np 2 ${DTBENCH_GEN_DIR}/reprompibench --params=b:MPI_DOUBLE --params=root:0 --params=nbytes_list:950/95000 --params=test_type:${ttype} --params=pattern:halo --params=dims:${dims} --params=W:2 --nrep=2
+  done
+done
+
+
+echo "################################################################"
+echo "################################################################"
+echo " nonblocking patterns and overlap "
+
+for pattern in ibcast iallgather ipingpong;
+do
+  for ttype in datatype pack;
+  do
+  mpirun -np 2 ${DTBENCH_GEN_DIR}/reprompibench --params=b:MPI_INT --params=root:0 --params=nbytes_list:950/95000 --params=test_type:${ttype} --params=pattern:${pattern} --params=layout:tiled --params=A:100 --params=B:103 --nrep=2
+
+  mpirun -np 2 ${DTBENCH_GEN_DIR}/reprompibench --params=b:MPI_INT --params=root:0 --params=nbytes_list:950/95000 --params=test_type:${ttype} --params=pattern:${pattern} --params=layout:tiled_vector --params=A:100 --params=B:103 --params=overlap:on --params=compute_factor:2 --nrep=2
+  done
+done
+
+
+echo "################################################################"
+echo "################################################################"
+echo " streaming window "
+
+for ttype in datatype pack;
+do
+  mpirun -np 2 ${DTBENCH_GEN_DIR}/reprompibench --params=b:MPI_INT --params=root:0 --params=nbytes_list:950/95000 --params=test_type:${ttype} --params=pattern:stream --params=layout:tiled --params=A:100 --params=B:103 --nrep=2
+
+  mpirun -np 2 ${DTBENCH_GEN_DIR}/reprompibench --params=b:MPI_INT --params=root:0 --params=nbytes_list:950/95000 --params=test_type:${ttype} --params=pattern:stream --params=window:8 --params=layout:tiled_vector --params=A:100 --params=B:103 --params=overlap:on --nrep=2
+done
+
+
+echo "################################################################"
+echo "################################################################"
+echo " multi-pair ping-pong and ring "
+
+for ttype in datatype pack;
+do
+  for pairing in neighbor half_shift random;
+  do
+  mpirun -np 2 ${DTBENCH_GEN_DIR}/reprompibench --params=b:MPI_INT --params=root:0 --params=nbytes_list:950/95000 --params=test_type:${ttype} --params=pattern:multi_pingpong --params=pairing:${pairing} --params=layout:tiled --params=A:100 --params=B:103 --nrep=2
+  done
+
+  mpirun -np 2 ${DTBENCH_GEN_DIR}/reprompibench --params=b:MPI_INT --params=root:0 --params=nbytes_list:950/95000 --params=test_type:${ttype} --params=pattern:ring --params=layout:tiled --params=A:100 --params=B:103 --nrep=2
+
+  mpirun -np 2 ${DTBENCH_GEN_DIR}/reprompibench --params=b:MPI_INT --params=root:0 --params=nbytes_list:950/95000 --params=test_type:${ttype} --params=pattern:ring --params=layout:tiled_vector --params=A:100 --params=B:103 --nrep=2
+done
+
+
+echo "################################################################"
+echo "################################################################"
+echo " one-sided patterns "
+
+for pattern in put get accumulate;
+do
+  for sync in fence pscw lock;
+  do
+  mpirun -np 2 ${DTBENCH_GEN_DIR}/reprompibench --params=b:MPI_INT --params=root:0 --params=nbytes_list:950/95000 --params=test_type:datatype --params=pattern:${pattern} --params=rma_sync:${sync} --params=layout:tiled --params=A:100 --params=B:103 --nrep=2
+
+  mpirun -np 2 ${DTBENCH_GEN_DIR}/reprompibench --params=b:MPI_INT --params=root:0 --params=nbytes_list:950/95000 --params=test_type:datatype --params=pattern:${pattern} --params=rma_sync:${sync} --params=layout:tiled_vector --params=A:100 --params=B:103 --nrep=2
+  done
+done
+
+
+echo "################################################################"
+echo "################################################################"
+echo " persistent requests "
+
+for pattern in bcast_init allgather_init pingpong_init;
+do
+  for ttype in datatype pack;
+  do
+  mpirun -np 2 ${DTBENCH_GEN_DIR}/reprompibench --params=b:MPI_INT --params=root:0 --params=nbytes_list:950/95000 --params=test_type:${ttype} --params=pattern:${pattern} --params=layout:tiled --params=A:100 --params=B:103 --nrep=2
+
+  mpirun -np 2 ${DTBENCH_GEN_DIR}/reprompibench --params=b:MPI_INT --params=root:0 --params=nbytes_list:950/95000 --params=test_type:${ttype} --params=pattern:${pattern} --params=layout:tiled_vector --params=A:100 --params=B:103 --params=overlap:on --nrep=2
+  done
+done
+
+
+echo "################################################################"
+echo "################################################################"
+echo " cached datatypes "
+
+for pattern in bcast allgather pingpong;
+do
+  for cache in on prebuild;
+  do
+  mpirun -np 2 ${DTBENCH_GEN_DIR}/reprompibench --params=b:MPI_INT --params=root:0 --params=nbytes_list:950/9500/950 --params=test_type:datatype --params=pattern:${pattern} --params=layout:alternating_indexed --params=A1:100 --params=A2:101 --params=B1:102 --params=B2:106 --params=type_cache:${cache} --nrep=2
+  done
+done
+
+
+echo "################################################################"
+echo "################################################################"
+echo " datatype construction "
+
+mpirun -np 2 ${DTBENCH_GEN_DIR}/reprompibench --params=b:MPI_INT --params=root:0 --params=nbytes_list:950/95000 --params=pattern:construct --params=layout:rowcol_full_indexed --params=A:100 --nrep=2
+mpirun -np 2 ${DTBENCH_GEN_DIR}/reprompibench --params=b:MPI_INT --params=root:0 --params=nbytes_list:950/95000 --params=pattern:construct --params=A:100 --params=B:206 --params=A1:100 --params=A2:101 --params=B1:102 --params=B2:206 --params=S:2 --params=S1:2 --params=S2:3 --params=l:200 --nrep=2
+
+
+echo "################################################################"
+echo "################################################################"
+echo " random irregular layouts "
+
+for pattern in bcast allgather pingpong;
+do
+  for dist in uniform geometric/0.2 powerlaw/1.5 bimodal/0.8;
+  do
+  mpirun -np 2 ${DTBENCH_GEN_DIR}/reprompibench --params=b:MPI_INT --params=root:0 --params=nbytes_list:950/95000 --params=test_type:datatype --params=pattern:${pattern} --params=layout:random_indexed --params=A1:1 --params=A2:64 --params=G1:0 --params=G2:16 --params=dist:${dist} --params=seed:1 --nrep=2
+  done
+done
+
+
+echo "################################################################"
+echo "################################################################"
+echo " skip measured typemaps "
+
+skipfile=$(mktemp)
+for layout in tiled tiled_vector;
+do
+  mpirun -np 2 ${DTBENCH_GEN_DIR}/reprompibench --params=b:MPI_INT --params=root:0 --params=nbytes_list:950/960/4000 --params=test_type:datatype --params=pattern:bcast --params=layout:${layout} --params=A:100 --params=B:102 --params=skip_measured:${skipfile} --nrep=2
+done
+rm -f ${skipfile}
+
+
+echo "################################################################"
+echo "################################################################"
+echo " nesting depth "
+
+for pattern in bcast allgather pingpong;
+do
+  for wrap in contig vector struct resized mixed;
+  do
+  mpirun -np 2 ${DTBENCH_GEN_DIR}/reprompibench --params=b:MPI_INT --params=root:0 --params=nbytes_list:950/9500 --params=test_type:datatype --params=pattern:${pattern} --params=layout:nested_depth --params=A:3 --params=B:5 --params=k:24 --params=wrap:${wrap} --nrep=2
+  done
+done
+
+
+echo "################################################################"
+echo "################################################################"
+echo " array of structs "
+
+for pattern in bcast allgather pingpong;
+do
+  for layout in aos_struct soa_struct;
+  do
+    for select in 0/1/2 3 0/3/4;
+    do
+    mpirun -np 2 ${DTBENCH_GEN_DIR}/reprompibench --params=b:MPI_DOUBLE --params=root:0 --params=nbytes_list:2400/24000 --params=test_type:datatype --params=pattern:${pattern} --params=layout:${layout} --params=fields:MPI_DOUBLE/MPI_DOUBLE/MPI_DOUBLE/MPI_INT/MPI_SHORT --params=select:${select} --nrep=2
+    done
+  done
+done
+
+
+echo "################################################################"
+echo "################################################################"
+echo " multi-dimensional grids "
+
+for pattern in bcast allgather pingpong;
+do
+  for face in x y z;
+  do
+  mpirun -np 2 ${DTBENCH_GEN_DIR}/reprompibench --params=b:MPI_DOUBLE --params=root:0 --params=nbytes_list:800/80000 --params=test_type:datatype --params=pattern:${pattern} --params=layout:subarray_face --params=dims:3 --params=face:${face} --params=W:2 --params=D:8 --params=order:C --nrep=2
+  done
+  mpirun -np 2 ${DTBENCH_GEN_DIR}/reprompibench --params=b:MPI_DOUBLE --params=root:0 --params=nbytes_list:800/80000 --params=test_type:datatype --params=pattern:${pattern} --params=layout:darray_block --params=dims:2 --params=P:4 --params=order:F --nrep=2
+done
+
+
+echo "################################################################"
+echo "################################################################"
+echo " layout expressions "
+
+for pattern in bcast allgather pingpong;
+do
+  for ttype in datatype pack;
+  do
+  mpirun -np 2 ${DTBENCH_GEN_DIR}/reprompibench --params=b:MPI_INT --params=root:0 --params=nbytes_list:950/9500 --params=test_type:${ttype} --params=pattern:${pattern} --params=layout:expr '--params=expr:contig(k,struct([1,2],[0,24],[b,vector(n/(8*k),2,5,b)]))' --params=k:2 --nrep=2
+  done
+done
+
+
+echo "################################################################"
+echo "################################################################"
+echo " typemap files "
+
+TYPEMAP_PREFIX=$(mktemp)
+mpirun -np 2 ${DTBENCH_GEN_DIR}/reprompibench --params=b:MPI_INT --params=root:0 --params=nbytes_list:950/9500 --params=test_type:datatype --params=pattern:pingpong --params=layout:alternating_indexed --params=A1:100 --params=A2:101 --params=B1:102 --params=B2:106 --params=typemap_export:${TYPEMAP_PREFIX} --nrep=2
+for pattern in bcast allgather pingpong;
+do
+  for ttype in datatype pack;
+  do
+  mpirun -np 2 ${DTBENCH_GEN_DIR}/reprompibench --params=b:MPI_INT --params=root:0 --params=nbytes_list:9500/95000 --params=test_type:${ttype} --params=pattern:${pattern} --params=layout:from_file --params=typemap_file:${TYPEMAP_PREFIX}.9500 --nrep=2
+  done
+done
+rm -f ${TYPEMAP_PREFIX} ${TYPEMAP_PREFIX}.950 ${TYPEMAP_PREFIX}.9500
+
+
 echo "################################################################"
 echo "################################################################"
 echo " MPI predifined datatypes "